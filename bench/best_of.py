@@ -0,0 +1,15 @@
+#!/usr/bin/env python3
+"""best_of.py runs command...  prints the best wall time of `runs` runs in
+seconds. The command's output is discarded, a failing run is an error."""
+import subprocess
+import sys
+import time
+
+runs, command = int(sys.argv[1]), sys.argv[2:]
+best = None
+for _ in range(runs):
+    start = time.perf_counter()
+    subprocess.run(command, stdout=subprocess.DEVNULL, check=True)
+    elapsed = time.perf_counter() - start
+    best = elapsed if best is None else min(best, elapsed)
+print("%.3fs" % best)
@@ -0,0 +1,338 @@
+#!/usr/bin/env python3
+"""Runs the assembly comp writes and counts the instructions executed.
+
+    emu.py file.s [entry...]
+
+Interprets the AArch64 subset the backend emits, starting at _main (or
+each entry in turn, on fresh registers and memory) and stopping when it
+returns. Prints the signed 32-bit w0 and the number of instructions
+executed, one line per entry. An unknown instruction, a misaligned stack
+or a runaway loop is an error.
+"""
+import re
+import sys
+
+M64 = (1 << 64) - 1
+M32 = (1 << 32) - 1
+STEP_LIMIT = 50_000_000
+STACK_TOP = 0x7fff0000
+DATA_BASE = 0x100000
+
+CONDITIONS = {
+    "eq": lambda n, z, c, v: z,
+    "ne": lambda n, z, c, v: not z,
+    "cs": lambda n, z, c, v: c,
+    "hs": lambda n, z, c, v: c,
+    "cc": lambda n, z, c, v: not c,
+    "lo": lambda n, z, c, v: not c,
+    "mi": lambda n, z, c, v: n,
+    "pl": lambda n, z, c, v: not n,
+    "vs": lambda n, z, c, v: v,
+    "vc": lambda n, z, c, v: not v,
+    "hi": lambda n, z, c, v: c and not z,
+    "ls": lambda n, z, c, v: not (c and not z),
+    "ge": lambda n, z, c, v: n == v,
+    "lt": lambda n, z, c, v: n != v,
+    "gt": lambda n, z, c, v: not z and n == v,
+    "le": lambda n, z, c, v: not (not z and n == v),
+    "al": lambda n, z, c, v: True,
+}
+
+
+def signed(value, bits):
+    value &= (1 << bits) - 1
+    return value - (1 << bits) if value >> (bits - 1) else value
+
+
+def immediate(text):
+    return int(text.strip().lstrip("#"), 0)
+
+
+def split_operands(text):
+    # commas inside [...] belong to the address
+    out, current, depth = [], "", 0
+    for ch in text:
+        depth += ch == "["
+        depth -= ch == "]"
+        if ch == "," and depth == 0:
+            out.append(current.strip())
+            current = ""
+        else:
+            current += ch
+    if current.strip():
+        out.append(current.strip())
+    return out
+
+
+def assemble(lines):
+    """Returns the instructions, the code labels and the .data words."""
+    insns, labels, data = [], {}, {}
+    in_data, data_label = False, None
+    for line in lines:
+        line = line.split("//")[0].strip()
+        if not line:
+            continue
+        if line.startswith(".data") or line.startswith(".text"):
+            in_data = line.startswith(".data")
+        elif line.endswith(":"):
+            if in_data:
+                data_label = line[:-1]
+            else:
+                labels[line[:-1]] = len(insns)
+        elif line.startswith(".long") and in_data:
+            data[data_label] = int(line.split()[1], 0)
+        elif not line.startswith("."):
+            op, _, rest = line.partition(" ")
+            insns.append((op.lower(), split_operands(rest), line))
+    return insns, labels, data
+
+
+class Machine:
+    def __init__(self, data):
+        self.regs = [0] * 31
+        self.sp = STACK_TOP
+        self.mem = {}
+        self.n = self.z = self.c = self.v = False
+        self.globals = {}
+        for i, (name, value) in enumerate(data.items()):
+            self.globals[name] = DATA_BASE + 16 * i
+            self.store(DATA_BASE + 16 * i, value, 4)
+
+    def get(self, reg):
+        name = reg.lower()
+        if name in ("sp", "wsp"):
+            value = self.sp
+        elif name in ("xzr", "wzr"):
+            value = 0
+        else:
+            value = self.regs[int(name[1:])]
+        return value & (M32 if name[0] == "w" else M64)
+
+    def set(self, reg, value):
+        name = reg.lower()
+        value &= M32 if name[0] == "w" else M64
+        if name in ("sp", "wsp"):
+            self.sp = value
+        elif name not in ("xzr", "wzr"):
+            self.regs[int(name[1:])] = value
+
+    def operand(self, args, w):
+        """A register or immediate with an optional lsl/lsr/asr."""
+        mask = M32 if w else M64
+        value = immediate(args[0]) & mask if args[0].startswith("#") else self.get(args[0])
+        if len(args) > 1:
+            shift, amount = args[1].split()
+            amount = immediate(amount)
+            if shift == "lsl":
+                value <<= amount
+            elif shift == "lsr":
+                value >>= amount
+            elif shift == "asr":
+                value = signed(value, 32 if w else 64) >> amount
+        return value & mask
+
+    def compare(self, a, b, w, subtract):
+        bits = 32 if w else 64
+        mask = (1 << bits) - 1
+        a &= mask
+        b &= mask
+        if subtract:
+            result = a - b
+            self.c = a >= b
+            wide = signed(a, bits) - signed(b, bits)
+        else:
+            result = a + b
+            self.c = result > mask
+            wide = signed(a, bits) + signed(b, bits)
+        result &= mask
+        self.n = bool(result >> (bits - 1))
+        self.z = result == 0
+        self.v = not -(1 << (bits - 1)) <= wide < (1 << (bits - 1))
+
+    def test(self, result, w):
+        bits = 32 if w else 64
+        result &= (1 << bits) - 1
+        self.n, self.z, self.c, self.v = bool(result >> (bits - 1)), result == 0, False, False
+
+    def holds(self, cond):
+        return bool(CONDITIONS[cond](self.n, self.z, self.c, self.v))
+
+    def address(self, text):
+        """[base, #off], [base, #off]! or [base], #post."""
+        m = re.match(r"\[(.*?)\](!?)\s*(?:,\s*(.*))?$", text)
+        inner = [p.strip() for p in m.group(1).split(",")]
+        base_reg = "sp" if inner[0] == "sp" else "x" + inner[0][1:]
+        offset = immediate(inner[1]) if len(inner) > 1 and "@" not in inner[1] else 0
+        post = immediate(m.group(3)) if m.group(3) else None
+        return base_reg, self.get(base_reg), offset, m.group(2) == "!", post
+
+    def load(self, address, size):
+        return sum(self.mem.get(address + i, 0xaa) << (8 * i) for i in range(size))
+
+    def store(self, address, value, size):
+        for i in range(size):
+            self.mem[address + i] = (value >> (8 * i)) & 0xff
+
+    def memory(self, op, a):
+        regs, where = (a[:2], a[2]) if op in ("ldp", "stp") else (a[:1], a[1])
+        base_reg, base, offset, pre, post = self.address(where)
+        address = base + offset if post is None else base
+        for i, reg in enumerate(regs):
+            if op in ("ldrb", "ldrsb", "strb"):
+                size = 1
+            elif op == "ldrsw" or reg.lower()[0] == "w":
+                size = 4
+            else:
+                size = 8
+            if op.startswith("ld"):
+                value = self.load(address + i * size, size)
+                if op == "ldrsw":
+                    value = signed(value, 32)
+                elif op == "ldrsb":
+                    value = signed(value, 8)
+                self.set(reg, value)
+            else:
+                self.store(address + i * size, self.get(reg), size)
+        if pre or post is not None:
+            self.set(base_reg, base + (offset if post is None else post))
+
+
+def execute(m, op, a, w):
+    """Runs one instruction. Returns the branch target label or None."""
+    mask = M32 if w else M64
+    bits = 32 if w else 64
+    if op == "mov":
+        m.set(a[0], immediate(a[1]) if a[1].startswith("#") else m.get(a[1]))
+    elif op == "movz":
+        m.set(a[0], m.operand(a[1:], w))
+    elif op == "movn":
+        m.set(a[0], ~m.operand(a[1:], w))
+    elif op == "movk":
+        shift = immediate(a[2].split()[1]) if len(a) > 2 else 0
+        value = m.get(a[0]) & ~(0xffff << shift)
+        m.set(a[0], value | (immediate(a[1]) & 0xffff) << shift)
+    elif op in ("add", "adds", "sub", "subs"):
+        x, y = m.get(a[1]), m.operand(a[2:], w)
+        if op.endswith("s"):
+            m.compare(x, y, w, op.startswith("sub"))
+        m.set(a[0], x + y if op.startswith("add") else x - y)
+    elif op in ("cmp", "cmn"):
+        m.compare(m.get(a[0]), m.operand(a[1:], w), w, op == "cmp")
+    elif op == "tst":
+        m.test(m.get(a[0]) & m.operand(a[1:], w), w)
+    elif op in ("ccmp", "ccmn"):
+        if m.holds(a[3]):
+            m.compare(m.get(a[0]), m.operand(a[1:2], w), w, op == "ccmp")
+        else:
+            nzcv = immediate(a[2])
+            m.n, m.z, m.c, m.v = (bool(nzcv >> i & 1) for i in (3, 2, 1, 0))
+    elif op == "mul":
+        m.set(a[0], m.get(a[1]) * m.get(a[2]))
+    elif op == "madd":
+        m.set(a[0], m.get(a[3]) + m.get(a[1]) * m.get(a[2]))
+    elif op == "msub":
+        m.set(a[0], m.get(a[3]) - m.get(a[1]) * m.get(a[2]))
+    elif op == "sdiv":
+        x, y = signed(m.get(a[1]), bits), signed(m.get(a[2]), bits)
+        q = 0 if y == 0 else abs(x) // abs(y)
+        m.set(a[0], q if (x < 0) == (y < 0) else -q)
+    elif op == "udiv":
+        y = m.get(a[2])
+        m.set(a[0], 0 if y == 0 else m.get(a[1]) // y)
+    elif op == "neg":
+        m.set(a[0], -m.operand(a[1:], w))
+    elif op == "mvn":
+        m.set(a[0], ~m.operand(a[1:], w))
+    elif op in ("and", "ands"):
+        result = m.get(a[1]) & m.operand(a[2:], w)
+        if op == "ands":
+            m.test(result, w)
+        m.set(a[0], result)
+    elif op == "orr":
+        m.set(a[0], m.get(a[1]) | m.operand(a[2:], w))
+    elif op == "eor":
+        m.set(a[0], m.get(a[1]) ^ m.operand(a[2:], w))
+    elif op in ("lsl", "lsr", "asr"):
+        amount = (immediate(a[2]) if a[2].startswith("#") else m.get(a[2])) % bits
+        x = m.get(a[1])
+        if op == "lsl":
+            m.set(a[0], x << amount)
+        elif op == "lsr":
+            m.set(a[0], x >> amount)
+        else:
+            m.set(a[0], signed(x, bits) >> amount)
+    elif op == "cset":
+        m.set(a[0], int(m.holds(a[1])))
+    elif op == "csetm":
+        m.set(a[0], mask if m.holds(a[1]) else 0)
+    elif op == "csel":
+        m.set(a[0], m.get(a[1]) if m.holds(a[3]) else m.get(a[2]))
+    elif op == "csinc":
+        m.set(a[0], m.get(a[1]) if m.holds(a[3]) else m.get(a[2]) + 1)
+    elif op == "sxtw":
+        m.set(a[0], signed(m.get(a[1]), 32))
+    elif op == "sxtb":
+        m.set(a[0], signed(m.get(a[1]), 8))
+    elif op == "uxtb":
+        m.set(a[0], m.get(a[1]) & 0xff)
+    elif op in ("ldr", "ldur", "ldrsw", "ldrb", "ldrsb", "str", "stur", "strb", "ldp", "stp"):
+        m.memory(op, a)
+    elif op == "adrp":
+        m.set(a[0], m.globals[a[1].split("@")[0]])
+    elif op == "b":
+        return a[0]
+    elif op.startswith("b."):
+        return a[0] if m.holds(op[2:]) else None
+    elif op == "cbz":
+        return a[1] if m.get(a[0]) == 0 else None
+    elif op == "cbnz":
+        return a[1] if m.get(a[0]) != 0 else None
+    elif op != "nop":
+        raise ValueError("unknown instruction")
+    return None
+
+
+def run(insns, labels, data, entry):
+    m = Machine(data)
+    pc = labels[entry]
+    returns = []
+    count = 0
+    while 0 <= pc < len(insns):
+        op, a, line = insns[pc]
+        pc += 1
+        count += 1
+        if count > STEP_LIMIT:
+            sys.exit("emu: more than %d instructions" % STEP_LIMIT)
+
+        if op == "bl":
+            returns.append(pc)
+            pc = labels[a[0]]
+            continue
+        if op == "ret":
+            if not returns:
+                break
+            pc = returns.pop()
+            continue
+        try:
+            target = execute(m, op, a, bool(a) and a[0][0].lower() == "w")
+        except ValueError as e:
+            sys.exit("emu: %s: %s" % (e, line))
+        if target is not None:
+            pc = labels[target]
+        if m.sp % 16 != 0:
+            sys.exit("emu: misaligned stack after %s" % line)
+    return signed(m.get("x0"), 32), count
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    with open(sys.argv[1]) as f:
+        insns, labels, data = assemble(f.read().split("\n"))
+
+    for entry in sys.argv[2:] or ["_main"]:
+        print(*run(insns, labels, data, entry))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Parse time of expression heavy inputs, best of 3, lexing included
+# (the precedence climbing commit, user-016):
+#   5MB of nested random expressions
+#   7.7MB of flat 8-operand sums
+#
+#   bench/expr.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/ast_dump" tests/ast_dump.c $LIBRARY_FILES -pthread
+
+python3 tests/gen_expr.py nested 5 > "$work/nested.c"
+python3 tests/gen_expr.py flat 7.7 > "$work/flat.c"
+
+for input in nested flat; do
+    echo "expr: $input $(wc -c < "$work/$input.c") bytes," \
+        "$(python3 bench/best_of.py 3 "$work/ast_dump" -q "$work/$input.c")"
+done
@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+"""A file of mostly static functions for --lazy.
+
+    gen_lazy.py count live [seed]
+
+writes count functions of 12 declarations plus main. `live` - 1 of them,
+picked at random, are not static, so main and those are what --lazy
+keeps. 10000 and 500 make 4.8MB.
+"""
+import random
+import sys
+
+
+def function(rng, index, static):
+    out = ["%sint f%d(void) {" % ("static " if static else "", index),
+           "    int v0 = %d;" % rng.randrange(1000)]
+    for i in range(1, 12):
+        out.append("    int v%d = %d * %d + (v%d - %d) %% 7;"
+                   % (i, rng.randrange(100), rng.randrange(1, 10), i - 1, rng.randrange(5, 50)))
+    out.append("    return v11 && v3 || !v5;")
+    out.append("}")
+    return out
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    count, live = int(sys.argv[1]), int(sys.argv[2])
+    rng = random.Random(int(sys.argv[3]) if len(sys.argv) > 3 else 1)
+
+    exported = set(rng.sample(range(count), live - 1))
+    out = []
+    for i in range(count):
+        out += function(rng, i, i not in exported)
+    out.append("int main(void) {\n    int a = 1;\n    return a + 2;\n}")
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
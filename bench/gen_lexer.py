@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Lexer benchmark input: functions of 40 declarations with long
+identifiers, mixed operators, line and block comments.
+
+    gen_lexer.py megabytes [seed] > file.c
+"""
+import random
+import sys
+
+OPERATORS = ["+", "-", "*", "/", "%", "&", "|", "^", "<<", ">>", "&&", "||",
+             "==", "!=", "<", "<=", ">", ">="]
+
+
+def function(rng, index):
+    lines = ["int fn%d(void) {" % index,
+             "    /* generated function body,",
+             "       spanning a few lines */"]
+    names = []
+    for i in range(40):
+        name = "variable%dx%d" % (index, i)
+        if names:
+            value = " ".join("%s %s" % (rng.choice(names), rng.choice(OPERATORS)) for _ in range(3))
+            value += " %d" % rng.randint(0, 999)
+        else:
+            value = str(rng.randint(0, 99))
+        lines.append("    int %s = %s;   // trailing comment %d" % (name, value, i))
+        names.append(name)
+    lines.append("    %s += %s ? %s : 'a';" % (names[3], names[5], names[7]))
+    lines.append("    return %s;" % names[-1])
+    lines.append("}")
+    return "\n".join(lines) + "\n\n"
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    target = float(sys.argv[1]) * (1 << 20)
+    rng = random.Random(int(sys.argv[2]) if len(sys.argv) > 2 else 1)
+
+    size, index = 0, 0
+    while size < target:
+        text = function(rng, index)
+        sys.stdout.write(text)
+        size += len(text)
+        index += 1
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""Straight-line programs for the allocation and instruction counts.
+
+    gen_statements.py functions count     count functions of 200 assignments (300 make 2.3MB)
+    gen_statements.py statements count    main with count expression statements
+"""
+import sys
+
+
+def functions(count):
+    out = []
+    for f in range(count):
+        out.append("int f%d(void) {" % f)
+        out += ["    int v%d = %d;" % (i, i) for i in range(8)]
+        for i in range(200):
+            out.append("    v%d = v%d * %d + (v%d - %d) / 3 - -v%d;"
+                       % (i % 8, (i + 1) % 8, i % 9, (i + 3) % 8, i % 4, i % 5))
+        out.append("    return v1 + v2;")
+        out.append("}")
+    out.append("int main(void) {\n    return 0;\n}")
+    return out
+
+
+def statements(count):
+    out = ["int main(void) {"]
+    out += ["    int v%d = %d;" % (i, i % 7) for i in range(20)]
+    out += ["    v%d + %d;" % (i % 20, i % 5) for i in range(count)]
+    out.append("    return v3 + v19 + v11;")
+    out.append("}")
+    return out
+
+
+def main():
+    if len(sys.argv) != 3 or sys.argv[1] not in ("functions", "statements"):
+        sys.exit(__doc__)
+    generate = functions if sys.argv[1] == "functions" else statements
+    print("\n".join(generate(int(sys.argv[2]))))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+"""One expression of a million terms, for the explicit-stack parser and
+code generator.
+
+    gen_stress.py left count      a + a + ... + a
+    gen_stress.py right count     a + (a + (... + a))
+    gen_stress.py parens count    ((...(a)...))
+    gen_stress.py minus count     - - ... - a
+"""
+import sys
+
+
+def expression(shape, count):
+    if shape == "left":
+        return " + ".join(["a"] * count)
+    if shape == "right":
+        return "a + (" * (count - 1) + "a" + ")" * (count - 1)
+    if shape == "parens":
+        return "(" * count + "a" + ")" * count
+    return "- " * count + "a"
+
+
+def main():
+    if len(sys.argv) != 3 or sys.argv[1] not in ("left", "right", "parens", "minus"):
+        sys.exit(__doc__)
+    print("int main(void) {\n    int a = 1;\n    return %s;\n}"
+          % expression(sys.argv[1], int(sys.argv[2])))
+
+
+if __name__ == "__main__":
+    main()
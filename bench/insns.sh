@@ -0,0 +1,30 @@
+#!/bin/sh
+# Static (lines of asm) and dynamic (executed under bench/emu.py)
+# instruction counts, optimized and at -O0, with the value each program
+# returns. A changed count should not come with a changed value.
+#   bench/programs/*.c   the test programs of the folding commit
+#                        (user-021), t10 is the 3000-statement program
+#                        from bench/gen_statements.py. The optimizer folds
+#                        them to a constant, -O0 still shows the folding
+#                        before code generation.
+#   bench/kernels/*.c    the register allocator commit (user-024). Inputs
+#                        are globals, so nothing folds.
+#
+#   bench/insns.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/comp" $SOURCE_FILES -pthread
+
+python3 bench/gen_statements.py statements 3000 > "$work/t10.c"
+
+count() {
+    "$work/comp" "$@" -o "$work/$name.s" "$file"
+    set -- $(python3 bench/emu.py "$work/$name.s")
+    echo "$(grep -c '^ *[a-z]' "$work/$name.s") static $2 executed, returns $1"
+}
+
+for file in bench/programs/*.c "$work/t10.c" bench/kernels/*.c; do
+    name=$(basename "$file" .c)
+    echo "insns: $name optimized $(count), -O0 $(count -O0)"
+done
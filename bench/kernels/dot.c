@@ -0,0 +1,11 @@
+int x0 = 1; int x1 = 2; int x2 = 3; int x3 = 4; int x4 = 5; int x5 = 6; int x6 = 7; int x7 = 8;
+int y0 = 8; int y1 = 7; int y2 = 6; int y3 = 5; int y4 = 4; int y5 = 3; int y6 = 2; int y7 = 1;
+int norm = 0;
+int main(void) {
+    int d = x0 * y0 + x1 * y1 + x2 * y2 + x3 * y3 + x4 * y4 + x5 * y5 + x6 * y6 + x7 * y7;
+    int nx = x0 * x0 + x1 * x1 + x2 * x2 + x3 * x3 + x4 * x4 + x5 * x5 + x6 * x6 + x7 * x7;
+    int ny = y0 * y0 + y1 * y1 + y2 * y2 + y3 * y3 + y4 * y4 + y5 * y5 + y6 * y6 + y7 * y7;
+    int c = (x0 - y0) * (x1 - y1) + (x2 - y2) * (x3 - y3) + (x4 - y4) * (x5 - y5) + (x6 - y6) * (x7 - y7);
+    norm = nx + ny;
+    return (d * d - nx * ny / 64 + c) % 256;
+}
@@ -0,0 +1,15 @@
+int s0 = 12345;
+int s1 = 67890;
+int s2 = 424242;
+int s3 = 99;
+int out = 0;
+int main(void) {
+    int a = s0 ^ (s1 * 31);
+    int b = s2 ^ (a * 17 + s3);
+    int c = (a + b) ^ (a - b) ^ (s3 * 7);
+    int d = (c * 13 + a) ^ (b * 5 + s0);
+    int e = (d ^ c) + (b ^ a) * 3;
+    int f = (e * 9) ^ (d * 11) ^ (c * 15) ^ (b * 19) ^ (a * 23);
+    out = a + b + c + d + e + f;
+    return (f ^ e ^ d ^ c ^ b ^ a) & 255;
+}
@@ -0,0 +1,14 @@
+int x = 7;
+int a0 = 3;
+int a1 = 5;
+int a2 = 11;
+int a3 = 13;
+int a4 = 17;
+int r = 0;
+int main(void) {
+    int h = (((a4 * x + a3) * x + a2) * x + a1) * x + a0;
+    int e = a0 + a1 * x + a2 * x * x + a3 * x * x * x + a4 * x * x * x * x;
+    int d = 4 * a4 * x * x * x + 3 * a3 * x * x + 2 * a2 * x + a1;
+    r = h - e + d;
+    return (h ^ e) + d % 251;
+}
@@ -0,0 +1,15 @@
+int p = 40;
+int q = 9;
+int lo = 10;
+int hi = 30;
+int res = 0;
+int main(void) {
+    int u = p < lo ? lo : (p > hi ? hi : p);
+    int v = q < lo ? lo : (q > hi ? hi : q);
+    int m = u > v ? u : v;
+    int n = u < v ? u : v;
+    int w = (m - n) * (m + n) + (u ? v / u : 0);
+    int z = (w % 7 == 0) ? w / 7 : ((w % 5 == 0) ? w / 5 : w);
+    res = u * 1000 + v * 100 + m * 10 + n;
+    return (z + w + res) % 256;
+}
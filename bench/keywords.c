@@ -0,0 +1,82 @@
+#include "../src/lexer/token.h"
+
+#include <time.h>
+
+/**
+ * Keyword lookup, ns per call over a mix of identifiers and keywords
+ * (strlen included): token_get_keyword()'s perfect hash against the two
+ * ways it used to be done, a str_sub() copy and a strcmp() per keyword.
+ */
+
+#define LOOKUPS 20000000
+
+static const char *keywords[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do",
+    "double", "else", "enum", "extern", "float", "for", "goto", "if",
+    "inline", "int", "long", "register", "restrict", "return", "short",
+    "signed", "sizeof", "static", "struct", "switch", "typedef", "union",
+    "unsigned", "void", "volatile", "while", "_Bool", "_Complex", "_Imaginary",
+};
+#define KEYWORD_COUNT ((int) (sizeof(keywords) / sizeof(keywords[0])))
+
+static const char *words[] = {
+    "digit", "return", "name", "int", "value_x", "counter", "tmp", "a",
+    "char", "result", "i", "longer_identifier_name", "while", "void",
+};
+#define WORD_COUNT ((int) (sizeof(words) / sizeof(words[0])))
+
+/** the lookup before the perfect hash: the four keywords the lexer knew */
+static enum token_type previous_lookup(const char *str, int length) {
+    char *word = str_sub(str, 0, length);
+    enum token_type type = TOKEN_NOT_KEYWORD;
+    if (strcmp(word, "int") == 0) type = TOKEN_INT;
+    else if (strcmp(word, "return") == 0) type = TOKEN_RETURN;
+    else if (strcmp(word, "void") == 0) type = TOKEN_VOID;
+    else if (strcmp(word, "char") == 0) type = TOKEN_CHAR;
+    free(word);
+    return type;
+}
+
+/** the same scheme grown to every keyword */
+static enum token_type chain_lookup(const char *str, int length) {
+    char *word = str_sub(str, 0, length);
+    enum token_type type = TOKEN_NOT_KEYWORD;
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        if (strcmp(word, keywords[i]) == 0) {
+            type = TOKEN_INT;
+            break;
+        }
+    }
+    free(word);
+    return type;
+}
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void run(const char *name, enum token_type (*lookup)(const char *, int)) {
+    volatile long sum = 0;
+    const double start = now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        const char *word = words[i % WORD_COUNT];
+        sum += lookup(word, strlen(word));
+    }
+    printf("keywords: %-36s %6.1f ns/op\n", name, (now() - start) * 1e9 / LOOKUPS);
+}
+
+int main(void) {
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        if (token_get_keyword(keywords[i], strlen(keywords[i])) == TOKEN_NOT_KEYWORD) {
+            fprintf(stderr, "keyword %s isn't recognized\n", keywords[i]);
+            return 1;
+        }
+    }
+
+    run("perfect hash", token_get_keyword);
+    run("previous str_sub + 4 strcmp chain", previous_lookup);
+    run("str_sub + 37 strcmp chain", chain_lookup);
+    return 0;
+}
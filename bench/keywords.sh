@@ -0,0 +1,9 @@
+#!/bin/sh
+# Keyword lookup, perfect hash against strcmp chains (user-004).
+#
+#   bench/keywords.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/keywords" bench/keywords.c src/lexer/token.c src/helpers.c src/arena.c
+"$work/keywords"
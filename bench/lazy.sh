@@ -0,0 +1,20 @@
+#!/bin/sh
+# Full compile against --lazy on 10000 functions (4.8MB), 500 of them
+# live (main plus 499 non-static), best of 5 (the lazy parsing commit,
+# user-020).
+#
+#   bench/lazy.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/comp" $SOURCE_FILES -pthread
+
+python3 bench/gen_lazy.py 10000 500 > "$work/lazy.c"
+echo "lazy: $(wc -c < "$work/lazy.c") bytes"
+
+for mode in full --lazy; do
+    flags=$([ $mode = full ] || echo $mode)
+    time=$(python3 bench/best_of.py 5 "$work/comp" $flags -o "$work/lazy.s" "$work/lazy.c")
+    echo "lazy: $mode $time, $(wc -c < "$work/lazy.s") bytes of asm," \
+        "$(grep -c '^_[a-z0-9_]*:' "$work/lazy.s") functions"
+done
@@ -0,0 +1,76 @@
+#include "../src/lexer/lexer.h"
+#include "../src/lexer/intern.h"
+
+#include <time.h>
+
+/**
+ * Lexer throughput in MB/s, best of 5: the pull lexer the compiler uses
+ * by default, and with more than one CPU also lexer_parallel() on all of
+ * them (what --parallel does for big inputs).
+ */
+
+#define RUNS 5
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void report(const char *name, struct source *src, int tokens, double best) {
+    printf("lexer: %-24s %d tokens, %.3fs, %.0f MB/s\n", name, tokens, best, src->size / best / 1e6);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: lexer file\n");
+        return 2;
+    }
+
+    struct source *src = source_open(argv[1]);
+    if (src == NULL) return 2;
+
+    double best = 1e9;
+    int tokens = 0;
+    for (int run = 0; run < RUNS; run++) {
+        struct lexer lex;
+        const double start = now();
+        lexer_init(&lex, src);
+        enum token_type kind;
+        for (tokens = 0; (kind = peek_kind(&lex, 0)) != TOKEN_EOF && kind != TOKEN_ERROR; tokens++)
+            skip_token(&lex);
+        const double elapsed = now() - start;
+
+        lexer_cleanup(&lex);
+        intern_cleanup();
+        if (kind == TOKEN_ERROR) return 1;
+        if (elapsed < best) best = elapsed;
+    }
+    report("sequential", src, tokens, best);
+
+    if (cpu_count() == 1) {
+        printf("lexer: parallel skipped, there is only one CPU\n");
+    } else {
+        struct pool *pool = pool_init(0);
+        best = 1e9;
+        for (int run = 0; run < RUNS; run++) {
+            const double start = now();
+            struct token_store *store = lexer_parallel(src, pool, LEXER_CHUNK_SIZE);
+            const double elapsed = now() - start;
+
+            if (store == NULL) return 1;
+            tokens = store->count - 1;      // without the EOF
+            token_store_free(store);
+            intern_cleanup();
+            if (elapsed < best) best = elapsed;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "parallel, %d threads", pool_size(pool));
+        report(name, src, tokens, best);
+        pool_free(pool);
+    }
+
+    source_close(src);
+    return 0;
+}
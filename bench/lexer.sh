@@ -0,0 +1,11 @@
+#!/bin/sh
+# Lexer throughput on a 50MB generated corpus (user-005, and the parallel
+# lexer of user-009 where there is more than one CPU).
+#
+#   bench/lexer.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/lexer" bench/lexer.c $LEXER_FILES -pthread
+python3 bench/gen_lexer.py 50 > "$work/lexer_corpus.c"
+"$work/lexer" "$work/lexer_corpus.c"
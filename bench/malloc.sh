@@ -0,0 +1,19 @@
+#!/bin/sh
+# Heap calls per phase, counted by wrapping malloc and friends (the arena
+# commit, user-012): 300 functions (2.3MB) and one function of 3000
+# statements.
+#
+#   bench/malloc.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/comp_counted" $SOURCE_FILES bench/malloc_count.c -pthread \
+    -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free,--wrap=compilation_report
+
+python3 bench/gen_statements.py functions 300 > "$work/functions.c"
+python3 bench/gen_statements.py statements 3000 > "$work/statements.c"
+
+for input in functions statements; do
+    echo "malloc: $input.c, $(wc -c < "$work/$input.c") bytes"
+    "$work/comp_counted" -o /dev/null "$work/$input.c"
+done
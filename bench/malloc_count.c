@@ -0,0 +1,59 @@
+#include "../src/compilation.h"
+
+/**
+ * Heap calls per phase of the compiler. Linked into comp with
+ *
+ *     -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free,--wrap=compilation_report
+ *
+ * every malloc, calloc and realloc counts as an allocation and every
+ * free of a non-NULL pointer as a free. The counts are printed and reset
+ * at every compilation_report() and once more at exit, which is the
+ * teardown.
+ */
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void __real_free(void *pointer);
+void __real_compilation_report(struct compilation *c, const char *phase);
+
+static long allocations, frees;
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    allocations++;
+    return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void *pointer) {
+    if (pointer != NULL) frees++;
+    __real_free(pointer);
+}
+
+static void report(const char *phase) {
+    fprintf(stderr, "malloc: %-9s %8ld allocs %8ld frees\n", phase, allocations, frees);
+    allocations = frees = 0;
+}
+
+void __wrap_compilation_report(struct compilation *c, const char *phase) {
+    report(phase);
+    __real_compilation_report(c, phase);
+}
+
+static void report_teardown(void) {
+    report("teardown");
+}
+
+__attribute__((constructor))
+static void start_counting(void) {
+    atexit(report_teardown);
+}
@@ -0,0 +1,6 @@
+int main(void) {
+    int digit = 20 * 10 + 5 + 10;     /* digits */
+    char name = 'a';
+    int a = digit || name;
+    return digit--;
+}
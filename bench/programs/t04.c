@@ -0,0 +1,9 @@
+int main(void) {
+    int x = 5;
+    int y = 0;
+    int z = x && y;
+    int w = x || y;
+    int q = y || 0;
+    int r = x && 3;
+    return z * 1000 + w * 100 + q * 10 + r + (x == 5) + (x != 5) + (x <= 5) + (x >= 6) + (x < 9);
+}
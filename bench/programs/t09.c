@@ -0,0 +1,10 @@
+int main(void) {
+    int a = 0x1F;
+    int b = 017;
+    int c = 0b101;
+    int d = '\n';
+    int e = '\0';
+    int f = 100000;
+    int g = 10u + 5UL + 1ll + 2LLU;
+    return a + b + c + d + e + g + (f - 99990) + '\x41' - 'A' + '\\' + (0x123456789 - 0x123456700) - (0xFFFFFFFFFFFFFFFF + 2) + '\377';
+}
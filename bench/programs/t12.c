@@ -0,0 +1,7 @@
+int main(void) {
+    int a = 1;
+    int b = 2;
+    a = a + 4;
+    b = (a = a * 3) + b;
+    return -(-(a + (b - (1 + (2 * (3 - (4 - 5))))))) + !!b;
+}
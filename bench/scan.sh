@@ -0,0 +1,10 @@
+#!/bin/sh
+# Throughput of the whitespace, comment and identifier kernels, scalar
+# against SSE2 and AVX2 (user-006).
+#
+#   bench/scan.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/scan" bench/scan.c src/helpers.c src/arena.c
+"$work/scan"
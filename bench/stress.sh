@@ -0,0 +1,16 @@
+#!/bin/sh
+# Full compile to /dev/null of one 1M-term expression per shape, best of
+# 3 (the explicit-stack parser and code generator, user-017). Each of
+# them overflowed the C stack before.
+#
+#   bench/stress.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/comp" $SOURCE_FILES -pthread
+
+for shape in left right parens minus; do
+    python3 bench/gen_stress.py $shape 1000000 > "$work/$shape.c"
+    echo "stress: $shape $(wc -c < "$work/$shape.c") bytes," \
+        "$(python3 bench/best_of.py 3 "$work/comp" -o /dev/null "$work/$shape.c")"
+done
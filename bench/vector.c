@@ -0,0 +1,64 @@
+#include "../src/helpers.h"
+#include "../src/lexer/token.h"
+
+#include <time.h>
+
+/**
+ * Pushing struct tokens into a vector and reading them back: m_vector's
+ * doubling against the growth by 100 elements it used to do (with its
+ * copy bug fixed, so it can finish). The old scheme is quadratic, so it
+ * only gets a fraction of the elements, at two sizes to show the growth.
+ * They are kept small enough for make bench to stay quick.
+ */
+
+#define PUSHES 10000000
+#define LINEAR_PUSHES 50000
+
+VECTOR_DEFINE(token, struct token)
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void doubling(int count) {
+    const double start = now();
+    struct m_vector *vec = vector_init(sizeof(struct token));
+    for (int i = 0; i < count; i++)
+        token_insert(vec, (struct token) { .type = TOKEN_IDENTIFIER, .offset = i, .symbol = i & 255 });
+
+    volatile long sum = 0;
+    for (int i = 0; i < count; i++) sum += token_at(vec, i).offset;
+    int size;
+    free(vector_release(vec, &size));
+    printf("vector: doubling     %9d pushes %7.3fs\n", count, now() - start);
+}
+
+static void linear(int count) {
+    const double start = now();
+    int capacity = 100, size = 0;
+    struct token *data = (struct token*) malloc(capacity * sizeof(struct token));
+    for (int i = 0; i < count; i++) {
+        if (size + 1 >= capacity) {
+            struct token *grown = (struct token*) malloc((capacity + 100) * sizeof(struct token));
+            memcpy(grown, data, size * sizeof(struct token));
+            free(data);
+            data = grown;
+            capacity += 100;
+        }
+        data[size++] = (struct token) { .type = TOKEN_IDENTIFIER, .offset = i, .symbol = i & 255 };
+    }
+
+    volatile long sum = 0;
+    for (int i = 0; i < size; i++) sum += data[i].offset;
+    free(data);
+    printf("vector: +100 growth  %9d pushes %7.3fs\n", count, now() - start);
+}
+
+int main(void) {
+    doubling(PUSHES);
+    linear(LINEAR_PUSHES);
+    linear(LINEAR_PUSHES * 2);
+    return 0;
+}
@@ -0,0 +1,9 @@
+#!/bin/sh
+# Vector growth, doubling against the old +100 elements (user-011).
+#
+#   bench/vector.sh work_dir    (make bench sets CC and the file lists)
+set -eu
+work=$1
+
+$CC -O2 -o "$work/vector" bench/vector.c src/helpers.c src/arena.c
+"$work/vector"
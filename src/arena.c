@@ -0,0 +1,94 @@
+#include "arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct arena_chunk {
+    struct arena_chunk *next;
+    size_t size;
+    _Alignas(ARENA_ALIGN) char data[];
+};
+
+struct arena *arena_init(void) {
+    return (struct arena*) calloc(1, sizeof(struct arena));
+}
+
+void arena_free(struct arena *arena) {
+    struct arena_chunk *chunk = arena->_chunks;
+    while (chunk != NULL) {
+        struct arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
+void arena_adopt(struct arena *arena, struct arena *other) {
+    if (other->_chunks != NULL) {
+        struct arena_chunk *last = other->_chunks;
+        while (last->next != NULL) last = last->next;
+
+        // behind the current chunk, which keeps taking allocations
+        if (arena->_chunks == NULL) {
+            arena->_chunks = other->_chunks;
+            arena->_next = other->_next;
+            arena->_end = other->_end;
+        } else {
+            last->next = arena->_chunks->next;
+            arena->_chunks->next = other->_chunks;
+        }
+    }
+
+    arena->allocations += other->allocations;
+    arena->bytes += other->bytes;
+    arena->chunks += other->chunks;
+    free(other);
+}
+
+static struct arena_chunk *chunk_alloc(size_t size) {
+    struct arena_chunk *chunk = (struct arena_chunk*) malloc(
+        sizeof(struct arena_chunk) + size);
+    if (chunk == NULL) {
+        fprintf(stderr, "Out of memory allocating %zu bytes\n", size);
+        exit(EXIT_FAILURE);
+    }
+    chunk->size = size;
+    return chunk;
+}
+
+void *arena_alloc(struct arena *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+    arena->allocations++;
+    arena->bytes += size;
+
+    if ((size_t) (arena->_end - arena->_next) >= size) {
+        void *result = arena->_next;
+        arena->_next += size;
+        return result;
+    }
+
+    arena->chunks++;
+
+    // big blocks get a chunk of their own behind the current one, so the
+    // space left in the current chunk isn't thrown away
+    if (size > ARENA_CHUNK_SIZE / 4 && arena->_chunks != NULL) {
+        struct arena_chunk *chunk = chunk_alloc(size);
+        chunk->next = arena->_chunks->next;
+        arena->_chunks->next = chunk;
+        return chunk->data;
+    }
+
+    struct arena_chunk *chunk = chunk_alloc(size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE);
+    chunk->next = arena->_chunks;
+    arena->_chunks = chunk;
+    arena->_next = chunk->data + size;
+    arena->_end = chunk->data + chunk->size;
+    return chunk->data;
+}
+
+void *arena_calloc(struct arena *arena, size_t count, size_t size) {
+    void *result = arena_alloc(arena, count * size);
+    memset(result, 0, count * size);
+    return result;
+}
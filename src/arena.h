@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+
+/** default chunk size, bigger requests get a chunk of their own */
+#define ARENA_CHUNK_SIZE (64 << 10)
+
+/** every allocation is aligned to this */
+#define ARENA_ALIGN 16
+
+struct arena_chunk;
+
+/**
+ * Bump pointer allocator. Memory is carved out of large chunks and is only
+ * given back all at once by arena_free(), so the AST and the tables built
+ * from it need no per-node cleanup: error paths just drop their pointers.
+ */
+struct arena {
+    struct arena_chunk *_chunks;    // newest first
+    char *_next;                    // free space in the newest chunk
+    char *_end;
+
+    // statistics, see main.c
+    size_t allocations;
+    size_t bytes;
+    int chunks;
+};
+
+struct arena *arena_init(void);
+void arena_free(struct arena *arena);
+
+/**
+ * Move the memory of `other` into `arena` and free `other`. Lets a thread
+ * build into an arena of its own and hand the result over when done.
+ */
+void arena_adopt(struct arena *arena, struct arena *other);
+
+/** uninitialized memory that lives until arena_free() */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/** zeroed array of count elements */
+void *arena_calloc(struct arena *arena, size_t count, size_t size);
@@ -0,0 +1,36 @@
+#include "compilation.h"
+#include "lexer/intern.h"
+
+#include <stdio.h>
+
+bool compilation_open(struct compilation *c, const char *path) {
+    c->src = source_open(path);
+    if (c->src == NULL) return false;
+
+    // the parser pulls tokens from the lexer as it goes
+    lexer_init(&c->lex, c->src);
+    c->arena = arena_init();
+    c->scratch = arena_init();
+    return true;
+}
+
+void compilation_close(struct compilation *c) {
+    arena_free(c->scratch);
+    arena_free(c->arena);
+    lexer_cleanup(&c->lex);
+    intern_cleanup();
+    source_close(c->src);
+}
+
+void compilation_report(struct compilation *c, const char *phase) {
+#ifdef DEBUG
+    fprintf(stderr, "%-8s ast: %zu allocations, %zu KB in %d chunks; "
+                    "scratch: %zu allocations, %zu KB in %d chunks\n",
+        phase,
+        c->arena->allocations, c->arena->bytes >> 10, c->arena->chunks,
+        c->scratch->allocations, c->scratch->bytes >> 10, c->scratch->chunks);
+#else
+    (void) c;
+    (void) phase;
+#endif
+}
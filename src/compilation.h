@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "arena.h"
+#include "source.h"
+#include "lexer/lexer.h"
+
+/**
+ * Everything one compilation owns. Memory is grouped by lifetime:
+ * `arena` holds the AST (nodes, statement and declaration vectors, the
+ * program) and `scratch` the backend's tables, so tearing a compilation
+ * down is a handful of frees no matter how big the input was.
+ */
+struct compilation {
+    struct source *src;
+    struct lexer lex;
+    struct arena *arena;
+    struct arena *scratch;
+};
+
+/** load the file and set up the lexer, false (after printing why) on failure */
+bool compilation_open(struct compilation *c, const char *path);
+void compilation_close(struct compilation *c);
+
+/** DEBUG builds print arena statistics for a phase on stderr */
+void compilation_report(struct compilation *c, const char *phase);
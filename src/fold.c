@@ -0,0 +1,314 @@
+#include "helpers.h"
+#include "parser/nodes.h"
+#include "lexer/intern.h"
+#include "symtab.h"
+#include "ir.h"
+
+/**
+ * Constant folding and algebraic simplification, run between parse() and
+ * arm_compile().
+ *
+ * Nodes are stored in post order, so one forward sweep over the node
+ * array sees every child before its parent. A node is simplified in place:
+ * it is overwritten with the folded constant, or with a copy of the child
+ * that replaces it, and the nodes left behind are simply never reached.
+ *
+ * Constants are evaluated the way the generated code computes them: in
+ * 64-bit registers that wrap around, with signed division and comparisons
+ * (ir_evaluate(), which SCCP uses too). The C types only show up when a
+ * value is stored to a variable, so an expression gives the same result
+ * whether its operands are constants or variables holding them. Division
+ * by zero and shifts out of range are left for run time.
+ *
+ * A subtree is only dropped (`x * 0`, `0 && x`, the arm a constant
+ * conditional doesn't take) when it has no side effects and every name in
+ * it is declared, so the code generator still reports the same errors.
+ * The scopes are tracked the way arm_compile() does.
+ */
+
+struct folder {
+    struct symtab *symbols;     // variables declared at the current statement
+    struct ast *ast;
+    uint32_t next;              // first node not looked at yet
+
+    bool *droppable;            // per node, see above
+    uint32_t _capacity;
+};
+
+static bool is_constant(const struct Expr *e) {
+    return e->type == EXPR_PRIMARY && e->operation == TOKEN_CONSTANT;
+}
+
+/** the IR operation of a binary operator, the way ir_build() lowers it */
+static bool binary_op(enum token_type op, enum ir_op *ir) {
+    switch (op) {
+        case TOKEN_PLUS:                *ir = IR_ADD; return true;
+        case TOKEN_MINUS:               *ir = IR_SUB; return true;
+        case TOKEN_STAR:                *ir = IR_MUL; return true;
+        case TOKEN_SLASH:               *ir = IR_DIV; return true;
+        case TOKEN_PERCENT:             *ir = IR_REM; return true;
+        case TOKEN_AND:                 *ir = IR_AND; return true;
+        case TOKEN_CARET:               *ir = IR_XOR; return true;
+        case TOKEN_PIPE:                *ir = IR_OR; return true;
+        case TOKEN_BANG_EQUAL:          *ir = IR_NE; return true;
+        case TOKEN_EQUAL_EQUAL:         *ir = IR_EQ; return true;
+        case TOKEN_GREATER_THAN:        *ir = IR_GT; return true;
+        case TOKEN_GREATER_THAN_EQUAL:  *ir = IR_GE; return true;
+        case TOKEN_LESS_THAN:           *ir = IR_LT; return true;
+        case TOKEN_LESS_THAN_EQUAL:     *ir = IR_LE; return true;
+        default:                        return false;
+    }
+}
+
+/**
+ * Evaluate a binary operator on two constants. Returns false, leaving it
+ * to run time, when the result is undefined or the operator unknown.
+ */
+static bool eval_binary(enum token_type op, uint64_t a, uint64_t b, uint64_t *result) {
+    enum ir_op ir;
+    switch (op) {
+        // what lsl and asr on an x register give, the IR has no shifts
+        case TOKEN_LT_LT:
+        case TOKEN_GT_GT:
+            if (b >= 64) return false;
+            *result = op == TOKEN_LT_LT ? a << b : (uint64_t) ((int64_t) a >> b);
+            return true;
+
+        case TOKEN_AND_AND:     *result = a != 0 && b != 0; return true;
+        case TOKEN_PIPE_PIPE:   *result = a != 0 || b != 0; return true;
+
+        default:
+            return binary_op(op, &ir) && ir_evaluate(ir, a, b, result);
+    }
+}
+
+/** overwrite node i with a constant, a 64-bit value like every register */
+static void set_constant(struct folder *f, uint32_t i, uint64_t value) {
+    struct Expr *e = &f->ast->nodes[i];
+    *e = (struct Expr) {
+        .type = EXPR_PRIMARY,
+        .operation = TOKEN_CONSTANT,
+        .constant_type = CONSTANT_LONG,
+        .offset = e->offset,
+        .obj.constant = value,
+    };
+    f->droppable[i] = true;
+}
+
+/** overwrite node i with the subtree at `with`, which nothing else refers to */
+static void replace(struct folder *f, uint32_t i, expr_id with) {
+    f->ast->nodes[i] = f->ast->nodes[with];
+    f->droppable[i] = f->droppable[with];
+}
+
+/** turn node i into `value != 0`, reusing the constant node `zero` for the 0 */
+static void set_is_true(struct folder *f, uint32_t i, expr_id value, expr_id zero) {
+    struct Expr *e = &f->ast->nodes[i];
+    set_constant(f, zero, 0);
+
+    e->operation = TOKEN_BANG_EQUAL;
+    e->obj.binary.left = value;
+    e->obj.binary.right = zero;
+}
+
+/** `x - x` and `x ^ x` for the same variable */
+static bool same_variable(const struct Expr *a, const struct Expr *b) {
+    return a->type == EXPR_PRIMARY && a->operation == TOKEN_IDENTIFIER &&
+           b->type == EXPR_PRIMARY && b->operation == TOKEN_IDENTIFIER &&
+           a->obj.symbol == b->obj.symbol;
+}
+
+static void fold_unary(struct folder *f, uint32_t i) {
+    struct Expr *e = &f->ast->nodes[i];
+    const expr_id operand = e->obj.unary.value;
+    const struct Expr *value = &f->ast->nodes[operand];
+
+    // ++ and -- need a variable, the code generator reports it otherwise
+    if (e->operation == TOKEN_PLUS_PLUS || e->operation == TOKEN_MINUS_MINUS) {
+        f->droppable[i] = false;
+        return;
+    }
+
+    f->droppable[i] = f->droppable[operand];
+    if (e->operation == TOKEN_PLUS) {
+        replace(f, i, operand);
+        return;
+    }
+    if (!is_constant(value)) return;
+
+    uint64_t result;
+    switch (e->operation) {
+        case TOKEN_MINUS: ir_evaluate(IR_NEG, value->obj.constant, 0, &result); break;
+        case TOKEN_TILDA: ir_evaluate(IR_NOT, value->obj.constant, 0, &result); break;
+        case TOKEN_BANG:  result = value->obj.constant == 0; break;
+        default: return;
+    }
+    set_constant(f, i, result);
+}
+
+/** `0 && x`, `1 || x` and friends, where one operand is the constant c */
+static void fold_logical(struct folder *f, uint32_t i, expr_id c, expr_id x) {
+    const enum token_type op = f->ast->nodes[i].operation;
+    const bool value = f->ast->nodes[c].obj.constant != 0;
+
+    // decided by the constant alone
+    if (value == (op == TOKEN_PIPE_PIPE)) {
+        if (f->droppable[x])
+            set_constant(f, i, value);
+        return;
+    }
+
+    // decided by x alone
+    set_is_true(f, i, x, c);
+    f->droppable[i] = f->droppable[x];
+}
+
+static void fold_binary(struct folder *f, uint32_t i) {
+    struct Expr *e = &f->ast->nodes[i];
+    const expr_id left = e->obj.binary.left, right = e->obj.binary.right;
+    const struct Expr *l = &f->ast->nodes[left];
+    const struct Expr *r = &f->ast->nodes[right];
+    const enum token_type op = e->operation;
+
+    f->droppable[i] = f->droppable[left] && f->droppable[right];
+
+    if (is_constant(l) && is_constant(r)) {
+        uint64_t result;
+        if (eval_binary(op, l->obj.constant, r->obj.constant, &result))
+            set_constant(f, i, result);
+        return;
+    }
+
+    if (op == TOKEN_AND_AND || op == TOKEN_PIPE_PIPE) {
+        if (is_constant(l)) fold_logical(f, i, left, right);
+        else if (is_constant(r)) fold_logical(f, i, right, left);
+        return;
+    }
+
+    if ((op == TOKEN_MINUS || op == TOKEN_CARET) && same_variable(l, r) && f->droppable[i]) {
+        set_constant(f, i, 0);
+        return;
+    }
+
+    // identities with a constant on one side
+    const bool left_constant = is_constant(l);
+    const expr_id c = left_constant ? left : right;
+    const expr_id x = left_constant ? right : left;
+    if (!is_constant(&f->ast->nodes[c])) return;
+
+    const uint64_t value = f->ast->nodes[c].obj.constant;
+    switch (op) {
+        case TOKEN_PLUS:
+        case TOKEN_PIPE:
+        case TOKEN_CARET:
+            if (value == 0) replace(f, i, x);
+            break;
+        case TOKEN_MINUS:
+        case TOKEN_LT_LT:
+        case TOKEN_GT_GT:
+            if (value == 0 && !left_constant) replace(f, i, x);
+            break;
+        case TOKEN_STAR:
+            if (value == 1) replace(f, i, x);
+            else if (value == 0 && f->droppable[x]) set_constant(f, i, 0);
+            break;
+        case TOKEN_SLASH:
+            if (value == 1 && !left_constant) replace(f, i, x);
+            break;
+        case TOKEN_AND:
+            if (value == 0 && f->droppable[x]) set_constant(f, i, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+static void fold_ternary(struct folder *f, uint32_t i) {
+    const struct Expr *e = &f->ast->nodes[i];
+    const expr_id condition = e->obj.ternary.condition;
+    const struct Expr *arms = &f->ast->nodes[e->obj.ternary.arms];
+    const expr_id left = arms->obj.binary.left, right = arms->obj.binary.right;
+
+    f->droppable[i] = f->droppable[condition] && f->droppable[left] && f->droppable[right];
+    if (!is_constant(&f->ast->nodes[condition])) return;
+
+    const bool taken = f->ast->nodes[condition].obj.constant != 0;
+    if (f->droppable[taken ? right : left])
+        replace(f, i, taken ? left : right);
+}
+
+/** fold the nodes of the expression ending at root, which come after the previous one */
+static void fold_expression(struct folder *f, expr_id root) {
+    for (uint32_t i = f->next; i <= root; i++) {
+        struct Expr *e = &f->ast->nodes[i];
+        switch (e->type) {
+            case EXPR_PRIMARY:
+                f->droppable[i] = e->operation == TOKEN_CONSTANT ||
+                    symtab_lookup(f->symbols, e->obj.symbol) != NULL;
+                break;
+            case EXPR_ASSIGNMENT:
+                f->droppable[i] = false;
+                break;
+            case EXPR_UNARY_OPERATION:
+                fold_unary(f, i);
+                break;
+            case EXPR_BINARY_OPERATION:
+                fold_binary(f, i);
+                break;
+            case EXPR_TERNARY_ARMS:
+                break;
+            case EXPR_TERNARY_OPERATION:
+                fold_ternary(f, i);
+                break;
+        }
+    }
+    f->next = root + 1;
+}
+
+static void fold_variabledecl(struct folder *f, struct variable_decl *vd, enum storage_class storage) {
+    fold_expression(f, vd->value);
+    symtab_declare(f->symbols, vd->name, vd->type, storage, 8);
+}
+
+static void fold_declaration(struct folder *f, struct declaration *d) {
+    f->ast = &d->ast;
+    f->next = 1;
+    if (d->ast.count > f->_capacity) {
+        f->_capacity = d->ast.count * 2;
+        f->droppable = (bool*) realloc(f->droppable, f->_capacity * sizeof(bool));
+    }
+
+    if (d->type == DECLARATION_VARIABLE) {
+        fold_variabledecl(f, &d->obj.var, STORAGE_STATIC);
+        return;
+    }
+
+    struct m_vector *statements = d->obj.func.statements;
+    symtab_push_scope(f->symbols);
+    for (int i = 0; i < statements->_size; i++) {
+        struct statement *s = statement_ref(statements, i);
+        switch (s->type) {
+            case STATEMENT_RETURN:
+                fold_expression(f, s->obj.ret.value);
+                break;
+            case STATEMENT_VARIABLE_DECL:
+                fold_variabledecl(f, &s->obj.var, STORAGE_AUTO);
+                break;
+            case STATEMENT_EXPRESSION:
+                fold_expression(f, s->obj.expr);
+                break;
+        }
+    }
+    symtab_pop_scope(f->symbols);
+}
+
+void fold_program(struct program *p, struct arena *scratch) {
+    struct folder f = {
+        .symbols = symtab_init(scratch, intern_count()),
+    };
+
+    for (int i = 0; i < p->declarations->_size; i++)
+        fold_declaration(&f, declaration_ref(p->declarations, i));
+
+    free(f.droppable);
+}
@@ -1,23 +1,5 @@
 #include "helpers.h"
 
-int digit_count(int d) {
-    int i;
-    for (i = 0; d > 0; i++, d /= 10); 
-    return i == 0 ? 1 : i;
-}
-
-/**
- * Convert int to string. Result is allocated so remember
- * to free.
- */
-char *int_to_str(int value) {
-    int count = digit_count(value) + 1;
-    char *result = (char*) malloc(count);
-    memset(result, 0, count);
-    snprintf(result, count, "%d", value);
-    return result;
-}
-
 char *str_sub(const char *root, int start, size_t size) {
     char *result = (char*) malloc(size + 1);
     memcpy(result, root + start, size);
@@ -25,23 +7,15 @@ char *str_sub(const char *root, int start, size_t size) {
     return result;
 }
 
-bool is_digit(char c) {
-    return '0' <= c && c <= '9';
-}
-
-bool is_hex(char c) {
-    return  '0' <= c && c <= '9' ||
-            ('a' <= c && c <= 'f') ||
-            ('A' <= c && c <= 'F');
-}
-
-bool is_alpha(char c) {
-    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
-}
-
-bool is_alnum(char c) {
-    return is_digit(c) || is_alpha(c);
-}
+const unsigned char char_classes[256] = {
+    [' '] = CHAR_SPACE, ['\t'] = CHAR_SPACE, ['\r'] = CHAR_SPACE, ['\n'] = CHAR_SPACE,
+    ['0' ... '9'] = CHAR_DIGIT | CHAR_HEX | CHAR_IDENT,
+    ['a' ... 'f'] = CHAR_ALPHA | CHAR_HEX | CHAR_IDENT | CHAR_IDENT_START,
+    ['A' ... 'F'] = CHAR_ALPHA | CHAR_HEX | CHAR_IDENT | CHAR_IDENT_START,
+    ['g' ... 'z'] = CHAR_ALPHA | CHAR_IDENT | CHAR_IDENT_START,
+    ['G' ... 'Z'] = CHAR_ALPHA | CHAR_IDENT | CHAR_IDENT_START,
+    ['_'] = CHAR_IDENT | CHAR_IDENT_START,
+};
 
 /**
  * Copies a char array. Result is allocated so remember 
@@ -54,13 +28,24 @@ char *str_copy(const char *from) {
     return result;
 }
 
-/** initialize a vector instance */
+/** initialize an empty vector, nothing is allocated until the first insert */
 struct m_vector *vector_init(int _membsize) {
     struct m_vector *arr = (struct m_vector*) malloc(sizeof(struct m_vector));
+    arr->_data = NULL;
     arr->_size = 0;
     arr->_membsize = _membsize;
-    arr->_capacity = 100;
-    arr->_data = malloc(100 * _membsize);
+    arr->_capacity = 0;
+    arr->_arena = NULL;
+    return arr;
+}
+
+struct m_vector *vector_init_arena(struct arena *arena, int _membsize) {
+    struct m_vector *arr = (struct m_vector*) arena_alloc(arena, sizeof(struct m_vector));
+    arr->_data = NULL;
+    arr->_size = 0;
+    arr->_membsize = _membsize;
+    arr->_capacity = 0;
+    arr->_arena = arena;
     return arr;
 }
 
@@ -69,14 +54,52 @@ struct m_vector *vector_init(int _membsize) {
  * Note: this function doesn't free internally allocated data.
  **/
 void vector_free(struct m_vector *vec) {
+    if (vec->_arena != NULL) return;
     free(vec->_data);
     free(vec);
 }
 
-void vector_resize(struct m_vector *vec, size_t size) {
-    size_t min = size < vec->_capacity ? size : vec->_capacity;
-    void* new_data = malloc(vec->_membsize * size);
-    memcpy(new_data, vec->_data, min);
-    free(vec->_data);
-    vec->_data = new_data;
+void vector_reserve(struct m_vector *vec, int capacity) {
+    if (capacity <= vec->_capacity) return;
+
+    int grown = vec->_capacity < 8 ? 8 : vec->_capacity * 2;
+    if (grown < capacity) grown = capacity;
+
+    if (vec->_arena != NULL) {
+        void *data = arena_alloc(vec->_arena, (size_t) grown * vec->_membsize);
+        if (vec->_size > 0)
+            memcpy(data, vec->_data, (size_t) vec->_size * vec->_membsize);
+        vec->_data = data;
+        vec->_capacity = grown;
+        return;
+    }
+
+    void *data = realloc(vec->_data, (size_t) grown * vec->_membsize);
+    if (data == NULL) {
+        fprintf(stderr, "Out of memory growing a vector to %d elements\n", grown);
+        exit(1);
+    }
+    vec->_data = data;
+    vec->_capacity = grown;
+}
+
+void vector_shrink(struct m_vector *vec) {
+    if (vec->_size == vec->_capacity || vec->_arena != NULL) return;
+
+    if (vec->_size == 0) {
+        free(vec->_data);
+        vec->_data = NULL;
+    } else {
+        void *data = realloc(vec->_data, (size_t) vec->_size * vec->_membsize);
+        if (data == NULL) return;   // keeping the bigger block is fine
+        vec->_data = data;
+    }
+    vec->_capacity = vec->_size;
+}
+
+void *vector_release(struct m_vector *vec, int *size) {
+    void *data = vec->_data;
+    *size = vec->_size;
+    if (vec->_arena == NULL) free(vec);
+    return data;
 }
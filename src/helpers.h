@@ -5,17 +5,36 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "arena.h"
+
+char *str_sub(const char *root, int start, size_t size);
+
 /**
- * Convert int to string. Result is allocated so remember
- * to free.
+ * Character classification is a single load from a 256 entry table
+ * (see helpers.c), so these helpers inline into the lexer's hot loop.
  */
-char *int_to_str(int value);
-char *str_sub(const char *root, int start, size_t size);
-bool is_digit(char c);
-bool is_hex(char c);
-bool is_alpha(char c);
-bool is_alnum(char c);
-int digit_count(int d);
+enum char_class {
+    CHAR_SPACE  = 1 << 0,   // ' ', '\t', '\r', '\n'
+    CHAR_DIGIT  = 1 << 1,   // 0-9
+    CHAR_ALPHA  = 1 << 2,   // a-z A-Z
+    CHAR_HEX    = 1 << 3,   // 0-9 a-f A-F
+    CHAR_IDENT  = 1 << 4,   // a-z A-Z 0-9 _
+    CHAR_IDENT_START = 1 << 5,  // a-z A-Z _
+};
+
+extern const unsigned char char_classes[256];
+
+static inline bool char_is(char c, enum char_class cls) {
+    return (char_classes[(unsigned char) c] & cls) != 0;
+}
+
+static inline bool is_digit(char c) { return char_is(c, CHAR_DIGIT); }
+static inline bool is_hex(char c) { return char_is(c, CHAR_HEX); }
+static inline bool is_alpha(char c) { return char_is(c, CHAR_ALPHA); }
+static inline bool is_alnum(char c) { return char_is(c, CHAR_DIGIT | CHAR_ALPHA); }
+static inline bool is_space(char c) { return char_is(c, CHAR_SPACE); }
+static inline bool is_ident(char c) { return char_is(c, CHAR_IDENT); }
+static inline bool is_ident_start(char c) { return char_is(c, CHAR_IDENT_START); }
 
 /**
  * Copies a char array. Result is allocated so remember 
@@ -23,20 +42,81 @@ int digit_count(int d);
  */
 char *str_copy(const char *from);
 
-/** custom vector implementation */
+/**
+ * Growable array of `_membsize` byte elements.
+ *
+ * Capacity doubles when full, so pushing n elements copies O(n) bytes in
+ * total. Element access goes through the typed wrappers generated by
+ * VECTOR_DEFINE below rather than casting `_data` at every call site.
+ */
 struct m_vector {
     void* _data;
     int _membsize;
     int _size;
     int _capacity;
+    struct arena *_arena;   // NULL when the data is malloc'd
 };
 
-/** initialize a vector instance */
+/** initialize an empty vector, nothing is allocated until the first insert */
 struct m_vector *vector_init(int _membsize);
 
+/**
+ * A vector living in an arena. It is freed with the arena, vector_free()
+ * and vector_shrink() do nothing; outgrown blocks stay in the arena.
+ */
+struct m_vector *vector_init_arena(struct arena *arena, int _membsize);
+
 /**
  * Free the vector in memory.
  * Note: this function doesn't free internally allocated data.
  **/
 void vector_free(struct m_vector *vec);
-void vector_resize(struct m_vector *vec, size_t size);
+
+/**
+ * Make room for at least `capacity` elements. Growth is geometric: the
+ * new capacity is at least twice the old one.
+ */
+void vector_reserve(struct m_vector *vec, int capacity);
+
+/** drop the unused capacity once a vector is done growing */
+void vector_shrink(struct m_vector *vec);
+
+/**
+ * Free the vector but keep its elements: returns the data (NULL when
+ * empty), stores the element count in `size` and the caller owns the array
+ * (for arena vectors it stays in the arena).
+ */
+void *vector_release(struct m_vector *vec, int *size);
+
+/**
+ * Generates type checked accessors for a vector of `type`:
+ *
+ *     prefix_insert(vec, value)   append a copy of value
+ *     prefix_at(vec, pos)         element pos by value
+ *     prefix_ref(vec, pos)        pointer to element pos, valid until
+ *                                 the next insert
+ *
+ * The element size is checked against the vector in debug builds.
+ */
+#define VECTOR_DEFINE(prefix, type)                                         \
+    static inline void prefix##_insert(struct m_vector *vec, type data) {   \
+        VECTOR_CHECK(vec, type);                                            \
+        if (vec->_size == vec->_capacity)                                   \
+            vector_reserve(vec, vec->_size + 1);                            \
+        ((type*) vec->_data)[vec->_size++] = data;                          \
+    }                                                                       \
+    static inline type prefix##_at(const struct m_vector *vec, int pos) {   \
+        VECTOR_CHECK(vec, type);                                            \
+        return ((type const*) vec->_data)[pos];                             \
+    }                                                                       \
+    static inline type *prefix##_ref(struct m_vector *vec, int pos) {       \
+        VECTOR_CHECK(vec, type);                                            \
+        return &((type*) vec->_data)[pos];                                  \
+    }
+
+#ifdef DEBUG
+#include <assert.h>
+#define VECTOR_CHECK(vec, type) assert((vec)->_membsize == sizeof(type))
+#else
+#define VECTOR_CHECK(vec, type) ((void) 0)
+#endif
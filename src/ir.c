@@ -0,0 +1,430 @@
+#include "ir.h"
+
+static const char *const op_names[] = {
+    [IR_CONST] = "const", [IR_LOAD] = "load", [IR_STORE] = "store",
+    [IR_NEG] = "neg", [IR_NOT] = "not", [IR_ZEXT32] = "zext32",
+    [IR_ADD] = "add", [IR_SUB] = "sub", [IR_MUL] = "mul", [IR_DIV] = "div", [IR_REM] = "rem",
+    [IR_AND] = "and", [IR_OR] = "or", [IR_XOR] = "xor",
+    [IR_EQ] = "eq", [IR_NE] = "ne", [IR_LT] = "lt", [IR_LE] = "le", [IR_GT] = "gt", [IR_GE] = "ge",
+    [IR_PHI] = "phi", [IR_JMP] = "jmp", [IR_BR] = "br", [IR_RET] = "ret",
+};
+
+static const char *const type_names[] = { [IR_I32] = "i32", [IR_I64] = "i64" };
+
+int ir_arg_count(enum ir_op op) {
+    switch (op) {
+        case IR_CONST:
+        case IR_LOAD:
+        case IR_PHI:
+        case IR_JMP:
+            return 0;
+        case IR_STORE:
+        case IR_NEG:
+        case IR_NOT:
+        case IR_ZEXT32:
+        case IR_BR:
+        case IR_RET:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+bool ir_evaluate(enum ir_op op, uint64_t a, uint64_t b, uint64_t *result) {
+    const int64_t sa = (int64_t) a, sb = (int64_t) b;
+    switch (op) {
+        case IR_NEG:    *result = 0 - a; return true;
+        case IR_NOT:    *result = ~a; return true;
+        case IR_ZEXT32: *result = a & 0xFFFFFFFF; return true;
+        case IR_ADD:    *result = a + b; return true;
+        case IR_SUB:    *result = a - b; return true;
+        case IR_MUL:    *result = a * b; return true;
+        case IR_DIV:
+        case IR_REM:
+            if (sb == 0 || (sa == INT64_MIN && sb == -1)) return false;
+            *result = (uint64_t) (op == IR_DIV ? sa / sb : sa % sb);
+            return true;
+        case IR_AND:    *result = a & b; return true;
+        case IR_OR:     *result = a | b; return true;
+        case IR_XOR:    *result = a ^ b; return true;
+        case IR_EQ:     *result = sa == sb; return true;
+        case IR_NE:     *result = sa != sb; return true;
+        case IR_LT:     *result = sa < sb; return true;
+        case IR_LE:     *result = sa <= sb; return true;
+        case IR_GT:     *result = sa > sb; return true;
+        case IR_GE:     *result = sa >= sb; return true;
+        default:        return false;
+    }
+}
+
+struct ir_cfg ir_cfg_build(const struct ir_function *fn) {
+    const int blocks = fn->blocks->_size;
+    struct ir_cfg cfg = { (uint32_t*) calloc(blocks + 1, sizeof(uint32_t)), NULL };
+
+    // count, turn the counts into start positions, then fill
+    for (int b = 0; b < blocks; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        const struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+        for (int t = 0; t < ir_successor_count(last); t++) cfg.first[last->u.target[t] + 1]++;
+    }
+    for (int b = 0; b < blocks; b++) cfg.first[b + 1] += cfg.first[b];
+
+    cfg.preds = (uint32_t*) malloc((cfg.first[blocks] + 1) * sizeof(uint32_t));
+    uint32_t *fill = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    memcpy(fill, cfg.first, blocks * sizeof(uint32_t));
+    for (int b = 0; b < blocks; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        const struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+        for (int t = 0; t < ir_successor_count(last); t++) cfg.preds[fill[last->u.target[t]]++] = b;
+    }
+    free(fill);
+    return cfg;
+}
+
+void ir_cfg_free(struct ir_cfg *cfg) {
+    free(cfg->first);
+    free(cfg->preds);
+}
+
+/* dump start */
+#define dump_literal(out, text) output_literal(out, text)
+
+static void dump_token(struct output *out, struct token name) {
+    output_append(out, name.value, name.length);
+}
+
+static void dump_vreg(struct output *out, vreg r) {
+    dump_literal(out, "%");
+    output_uint(out, r);
+}
+
+static void dump_block(struct output *out, uint32_t b) {
+    dump_literal(out, "b");
+    output_uint(out, b);
+}
+
+static void dump_variable(struct output *out, const struct ir_module *m,
+        const struct ir_function *fn, struct ir_variable var)
+{
+    if (var.global) {
+        dump_literal(out, "@");
+        dump_token(out, ir_global_ref(m->globals, var.index)->var.name);
+    } else {
+        dump_literal(out, "$");
+        dump_token(out, ir_local_ref(fn->locals, var.index)->name);
+        dump_literal(out, ".");
+        output_uint(out, var.index);
+    }
+}
+
+static void dump_insn(struct output *out, const struct ir_module *m,
+        const struct ir_function *fn, const struct ir_insn *insn)
+{
+    dump_literal(out, "    ");
+    if (insn->dst != IR_NONE) {
+        dump_vreg(out, insn->dst);
+        dump_literal(out, " = ");
+    }
+    output_append(out, op_names[insn->op], strlen(op_names[insn->op]));
+
+    switch (insn->op) {
+        case IR_CONST:
+            dump_literal(out, " ");
+            output_int(out, (int64_t) insn->u.imm);
+            break;
+        case IR_LOAD:
+        case IR_STORE:
+            dump_literal(out, ".");
+            output_append(out, type_names[insn->type], 3);
+            dump_literal(out, " ");
+            dump_variable(out, m, fn, insn->u.var);
+            if (insn->op == IR_STORE) {
+                dump_literal(out, ", ");
+                dump_vreg(out, insn->args[0]);
+            }
+            break;
+        case IR_PHI:
+            for (uint32_t i = 0; i < insn->u.phi.count; i++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, insn->u.phi.first + i);
+                if (i > 0) dump_literal(out, ",");
+                dump_literal(out, " [");
+                dump_block(out, arg.block);
+                dump_literal(out, ": ");
+                dump_vreg(out, arg.value);
+                dump_literal(out, "]");
+            }
+            break;
+        case IR_JMP:
+            dump_literal(out, " ");
+            dump_block(out, insn->u.target[0]);
+            break;
+        case IR_BR:
+            dump_literal(out, " ");
+            dump_vreg(out, insn->args[0]);
+            dump_literal(out, ", ");
+            dump_block(out, insn->u.target[0]);
+            dump_literal(out, ", ");
+            dump_block(out, insn->u.target[1]);
+            break;
+        default:
+            for (int i = 0; i < ir_arg_count(insn->op); i++) {
+                if (insn->args[i] == IR_NONE) break;     // ret without a value
+                if (i > 0) dump_literal(out, ",");
+                dump_literal(out, " ");
+                dump_vreg(out, insn->args[i]);
+            }
+            break;
+    }
+    dump_literal(out, "\n");
+}
+
+static void dump_datatype(struct output *out, enum datatype type) {
+    switch (type) {
+        case DATATYPE_INT:  dump_literal(out, "int"); break;
+        case DATATYPE_CHAR: dump_literal(out, "char"); break;
+        case DATATYPE_VOID: dump_literal(out, "void"); break;
+        default:            dump_literal(out, "?"); break;
+    }
+}
+
+/**
+ * global @g: int = 5
+ *
+ * function @main
+ *     local $a.0: int
+ * b0:
+ *     %1 = const 4
+ *     store.i32 $a.0, %1
+ *     ret %1
+ */
+void ir_dump(const struct ir_module *m, struct output *out) {
+    for (int i = 0; i < m->globals->_size; i++) {
+        const struct ir_global *g = ir_global_ref(m->globals, i);
+        dump_literal(out, "global @");
+        dump_token(out, g->var.name);
+        dump_literal(out, ": ");
+        dump_datatype(out, g->var.type);
+        dump_literal(out, " = ");
+        output_int(out, (int64_t) g->value);
+        dump_literal(out, "\n\n");
+    }
+
+    for (int i = 0; i < m->functions->_size; i++) {
+        const struct ir_function *fn = ir_function_ref(m->functions, i);
+        if (fn->is_static) dump_literal(out, "static ");
+        dump_literal(out, "function @");
+        dump_token(out, fn->name);
+        dump_literal(out, "\n");
+
+        for (int l = 0; l < fn->locals->_size; l++) {
+            const struct ir_local *local = ir_local_ref(fn->locals, l);
+            dump_literal(out, "    local ");
+            dump_variable(out, m, fn, (struct ir_variable) { false, l });
+            dump_literal(out, ": ");
+            dump_datatype(out, local->type);
+            dump_literal(out, "\n");
+        }
+
+        for (int b = 0; b < fn->blocks->_size; b++) {
+            struct m_vector *insns = ir_insns(fn, b);
+            dump_block(out, b);
+            dump_literal(out, ":\n");
+            for (int k = 0; k < insns->_size; k++)
+                dump_insn(out, m, fn, ir_insn_ref(insns, k));
+        }
+        dump_literal(out, "\n");
+    }
+}
+/* dump end */
+
+/* verifier start */
+struct verifier {
+    const struct ir_module *module;
+    const struct ir_function *fn;
+    int block;
+
+    int *preds;             // block -> number of predecessors
+    uint32_t *defined;      // vreg -> block + 1 of its definition
+    int *position;          // vreg -> index of its definition in that block
+};
+
+static bool verify_error(struct verifier *v, const char *problem, int insn) {
+    fprintf(stderr, "Invalid IR in %.*s, block %d, instruction %d: %s\n",
+        v->fn->name.length, v->fn->name.value, v->block, insn, problem);
+    return false;
+}
+
+/** a register used at (block, insn) has to be defined already in that block or elsewhere */
+static bool verify_use(struct verifier *v, vreg r, int insn) {
+    if (r == IR_NONE || r >= v->fn->vreg_count) return verify_error(v, "bad register", insn);
+    if (v->defined[r] == 0) return verify_error(v, "register is never defined", insn);
+    if (v->defined[r] == (uint32_t) v->block + 1 && v->position[r] >= insn)
+        return verify_error(v, "register used before its definition", insn);
+    return true;
+}
+
+static bool verify_target(struct verifier *v, uint32_t target, int insn) {
+    if (target >= (uint32_t) v->fn->blocks->_size) return verify_error(v, "bad branch target", insn);
+    if (target <= (uint32_t) v->block) return verify_error(v, "branch goes backwards", insn);
+    return true;
+}
+
+static bool verify_insn(struct verifier *v, const struct ir_insn *insn, int i, int size) {
+    if (insn->op > IR_RET) return verify_error(v, "unknown operation", i);
+    if (ir_is_terminator(insn->op) != (i == size - 1))
+        return verify_error(v, "a block has to end with its only terminator", i);
+
+    switch (insn->op) {
+        case IR_LOAD:
+        case IR_STORE: {
+            const struct m_vector *vars = insn->u.var.global ? v->module->globals : v->fn->locals;
+            if (insn->u.var.index >= (uint32_t) vars->_size)
+                return verify_error(v, "bad variable", i);
+            break;
+        }
+        case IR_PHI:
+            if (i > 0 && ir_insn_at(ir_insns(v->fn, v->block), i - 1).op != IR_PHI)
+                return verify_error(v, "phi after other instructions", i);
+            if ((int) insn->u.phi.count != v->preds[v->block])
+                return verify_error(v, "phi needs one value per predecessor", i);
+            break;
+        case IR_JMP:
+            if (!verify_target(v, insn->u.target[0], i)) return false;
+            break;
+        case IR_BR:
+            for (int t = 0; t < 2; t++) {
+                if (!verify_target(v, insn->u.target[t], i)) return false;
+                const struct m_vector *target = ir_insns(v->fn, insn->u.target[t]);
+                if (target->_size > 0 && ir_insn_at(target, 0).op == IR_PHI)
+                    return verify_error(v, "conditional branch to a block with phis", i);
+            }
+            break;
+        default:
+            break;
+    }
+
+    const int args = ir_arg_count(insn->op);
+    for (int a = 0; a < args; a++) {
+        if (insn->op == IR_RET && insn->args[a] == IR_NONE) continue;
+        if (!verify_use(v, insn->args[a], i)) return false;
+    }
+
+    const bool defines = insn->op != IR_STORE && !ir_is_terminator(insn->op);
+    if (defines != (insn->dst != IR_NONE)) return verify_error(v, "wrong destination", i);
+    return true;
+}
+
+/**
+ * Every use has to be dominated by its definition. Only reachable code
+ * is checked, the blocks after a return have no dominators.
+ */
+static bool verify_dominance(struct verifier *v) {
+    const struct ir_function *fn = v->fn;
+    struct ir_cfg cfg = ir_cfg_build(fn);
+    struct ir_dominators dom = ir_dominators_build(fn, &cfg);
+    bool ok = true;
+
+    for (v->block = 0; v->block < fn->blocks->_size && ok; v->block++) {
+        if (dom.idom[v->block] == IR_NO_BLOCK) continue;
+        struct m_vector *insns = ir_insns(fn, v->block);
+        for (int i = 0; i < insns->_size && ok; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            if (insn->op == IR_PHI) {
+                for (uint32_t p = 0; p < insn->u.phi.count && ok; p++) {
+                    const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, insn->u.phi.first + p);
+                    const uint32_t def = v->defined[arg.value] - 1;
+                    if (dom.idom[arg.block] != IR_NO_BLOCK && !ir_dominates(&dom, def, arg.block))
+                        ok = verify_error(v, "phi value doesn't dominate its predecessor", i);
+                }
+                continue;
+            }
+
+            for (int a = 0; a < ir_arg_count(insn->op) && ok; a++) {
+                if (insn->args[a] == IR_NONE) continue;
+                const uint32_t def = v->defined[insn->args[a]] - 1;
+                if (!ir_dominates(&dom, def, v->block))
+                    ok = verify_error(v, "register used where its definition doesn't dominate", i);
+            }
+        }
+    }
+
+    ir_dominators_free(&dom);
+    ir_cfg_free(&cfg);
+    return ok;
+}
+
+static bool verify_function(struct verifier *v) {
+    const struct ir_function *fn = v->fn;
+    const int blocks = fn->blocks->_size;
+    if (blocks == 0) return verify_error(v, "no entry block", 0);
+
+    v->preds = (int*) calloc(blocks, sizeof(int));
+    v->defined = (uint32_t*) calloc(fn->vreg_count, sizeof(uint32_t));
+    v->position = (int*) calloc(fn->vreg_count, sizeof(int));
+    bool ok = true;
+
+    // definitions and predecessors first, uses can come from other blocks
+    for (v->block = 0; v->block < blocks && ok; v->block++) {
+        const struct m_vector *insns = ir_insns(fn, v->block);
+        if (insns->_size == 0) {
+            ok = verify_error(v, "empty block", 0);
+            break;
+        }
+
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn insn = ir_insn_at(insns, i);
+            if (insn.dst == IR_NONE) continue;
+            if (insn.dst >= fn->vreg_count || v->defined[insn.dst] != 0) {
+                ok = verify_error(v, insn.dst >= fn->vreg_count ? "bad register" : "register defined twice", i);
+                break;
+            }
+            v->defined[insn.dst] = v->block + 1;
+            v->position[insn.dst] = i;
+        }
+
+        const struct ir_insn last = ir_insn_at(insns, insns->_size - 1);
+        for (int t = 0; t < ir_successor_count(&last); t++)
+            if (last.u.target[t] < (uint32_t) blocks) v->preds[last.u.target[t]]++;
+    }
+
+    for (v->block = 0; v->block < blocks && ok; v->block++) {
+        struct m_vector *insns = ir_insns(fn, v->block);
+        for (int i = 0; i < insns->_size && ok; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            ok = verify_insn(v, insn, i, insns->_size);
+
+            // every incoming value has to come from a predecessor
+            for (uint32_t p = 0; ok && insn->op == IR_PHI && p < insn->u.phi.count; p++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, insn->u.phi.first + p);
+                const struct m_vector *from = arg.block < (uint32_t) blocks ? ir_insns(fn, arg.block) : NULL;
+                if (from == NULL || from->_size == 0) {
+                    ok = verify_error(v, "phi value from a bad block", i);
+                    break;
+                }
+
+                const struct ir_insn last = ir_insn_at(from, from->_size - 1);
+                if (last.op != IR_JMP || last.u.target[0] != (uint32_t) v->block)
+                    ok = verify_error(v, "phi value from a block that doesn't jump here", i);
+                else if (arg.value == IR_NONE || arg.value >= fn->vreg_count || v->defined[arg.value] == 0)
+                    ok = verify_error(v, "phi value is never defined", i);
+            }
+        }
+    }
+
+    if (ok) ok = verify_dominance(v);
+
+    free(v->preds);
+    free(v->defined);
+    free(v->position);
+    return ok;
+}
+
+bool ir_verify(const struct ir_module *m) {
+    struct verifier v = { .module = m };
+    for (int i = 0; i < m->functions->_size; i++) {
+        v.fn = ir_function_ref(m->functions, i);
+        if (!verify_function(&v)) return false;
+    }
+    return true;
+}
+/* verifier end */
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "helpers.h"
+#include "output.h"
+#include "parser/nodes.h"
+
+/**
+ * Three address intermediate representation, built from the AST by
+ * ir_build() and lowered to assembly by arm_compile().
+ *
+ * A function is a list of basic blocks, the first one is the entry. Every
+ * block ends with exactly one terminator (jmp, br or ret) and a phi may
+ * only appear at its start. Values live in virtual registers that are
+ * defined exactly once, a join of two values is a phi. Locals and globals
+ * live in memory and are only reached through explicit loads and stores,
+ * which is where the C types show up: values are 64 bits wide (the
+ * arithmetic has always been done on x registers), memory accesses have
+ * the width of the variable.
+ *
+ * Conditional branches never target a block with phis, so the copies a
+ * phi needs can always be placed at the end of its predecessors. Branches
+ * only go forward, a block comes after all its predecessors.
+ *
+ * A definition dominates all its uses (the use of a phi value is at the
+ * end of the block it comes from), ir_verify() checks it.
+ */
+
+/** virtual register, IR_NONE is never defined */
+typedef uint32_t vreg;
+#define IR_NONE 0
+
+enum ir_type {
+    IR_I32,     // int and char variables
+    IR_I64,     // values in registers
+};
+
+enum ir_op {
+    IR_CONST,       // dst = imm
+    IR_LOAD,        // dst = zero extended variable
+    IR_STORE,       // variable = args[0], truncated to its width
+
+    // dst = op args[0]
+    IR_NEG, IR_NOT,
+    IR_ZEXT32,      // upper 32 bits cleared, what storing to an i32 and loading it back does
+
+    // dst = args[0] op args[1], division is signed
+    IR_ADD, IR_SUB, IR_MUL, IR_DIV, IR_REM,
+    IR_AND, IR_OR, IR_XOR,
+
+    // dst = 1 if args[0] op args[1] holds else 0, signed
+    IR_EQ, IR_NE, IR_LT, IR_LE, IR_GT, IR_GE,
+
+    IR_PHI,         // dst = the value coming from the block control came from
+
+    // terminators
+    IR_JMP,         // to target[0]
+    IR_BR,          // to target[0] if args[0] != 0, target[1] otherwise
+    IR_RET,         // args[0] or nothing
+};
+
+/** where a load or store goes, locals are numbered per function */
+struct ir_variable {
+    bool global;
+    uint32_t index;     // in ir_function.locals or ir_module.globals
+};
+
+/** one incoming value of a phi */
+struct ir_phi_arg {
+    uint32_t block;
+    vreg value;
+};
+
+VECTOR_DEFINE(ir_phi_arg, struct ir_phi_arg)
+
+struct ir_insn {
+    uint8_t op;         // enum ir_op
+    uint8_t type;       // enum ir_type, the width of a load or store
+    vreg dst;           // IR_NONE for stores and terminators
+    vreg args[2];
+
+    union {
+        uint64_t imm;               // IR_CONST
+        struct ir_variable var;     // IR_LOAD, IR_STORE
+        uint32_t target[2];         // IR_JMP, IR_BR
+        struct {
+            uint32_t first;         // in ir_function.phi_args
+            uint32_t count;
+        } phi;
+    } u;
+};
+
+VECTOR_DEFINE(ir_insn, struct ir_insn)
+
+struct ir_block {
+    struct m_vector *insns;     //: struct ir_insn
+};
+
+VECTOR_DEFINE(ir_block, struct ir_block)
+
+/** a variable with its C type */
+struct ir_local {
+    struct token name;
+    enum datatype type;
+};
+
+VECTOR_DEFINE(ir_local, struct ir_local)
+
+struct ir_function {
+    struct token name;
+    bool is_static;
+
+    struct m_vector *blocks;    //: struct ir_block
+    struct m_vector *locals;    //: struct ir_local
+    struct m_vector *phi_args;  //: struct ir_phi_arg
+    uint32_t vreg_count;        // registers are 1 .. vreg_count - 1
+};
+
+VECTOR_DEFINE(ir_function, struct ir_function)
+
+struct ir_global {
+    struct ir_local var;
+    uint64_t value;             // initializers are constants
+};
+
+VECTOR_DEFINE(ir_global, struct ir_global)
+
+struct ir_module {
+    struct m_vector *globals;   //: struct ir_global
+    struct m_vector *functions; //: struct ir_function
+};
+
+/** the instructions of block b */
+static inline struct m_vector *ir_insns(const struct ir_function *fn, uint32_t b) {
+    return ir_block_ref(fn->blocks, b)->insns;
+}
+
+static inline bool ir_is_terminator(enum ir_op op) {
+    return op == IR_JMP || op == IR_BR || op == IR_RET;
+}
+
+/** the operations whose result is 1 or 0 */
+static inline bool ir_is_compare(enum ir_op op) {
+    return op >= IR_EQ && op <= IR_GE;
+}
+
+/** number of successors of a terminator, they are in u.target */
+static inline int ir_successor_count(const struct ir_insn *insn) {
+    return insn->op == IR_BR ? 2 : insn->op == IR_JMP ? 1 : 0;
+}
+
+/** number of virtual register operands in args */
+int ir_arg_count(enum ir_op op);
+
+/**
+ * Value of an operation on constants, what the generated code computes
+ * on x registers. Division by zero and INT64_MIN / -1 are left to run
+ * time (false), the error (if any) is theirs. Shared by SCCP and
+ * fold_program(), so an expression gives the same value whether it is
+ * folded before or after the IR is built.
+ */
+bool ir_evaluate(enum ir_op op, uint64_t a, uint64_t b, uint64_t *result);
+
+/** whether the upper 32 bits of the result are clear, judging by the instruction alone */
+static inline bool ir_zero_extends(const struct ir_insn *insn) {
+    switch (insn->op) {
+        case IR_CONST:
+            return insn->u.imm <= 0xFFFFFFFF;
+        case IR_LOAD:
+        case IR_ZEXT32:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Predecessors of every block: those of block b are
+ * preds[first[b]] .. preds[first[b + 1] - 1]. Free with ir_cfg_free().
+ */
+struct ir_cfg {
+    uint32_t *first;
+    uint32_t *preds;
+};
+
+struct ir_cfg ir_cfg_build(const struct ir_function *fn);
+void ir_cfg_free(struct ir_cfg *cfg);
+
+/**
+ * Dominator tree of the blocks reachable from the entry. idom of the
+ * entry is the entry itself, IR_NO_BLOCK for unreachable blocks.
+ * Free with ir_dominators_free().
+ */
+#define IR_NO_BLOCK UINT32_MAX
+
+struct ir_dominators {
+    uint32_t *idom;
+    uint32_t *_enter, *_leave;  // preorder interval in the tree, for ir_dominates()
+};
+
+struct ir_dominators ir_dominators_build(const struct ir_function *fn, const struct ir_cfg *cfg);
+void ir_dominators_free(struct ir_dominators *d);
+
+/** whether block a dominates block b, both reachable */
+static inline bool ir_dominates(const struct ir_dominators *d, uint32_t a, uint32_t b) {
+    return d->_enter[a] <= d->_enter[b] && d->_leave[b] <= d->_leave[a];
+}
+
+/**
+ * Build the IR of a program in the arena. Reports the first error on
+ * stderr and returns NULL.
+ */
+struct ir_module *ir_build(struct program *p, struct arena *arena);
+
+/**
+ * Optimize every function: locals are promoted to registers (mem2reg),
+ * then constants are propagated along the paths that can actually run
+ * (SCCP), unreachable blocks, copies and dead code are removed. Cheap
+ * right sides of && and || are computed unconditionally and the rest
+ * branch straight to where the condition leads.
+ */
+void ir_optimize(struct ir_module *m, struct arena *arena);
+
+/** promote the locals of a function to registers, see ir_ssa.c */
+void ir_mem2reg(struct ir_function *fn, struct arena *arena);
+
+/**
+ * Check the invariants listed at the top. Problems are reported on
+ * stderr, a module that fails is a bug in whoever produced it.
+ */
+bool ir_verify(const struct ir_module *m);
+
+/** textual form of the module, see --emit-ir */
+void ir_dump(const struct ir_module *m, struct output *out);
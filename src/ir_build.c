@@ -0,0 +1,476 @@
+#include "ir.h"
+#include "lexer/intern.h"
+#include "lexer/lexer.h"
+#include "source.h"
+#include "symtab.h"
+
+/**
+ * AST to IR. Expressions are walked with an explicit stack like the code
+ * generator used to, every finished node leaves its register on a value
+ * stack for its parent. The diagnostics are the ones the code generator
+ * gave when it worked on the AST directly.
+ */
+
+struct ir_builder {
+    struct arena *arena;
+    struct ir_module *module;
+    struct ir_function *fn;
+    uint32_t block;                 // where instructions go
+
+    struct symtab *symbols;         // variables in scope, index is the IR variable
+    const struct ast *ast;          // expressions of the current declaration
+    struct source *source;          // for line numbers in diagnostics
+
+    struct m_vector *_walk;         //: struct walk, see build_expression
+    struct m_vector *_values;       //: vreg, values of finished nodes
+};
+
+/** where the walk in build_expression is in a node */
+enum walk_state {
+    WALK_ENTER,     // nothing done yet
+    WALK_LEFT,      // first operand (or the condition) is done
+    WALK_RIGHT,     // second operand (or the first arm) is done
+    WALK_ARMS,      // both arms of a ternary are done
+};
+
+struct walk {
+    expr_id expr;
+    enum walk_state state;
+
+    // ternary: where the second arm starts, where the first one ended.
+    // && and ||: blocks[0] is where control goes when the left side decides
+    uint32_t blocks[2];
+};
+
+VECTOR_DEFINE(walk, struct walk)
+VECTOR_DEFINE(vreg, vreg)
+
+/** source text of the token at offset, for diagnostics */
+static struct token build_token(struct ir_builder *b, enum token_type kind, uint32_t offset) {
+    return token_view(b->source->data, kind, offset, 0, NULL);
+}
+
+static uint32_t new_block(struct ir_builder *b) {
+    ir_block_insert(b->fn->blocks, (struct ir_block) {
+        .insns = vector_init_arena(b->arena, sizeof(struct ir_insn)),
+    });
+    return b->fn->blocks->_size - 1;
+}
+
+static bool is_terminated(struct ir_builder *b) {
+    const struct m_vector *insns = ir_insns(b->fn, b->block);
+    return insns->_size > 0 && ir_is_terminator(ir_insn_at(insns, insns->_size - 1).op);
+}
+
+/**
+ * Append to the current block, code after a return goes to a new block
+ * nothing jumps to. Returns the register the instruction defines.
+ */
+static vreg emit(struct ir_builder *b, struct ir_insn insn) {
+    if (is_terminated(b)) b->block = new_block(b);
+
+    const bool defines = insn.op != IR_STORE && !ir_is_terminator(insn.op);
+    insn.dst = defines ? b->fn->vreg_count++ : IR_NONE;
+    ir_insn_insert(ir_insns(b->fn, b->block), insn);
+    return insn.dst;
+}
+
+static vreg emit_op(struct ir_builder *b, enum ir_op op, vreg left, vreg right) {
+    return emit(b, (struct ir_insn) { .op = op, .type = IR_I64, .args = { left, right } });
+}
+
+static vreg emit_const(struct ir_builder *b, uint64_t value) {
+    return emit(b, (struct ir_insn) { .op = IR_CONST, .type = IR_I64, .u.imm = value });
+}
+
+static void emit_jmp(struct ir_builder *b, uint32_t target) {
+    emit(b, (struct ir_insn) { .op = IR_JMP, .u.target = { target } });
+}
+
+static struct ir_variable variable_of(const struct symbol *s) {
+    return (struct ir_variable) { s->storage == STORAGE_STATIC, s->index };
+}
+
+static vreg pop_value(struct ir_builder *b) {
+    return vreg_at(b->_values, --b->_values->_size);
+}
+
+/** the variable a name refers to, NULL after reporting it if there is none */
+static struct symbol *lookup_variable(struct ir_builder *b, int symbol) {
+    struct symbol *v = symtab_lookup(b->symbols, symbol);
+    if (v == NULL) {
+        struct interned name = intern_at(symbol);
+        fprintf(stderr, "Variable %.*s does not exist\n", name.length, name.value);
+    }
+    return v;
+}
+
+static void store_variable(struct ir_builder *b, const struct symbol *v, vreg value) {
+    emit(b, (struct ir_insn) {
+        .op = IR_STORE, .type = IR_I32, .args = { value }, .u.var = variable_of(v),
+    });
+}
+
+/** value of a prefix or postfix operator applied to `value` */
+static vreg build_unary(struct ir_builder *b, const struct Expr *expr, vreg value) {
+    const struct Expr *operand = ast_node(b->ast, expr->obj.unary.value);
+
+    switch (expr->operation) {
+        case TOKEN_PLUS:
+            return value;
+        case TOKEN_MINUS:
+            return emit_op(b, IR_NEG, value, IR_NONE);
+        case TOKEN_TILDA:
+            return emit_op(b, IR_NOT, value, IR_NONE);
+        case TOKEN_BANG:
+            return emit_op(b, IR_EQ, value, emit_const(b, 0));
+
+        case TOKEN_PLUS_PLUS:
+        case TOKEN_MINUS_MINUS: {
+            const bool increment = expr->operation == TOKEN_PLUS_PLUS;
+            if (operand->type != EXPR_PRIMARY || operand->operation != TOKEN_IDENTIFIER) {
+                fprintf(stderr, "Error on line %d, you can only %s identifiers\n",
+                    source_line(b->source, expr->offset), increment ? "increment" : "decrement");
+                return IR_NONE;
+            }
+
+            // both forms give the new value
+            const vreg result = emit_op(b, increment ? IR_ADD : IR_SUB, value, emit_const(b, 1));
+            store_variable(b, symtab_lookup(b->symbols, operand->obj.symbol), result);
+            return result;
+        }
+
+        default: {
+            struct token op = build_token(b, expr->operation, expr->offset);
+            fprintf(stderr, "Unsupported unary operation '%.*s'\n", op.length, op.value);
+            return IR_NONE;
+        }
+    }
+}
+
+static vreg build_binary(struct ir_builder *b, const struct Expr *expr, vreg left, vreg right) {
+    enum ir_op op;
+    switch (expr->operation) {
+        case TOKEN_PLUS:                op = IR_ADD; break;
+        case TOKEN_MINUS:               op = IR_SUB; break;
+        case TOKEN_STAR:                op = IR_MUL; break;
+        case TOKEN_SLASH:               op = IR_DIV; break;
+        case TOKEN_PERCENT:             op = IR_REM; break;
+        case TOKEN_AND:                 op = IR_AND; break;
+        case TOKEN_CARET:               op = IR_XOR; break;
+        case TOKEN_PIPE:                op = IR_OR; break;
+        case TOKEN_BANG_EQUAL:          op = IR_NE; break;
+        case TOKEN_EQUAL_EQUAL:         op = IR_EQ; break;
+        case TOKEN_GREATER_THAN:        op = IR_GT; break;
+        case TOKEN_GREATER_THAN_EQUAL:  op = IR_GE; break;
+        case TOKEN_LESS_THAN:           op = IR_LT; break;
+        case TOKEN_LESS_THAN_EQUAL:     op = IR_LE; break;
+
+        default: {
+            struct token token = build_token(b, expr->operation, expr->offset);
+            fprintf(stderr, "Unexpected operator token '%.*s' on like %d\n",
+                    token.length, token.value, source_line(b->source, expr->offset));
+            return IR_NONE;
+        }
+    }
+    return emit_op(b, op, left, right);
+}
+
+static bool is_logical(const struct Expr *expr) {
+    return expr->operation == TOKEN_AND_AND || expr->operation == TOKEN_PIPE_PIPE;
+}
+
+/**
+ * The left side of && or || is done: the right side only runs when it
+ * doesn't decide the result already. Otherwise control goes through a
+ * block of its own, conditional branches can't go straight to the join
+ * with its phi.
+ */
+static void short_circuit(struct ir_builder *b, const struct Expr *e, struct walk *top) {
+    const vreg left = pop_value(b);
+    const uint32_t right = new_block(b), decided = new_block(b);
+    emit(b, (struct ir_insn) {
+        .op = IR_BR, .args = { left },
+        .u.target = { e->operation == TOKEN_AND_AND ? right : decided,
+                      e->operation == TOKEN_AND_AND ? decided : right },
+    });
+
+    b->block = right;
+    top->blocks[0] = decided;
+}
+
+/** the right side of && or || is done, returns the 0 or 1 of the whole */
+static vreg join_logical(struct ir_builder *b, const struct Expr *e, struct walk *top, vreg right) {
+    const vreg value = emit_op(b, IR_NE, right, emit_const(b, 0));
+    const uint32_t right_end = b->block, join = new_block(b);
+    emit_jmp(b, join);
+
+    b->block = top->blocks[0];
+    const vreg decided = emit_const(b, e->operation == TOKEN_PIPE_PIPE);
+    emit_jmp(b, join);
+
+    struct m_vector *args = b->fn->phi_args;
+    const uint32_t first_arg = args->_size;
+    ir_phi_arg_insert(args, (struct ir_phi_arg) { right_end, value });
+    ir_phi_arg_insert(args, (struct ir_phi_arg) { top->blocks[0], decided });
+
+    b->block = join;
+    return emit(b, (struct ir_insn) { .op = IR_PHI, .type = IR_I64, .u.phi = { first_arg, 2 } });
+}
+
+/**
+ * Emit the code of an expression and return the register with its value,
+ * IR_NONE after reporting an error.
+ *
+ * The tree is walked with an explicit stack instead of recursion, so
+ * nesting depth is only limited by memory.
+ */
+static vreg build_expression(struct ir_builder *b, expr_id expr) {
+    struct m_vector *stack = b->_walk;
+    stack->_size = 0;
+    b->_values->_size = 0;
+    walk_insert(stack, (struct walk) { .expr = expr, .state = WALK_ENTER });
+
+    while (stack->_size > 0) {
+        struct walk *top = walk_ref(stack, stack->_size - 1);
+        const struct Expr *e = ast_node(b->ast, top->expr);
+        expr_id next = EXPR_NONE;
+        vreg value = IR_NONE;       // of e once it is done
+
+        switch (e->type) {
+            case EXPR_PRIMARY:
+                if (e->operation == TOKEN_CONSTANT) {
+                    value = emit_const(b, e->obj.constant);
+                } else {
+                    struct symbol *v = lookup_variable(b, e->obj.symbol);
+                    if (v == NULL) return IR_NONE;
+                    value = emit(b, (struct ir_insn) {
+                        .op = IR_LOAD, .type = IR_I32, .u.var = variable_of(v),
+                    });
+                }
+                break;
+
+            case EXPR_UNARY_OPERATION:
+                if (top->state == WALK_ENTER) {
+                    top->state = WALK_LEFT;
+                    next = e->obj.unary.value;
+                } else {
+                    value = build_unary(b, e, pop_value(b));
+                    if (value == IR_NONE) return IR_NONE;
+                }
+                break;
+
+            case EXPR_BINARY_OPERATION:
+                if (top->state == WALK_ENTER) {
+                    top->state = WALK_LEFT;
+                    next = e->obj.binary.left;
+                } else if (top->state == WALK_LEFT) {
+                    if (is_logical(e)) short_circuit(b, e, top);
+                    top->state = WALK_RIGHT;
+                    next = e->obj.binary.right;
+                } else if (is_logical(e)) {
+                    value = join_logical(b, e, top, pop_value(b));
+                } else {
+                    const vreg right = pop_value(b);
+                    value = build_binary(b, e, pop_value(b), right);
+                    if (value == IR_NONE) return IR_NONE;
+                }
+                break;
+
+            case EXPR_ASSIGNMENT:
+                if (top->state == WALK_ENTER) {
+                    if (symtab_lookup(b->symbols, e->obj.assignment.name) == NULL) {
+                        struct interned name = intern_at(e->obj.assignment.name);
+                        fprintf(stderr, "Variable %.*s not defined on line %d\n",
+                            name.length, name.value, source_line(b->source, e->offset));
+                        return IR_NONE;
+                    }
+                    if (e->operation != TOKEN_EQUAL) {
+                        struct token op = build_token(b, e->operation, e->offset);
+                        fprintf(stderr, "Unsupported assignment operator '%.*s' on line %d\n",
+                            op.length, op.value, source_line(b->source, e->offset));
+                        return IR_NONE;
+                    }
+
+                    top->state = WALK_LEFT;
+                    next = e->obj.assignment.right;
+                } else {
+                    value = pop_value(b);
+                    store_variable(b, symtab_lookup(b->symbols, e->obj.assignment.name), value);
+                }
+                break;
+
+            case EXPR_TERNARY_OPERATION: {
+                const struct Expr *arms = ast_node(b->ast, e->obj.ternary.arms);
+                if (top->state == WALK_ENTER) {
+                    top->state = WALK_LEFT;
+                    next = e->obj.ternary.condition;
+                } else if (top->state == WALK_LEFT) {
+                    // only the arm that is taken runs
+                    const vreg condition = pop_value(b);
+                    const uint32_t taken = new_block(b), other = new_block(b);
+                    emit(b, (struct ir_insn) {
+                        .op = IR_BR, .args = { condition }, .u.target = { taken, other },
+                    });
+
+                    b->block = taken;
+                    top->blocks[0] = other;
+                    top->state = WALK_RIGHT;
+                    next = arms->obj.binary.left;
+                } else if (top->state == WALK_RIGHT) {
+                    top->blocks[1] = b->block;
+                    b->block = top->blocks[0];
+                    top->state = WALK_ARMS;
+                    next = arms->obj.binary.right;
+                } else {
+                    // where they meet, created last so it comes after both arms
+                    const uint32_t join = new_block(b);
+                    const vreg second = pop_value(b), first = pop_value(b);
+                    emit_jmp(b, join);
+
+                    // the first arm jumps to the join only now, its block
+                    // had to stay open while the second one was built
+                    const uint32_t second_end = b->block;
+                    b->block = top->blocks[1];
+                    emit_jmp(b, join);
+
+                    struct m_vector *args = b->fn->phi_args;
+                    const uint32_t first_arg = args->_size;
+                    ir_phi_arg_insert(args, (struct ir_phi_arg) { top->blocks[1], first });
+                    ir_phi_arg_insert(args, (struct ir_phi_arg) { second_end, second });
+
+                    b->block = join;
+                    value = emit(b, (struct ir_insn) {
+                        .op = IR_PHI, .type = IR_I64, .u.phi = { first_arg, 2 },
+                    });
+                }
+                break;
+            }
+
+            default:
+                fprintf(stderr, "Unsupported expression type\n");
+                return IR_NONE;
+        }
+
+        if (next != EXPR_NONE) {
+            walk_insert(stack, (struct walk) { .expr = next, .state = WALK_ENTER });
+        } else {
+            vreg_insert(b->_values, value);
+            stack->_size--;     // done with e
+        }
+    }
+
+    return pop_value(b);
+}
+
+/** declare a variable with its initial value, returns NULL after reporting a redeclaration */
+static struct symbol *declare_variable(struct ir_builder *b, struct variable_decl *vd,
+        enum storage_class storage, uint32_t index)
+{
+    struct symbol *s = symtab_declare(b->symbols, vd->name, vd->type, storage, 8);
+    if (s == NULL) {
+        fprintf(stderr, "Redeclaration of variable %.*s on line %d\n",
+            vd->name.length, vd->name.value, source_line(b->source, vd->name.offset));
+        return NULL;
+    }
+    s->index = index;
+    return s;
+}
+
+static bool build_local(struct ir_builder *b, struct variable_decl *vd) {
+    const vreg value = build_expression(b, vd->value);
+    if (value == IR_NONE) return false;
+
+    struct symbol *s = declare_variable(b, vd, STORAGE_AUTO, b->fn->locals->_size);
+    if (s == NULL) return false;
+
+    ir_local_insert(b->fn->locals, (struct ir_local) { vd->name, vd->type });
+    store_variable(b, s, value);
+    return true;
+}
+
+/** globals live in the data section, so they need a value at compile time */
+static bool build_global(struct ir_builder *b, struct variable_decl *vd) {
+    const struct Expr *value = ast_node(b->ast, vd->value);
+    if (value->type != EXPR_PRIMARY || value->operation != TOKEN_CONSTANT) {
+        fprintf(stderr, "Initializer of %.*s on line %d is not a constant\n",
+            vd->name.length, vd->name.value, source_line(b->source, vd->name.offset));
+        return false;
+    }
+
+    struct m_vector *globals = b->module->globals;
+    if (declare_variable(b, vd, STORAGE_STATIC, globals->_size) == NULL) return false;
+
+    ir_global_insert(globals, (struct ir_global) {
+        .var = { vd->name, vd->type },
+        .value = value->obj.constant,
+    });
+    return true;
+}
+
+static bool build_statement(struct ir_builder *b, struct statement *s) {
+    switch (s->type) {
+        case STATEMENT_RETURN: {
+            const vreg value = build_expression(b, s->obj.ret.value);
+            if (value == IR_NONE) return false;
+            emit(b, (struct ir_insn) { .op = IR_RET, .args = { value } });
+            return true;
+        }
+        case STATEMENT_VARIABLE_DECL:
+            return build_local(b, &s->obj.var);
+        case STATEMENT_EXPRESSION:
+            return build_expression(b, s->obj.expr) != IR_NONE;
+    }
+    return false;
+}
+
+static bool build_function(struct ir_builder *b, struct function *f) {
+    ir_function_insert(b->module->functions, (struct ir_function) {
+        .name = f->name,
+        .is_static = f->is_static,
+        .blocks = vector_init_arena(b->arena, sizeof(struct ir_block)),
+        .locals = vector_init_arena(b->arena, sizeof(struct ir_local)),
+        .phi_args = vector_init_arena(b->arena, sizeof(struct ir_phi_arg)),
+        .vreg_count = 1,
+    });
+    b->fn = ir_function_ref(b->module->functions, b->module->functions->_size - 1);
+    b->block = new_block(b);
+
+    symtab_push_scope(b->symbols);
+    for (int i = 0; i < f->statements->_size; i++) {
+        if (!build_statement(b, statement_ref(f->statements, i)))
+            return false;
+    }
+    symtab_pop_scope(b->symbols);
+
+    // falling off the end returns whatever is in the result register
+    if (!is_terminated(b)) emit(b, (struct ir_insn) { .op = IR_RET });
+    return true;
+}
+
+struct ir_module *ir_build(struct program *p, struct arena *arena) {
+    struct ir_module *m = (struct ir_module*) arena_alloc(arena, sizeof(struct ir_module));
+    m->globals = vector_init_arena(arena, sizeof(struct ir_global));
+    m->functions = vector_init_arena(arena, sizeof(struct ir_function));
+
+    struct ir_builder b = {
+        .arena = arena,
+        .module = m,
+        .symbols = symtab_init(arena, intern_count()),
+        .source = p->source,
+        ._walk = vector_init_arena(arena, sizeof(struct walk)),
+        ._values = vector_init_arena(arena, sizeof(vreg)),
+    };
+
+    for (int i = 0; i < p->declarations->_size; i++) {
+        struct declaration *d = declaration_ref(p->declarations, i);
+        b.ast = &d->ast;
+
+        const bool ok = d->type == DECLARATION_FUNCTION
+            ? build_function(&b, &d->obj.func)
+            : build_global(&b, &d->obj.var);
+        if (!ok) return NULL;
+    }
+
+    return m;
+}
@@ -0,0 +1,861 @@
+#include "ir.h"
+
+/**
+ * Optimizations on the SSA form, see ir_optimize() for the order they run
+ * in. Each pass is linear in the size of the function (SCCP visits an
+ * instruction at most once per change of its operands, which can only
+ * happen twice per register).
+ */
+
+/** where a register is defined, for the passes that follow uses back */
+struct definition {
+    uint32_t block;
+    uint32_t index;
+};
+
+static struct definition *definitions(const struct ir_function *fn) {
+    struct definition *defs = (struct definition*) calloc(fn->vreg_count, sizeof(struct definition));
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const vreg dst = ir_insn_ref(insns, i)->dst;
+            if (dst != IR_NONE) defs[dst] = (struct definition) { b, i };
+        }
+    }
+    return defs;
+}
+
+/**
+ * Which registers hold 0 or 1: compares, such constants, and/or/xor and
+ * phis of them. Blocks come after their predecessors, so one pass in
+ * order sees operands first.
+ */
+static bool *booleans(const struct ir_function *fn) {
+    bool *boolean = (bool*) calloc(fn->vreg_count, sizeof(bool));
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            switch (insn->op) {
+                case IR_CONST:
+                    boolean[insn->dst] = insn->u.imm <= 1;
+                    break;
+                case IR_AND: case IR_OR: case IR_XOR:
+                    boolean[insn->dst] = boolean[insn->args[0]] && boolean[insn->args[1]];
+                    break;
+                case IR_PHI:
+                    boolean[insn->dst] = true;
+                    for (uint32_t a = 0; a < insn->u.phi.count; a++)
+                        boolean[insn->dst] &= boolean[ir_phi_arg_at(fn->phi_args, insn->u.phi.first + a).value];
+                    break;
+                default:
+                    boolean[insn->dst] = ir_is_compare(insn->op);
+            }
+        }
+    }
+    return boolean;
+}
+
+/** how often every register is used, phi arguments included */
+static uint32_t *use_counts(const struct ir_function *fn) {
+    uint32_t *uses = (uint32_t*) calloc(fn->vreg_count, sizeof(uint32_t));
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            for (int a = 0; a < ir_arg_count(insn->op); a++) uses[insn->args[a]]++;
+        }
+    }
+    for (int a = 0; a < fn->phi_args->_size; a++) uses[ir_phi_arg_at(fn->phi_args, a).value]++;
+    return uses;
+}
+
+/** whether r is defined by `const value` */
+static bool is_constant(const struct ir_function *fn, const struct definition *defs, vreg r, uint64_t value) {
+    const struct ir_insn *def = ir_insn_ref(ir_insns(fn, defs[r].block), defs[r].index);
+    return def->op == IR_CONST && def->u.imm == value;
+}
+
+/** replace every use of a register by what `replace` maps it to, if anything */
+static void apply_replacements(struct ir_function *fn, const vreg *replace) {
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            struct ir_insn *insn = ir_insn_ref(insns, i);
+            for (int a = 0; a < ir_arg_count(insn->op); a++) {
+                vreg r = insn->args[a];
+                while (r != IR_NONE && replace[r] != IR_NONE) r = replace[r];
+                insn->args[a] = r;
+            }
+        }
+    }
+    for (int a = 0; a < fn->phi_args->_size; a++) {
+        struct ir_phi_arg *arg = ir_phi_arg_ref(fn->phi_args, a);
+        while (arg->value != IR_NONE && replace[arg->value] != IR_NONE) arg->value = replace[arg->value];
+    }
+}
+
+/* sccp start */
+/**
+ * Sparse conditional constant propagation (Wegman, Zadeck). Every
+ * register starts out unknown (no definition reached yet) and can only
+ * go down to a constant and then to varying. Only blocks some executable
+ * edge leads to are evaluated, so a branch on a constant keeps the other
+ * side, and everything it would have merged into the phis, out of it.
+ */
+enum lattice {
+    LATTICE_UNKNOWN,
+    LATTICE_CONSTANT,
+    LATTICE_VARYING,
+};
+
+struct lattice_value {
+    uint8_t state;      // enum lattice
+    uint64_t value;     // of a constant
+};
+
+/** a register used at (block, index), phi arguments are used by their phi */
+struct use {
+    uint32_t block;
+    uint32_t index;
+};
+
+VECTOR_DEFINE(uint32, uint32_t)
+
+struct sccp {
+    struct ir_function *fn;
+    struct lattice_value *values;
+    bool *executable;           // block was reached
+    bool *edge;                 // block * 2 + successor was taken
+    uint32_t *use_first;        // uses of every register, as a CSR list
+    struct use *uses;
+    struct m_vector *blocks;    //: uint32_t, edges block * 2 + successor still to follow
+    struct m_vector *changed;   //: uint32_t, registers whose uses need another look
+};
+
+static void sccp_set(struct sccp *s, vreg r, struct lattice_value value) {
+    struct lattice_value *old = &s->values[r];
+    if (old->state == value.state && (value.state != LATTICE_CONSTANT || old->value == value.value)) return;
+    *old = value;
+    uint32_insert(s->changed, r);
+}
+
+static void sccp_take_edge(struct sccp *s, uint32_t block, int successor) {
+    if (s->edge[block * 2 + successor]) return;
+    s->edge[block * 2 + successor] = true;
+    uint32_insert(s->blocks, block * 2 + successor);
+}
+
+/** whether the edge from `from` into `to` was taken */
+static bool sccp_edge_taken(const struct sccp *s, uint32_t from, uint32_t to) {
+    struct m_vector *insns = ir_insns(s->fn, from);
+    const struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+    for (int t = 0; t < ir_successor_count(last); t++)
+        if (last->u.target[t] == to && s->edge[from * 2 + t]) return true;
+    return false;
+}
+
+static void sccp_visit(struct sccp *s, uint32_t block, const struct ir_insn *insn) {
+    static const struct lattice_value varying = { LATTICE_VARYING, 0 };
+
+    switch (insn->op) {
+        case IR_CONST:
+            sccp_set(s, insn->dst, (struct lattice_value) { LATTICE_CONSTANT, insn->u.imm });
+            return;
+        case IR_LOAD:
+            sccp_set(s, insn->dst, varying);
+            return;
+        case IR_STORE:
+        case IR_RET:
+            return;
+
+        case IR_PHI: {
+            // meet of what comes in over the edges taken so far
+            struct lattice_value meet = { LATTICE_UNKNOWN, 0 };
+            for (uint32_t a = 0; a < insn->u.phi.count && meet.state != LATTICE_VARYING; a++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(s->fn->phi_args, insn->u.phi.first + a);
+                if (!sccp_edge_taken(s, arg.block, block)) continue;
+                const struct lattice_value in = s->values[arg.value];
+                if (in.state == LATTICE_UNKNOWN) continue;
+                if (meet.state == LATTICE_UNKNOWN) meet = in;
+                else if (in.state == LATTICE_VARYING || in.value != meet.value) meet = varying;
+            }
+            sccp_set(s, insn->dst, meet);
+            return;
+        }
+
+        case IR_JMP:
+            sccp_take_edge(s, block, 0);
+            return;
+        case IR_BR: {
+            const struct lattice_value condition = s->values[insn->args[0]];
+            if (condition.state == LATTICE_VARYING) {
+                sccp_take_edge(s, block, 0);
+                sccp_take_edge(s, block, 1);
+            } else if (condition.state == LATTICE_CONSTANT) {
+                sccp_take_edge(s, block, condition.value != 0 ? 0 : 1);
+            }
+            return;
+        }
+
+        default: {
+            const int args = ir_arg_count(insn->op);
+            const struct lattice_value a = s->values[insn->args[0]];
+            const struct lattice_value b = args == 2 ? s->values[insn->args[1]] : a;
+            if (a.state == LATTICE_UNKNOWN || b.state == LATTICE_UNKNOWN) return;
+
+            uint64_t result;
+            if (a.state == LATTICE_CONSTANT && b.state == LATTICE_CONSTANT && ir_evaluate(insn->op, a.value, b.value, &result))
+                sccp_set(s, insn->dst, (struct lattice_value) { LATTICE_CONSTANT, result });
+            else
+                sccp_set(s, insn->dst, varying);
+            return;
+        }
+    }
+}
+
+/** control reaches a block, a new edge into one seen before only matters to its phis */
+static void sccp_reach(struct sccp *s, uint32_t block) {
+    struct m_vector *insns = ir_insns(s->fn, block);
+    const bool first = !s->executable[block];
+    s->executable[block] = true;
+    for (int i = 0; i < insns->_size; i++) {
+        const struct ir_insn *insn = ir_insn_ref(insns, i);
+        if (!first && insn->op != IR_PHI) break;
+        sccp_visit(s, block, insn);
+    }
+}
+
+static void sccp_build_uses(struct sccp *s) {
+    const struct ir_function *fn = s->fn;
+    s->use_first = (uint32_t*) calloc(fn->vreg_count + 1, sizeof(uint32_t));
+
+    // two rounds: count, then fill
+    for (int round = 0; round < 2; round++) {
+        for (int b = 0; b < fn->blocks->_size; b++) {
+            struct m_vector *insns = ir_insns(fn, b);
+            for (int i = 0; i < insns->_size; i++) {
+                const struct ir_insn *insn = ir_insn_ref(insns, i);
+                const int args = insn->op == IR_PHI ? (int) insn->u.phi.count : ir_arg_count(insn->op);
+                for (int a = 0; a < args; a++) {
+                    const vreg r = insn->op == IR_PHI
+                        ? ir_phi_arg_at(fn->phi_args, insn->u.phi.first + a).value
+                        : insn->args[a];
+                    if (r == IR_NONE) continue;
+                    if (round == 0) s->use_first[r + 1]++;
+                    else s->uses[s->use_first[r]++] = (struct use) { b, i };
+                }
+            }
+        }
+
+        if (round == 0) {
+            for (uint32_t r = 0; r < fn->vreg_count; r++) s->use_first[r + 1] += s->use_first[r];
+            s->uses = (struct use*) malloc((s->use_first[fn->vreg_count] + 1) * sizeof(struct use));
+        } else {
+            memmove(s->use_first + 1, s->use_first, fn->vreg_count * sizeof(uint32_t));
+            s->use_first[0] = 0;
+        }
+    }
+}
+
+/**
+ * Rewrite with what was found: registers with a constant value become
+ * constants and branches on them jumps. Blocks nothing reached are left
+ * for remove_unreachable().
+ */
+static void sccp_rewrite(struct sccp *s, struct arena *arena) {
+    struct ir_function *fn = s->fn;
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        if (!s->executable[b]) continue;
+        struct m_vector *insns = ir_insns(fn, b);
+        struct m_vector *out = vector_init_arena(arena, sizeof(struct ir_insn));
+        vector_reserve(out, insns->_size);
+
+        // phis that turned constant move behind the remaining ones
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 0; i < insns->_size; i++) {
+                struct ir_insn insn = ir_insn_at(insns, i);
+                const bool constant = insn.dst != IR_NONE && s->values[insn.dst].state == LATTICE_CONSTANT;
+                if ((insn.op == IR_PHI && !constant) != (pass == 0)) continue;
+
+                if (constant && insn.op != IR_CONST) {
+                    insn = (struct ir_insn) { .op = IR_CONST, .type = IR_I64, .dst = insn.dst };
+                    insn.u.imm = s->values[insn.dst].value;
+                } else if (insn.op == IR_BR && s->values[insn.args[0]].state == LATTICE_CONSTANT) {
+                    const uint32_t target = insn.u.target[s->values[insn.args[0]].value != 0 ? 0 : 1];
+                    insn = (struct ir_insn) { .op = IR_JMP, .type = IR_I64 };
+                    insn.u.target[0] = target;
+                }
+                ir_insn_insert(out, insn);
+            }
+        }
+        ir_block_ref(fn->blocks, b)->insns = out;
+    }
+}
+
+static void sccp(struct ir_function *fn, struct arena *arena) {
+    const int blocks = fn->blocks->_size;
+    struct sccp s = {
+        .fn = fn,
+        .values = (struct lattice_value*) calloc(fn->vreg_count, sizeof(struct lattice_value)),
+        .executable = (bool*) calloc(blocks, sizeof(bool)),
+        .edge = (bool*) calloc(2 * blocks, sizeof(bool)),
+        .blocks = vector_init(sizeof(uint32_t)),
+        .changed = vector_init(sizeof(uint32_t)),
+    };
+    sccp_build_uses(&s);
+
+    // the entry is reached by the call, then follow new edges and changed
+    // registers until nothing moves
+    sccp_reach(&s, 0);
+    while (s.blocks->_size > 0 || s.changed->_size > 0) {
+        if (s.blocks->_size > 0) {
+            const uint32_t edge = uint32_at(s.blocks, --s.blocks->_size);
+            struct m_vector *insns = ir_insns(fn, edge / 2);
+            sccp_reach(&s, ir_insn_ref(insns, insns->_size - 1)->u.target[edge % 2]);
+            continue;
+        }
+
+        const vreg r = uint32_at(s.changed, --s.changed->_size);
+        for (uint32_t u = s.use_first[r]; u < s.use_first[r + 1]; u++) {
+            const struct use use = s.uses[u];
+            if (s.executable[use.block])
+                sccp_visit(&s, use.block, ir_insn_ref(ir_insns(fn, use.block), use.index));
+        }
+    }
+
+    sccp_rewrite(&s, arena);
+
+    vector_free(s.blocks);
+    vector_free(s.changed);
+    free(s.use_first);
+    free(s.uses);
+    free(s.values);
+    free(s.executable);
+    free(s.edge);
+}
+/* sccp end */
+
+/* cfg start */
+/**
+ * Keep the blocks with `keep` set, in their order, and renumber the
+ * branch targets and phi arguments. Phi arguments from dropped blocks go
+ * away with them.
+ */
+static void keep_blocks(struct ir_function *fn, struct arena *arena, const bool *keep) {
+    const int blocks = fn->blocks->_size;
+    uint32_t *number = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    struct m_vector *kept = vector_init_arena(arena, sizeof(struct ir_block));
+    for (int b = 0; b < blocks; b++) {
+        number[b] = keep[b] ? (uint32_t) kept->_size : IR_NO_BLOCK;
+        if (keep[b]) ir_block_insert(kept, ir_block_at(fn->blocks, b));
+    }
+    if (kept->_size == blocks) {
+        free(number);
+        return;
+    }
+
+    for (int b = 0; b < kept->_size; b++) {
+        struct m_vector *insns = ir_block_ref(kept, b)->insns;
+        for (int i = 0; i < insns->_size; i++) {
+            struct ir_insn *insn = ir_insn_ref(insns, i);
+            for (int t = 0; t < ir_successor_count(insn); t++) insn->u.target[t] = number[insn->u.target[t]];
+            if (insn->op != IR_PHI) continue;
+
+            uint32_t count = 0;
+            for (uint32_t a = 0; a < insn->u.phi.count; a++) {
+                struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, insn->u.phi.first + a);
+                if (number[arg.block] == IR_NO_BLOCK) continue;
+                arg.block = number[arg.block];
+                *ir_phi_arg_ref(fn->phi_args, insn->u.phi.first + count++) = arg;
+            }
+            insn->u.phi.count = count;
+        }
+    }
+    fn->blocks = kept;
+    free(number);
+}
+
+/** drop the blocks the entry can't reach: code after a return, branches never taken */
+static void remove_unreachable(struct ir_function *fn, struct arena *arena) {
+    const int blocks = fn->blocks->_size;
+    bool *reached = (bool*) calloc(blocks, sizeof(bool));
+    uint32_t *work = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    uint32_t size = 0;
+
+    reached[0] = true;
+    work[size++] = 0;
+    while (size > 0) {
+        struct m_vector *insns = ir_insns(fn, work[--size]);
+        const struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+        for (int t = 0; t < ir_successor_count(last); t++) {
+            if (reached[last->u.target[t]]) continue;
+            reached[last->u.target[t]] = true;
+            work[size++] = last->u.target[t];
+        }
+    }
+
+    keep_blocks(fn, arena, reached);
+    free(reached);
+    free(work);
+}
+
+/**
+ * Branch past blocks that only jump on, like the empty side of an && the
+ * builder leaves behind: `br x, r, s` with `s: jmp t` becomes `br x, r, t`
+ * and s goes unreachable. Only when t has no phis, which would need an
+ * argument from s (and a br can't target it). Branches go forward, so the
+ * chains of such blocks are resolved back to front in one pass.
+ */
+static void skip_jumps(struct ir_function *fn) {
+    const int blocks = fn->blocks->_size;
+    uint32_t *target = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+
+    for (int b = blocks - 1; b >= 0; b--) {
+        struct m_vector *insns = ir_insns(fn, b);
+        const struct ir_insn *jump = ir_insn_ref(insns, 0);
+        target[b] = b;
+        if (b == 0 || insns->_size != 1 || jump->op != IR_JMP) continue;
+        if (ir_insn_ref(ir_insns(fn, jump->u.target[0]), 0)->op == IR_PHI) continue;
+        target[b] = target[jump->u.target[0]];
+    }
+
+    for (int b = 0; b < blocks; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+        for (int t = 0; t < ir_successor_count(last); t++) last->u.target[t] = target[last->u.target[t]];
+
+        // both ways lead to the same place, the condition is dead
+        if (last->op == IR_BR && last->u.target[0] == last->u.target[1])
+            *last = (struct ir_insn) { .op = IR_JMP, .u.target = { last->u.target[0] } };
+    }
+
+    free(target);
+}
+
+/**
+ * The same for a block of nothing but phis, the join of a ternary nested
+ * in another one:
+ *
+ *     b: %5 = phi [p: %3], [q: %4]; jmp t
+ *     t: %10 = phi [b: %5], [r: %9]
+ *
+ * p and q jump to t instead and t takes their values directly,
+ * `%10 = phi [p: %3], [q: %4], [r: %9]`. Only when the phis of b are used
+ * by t alone. Back to front, so nested joins fold into the outermost one.
+ */
+static void skip_joins(struct ir_function *fn) {
+    struct ir_cfg cfg = ir_cfg_build(fn);
+    struct definition *defs = definitions(fn);
+    uint32_t *uses = use_counts(fn);
+
+    for (int b = fn->blocks->_size - 1; b > 0; b--) {
+        struct m_vector *insns = ir_insns(fn, b);
+        const struct ir_insn jump = ir_insn_at(insns, insns->_size - 1);
+        if (jump.op != IR_JMP || ir_insn_ref(insns, 0)->op != IR_PHI) continue;
+        const uint32_t t = jump.u.target[0];
+        struct m_vector *join = ir_insns(fn, t);
+
+        // every phi of b is used once, by a phi of t
+        int phis = 0, forwarded = 0;
+        for (int i = 0; i < insns->_size - 1; i++) {
+            const struct ir_insn *phi = ir_insn_ref(insns, i);
+            if (phi->op != IR_PHI || uses[phi->dst] != 1) break;
+            phis++;
+        }
+        for (int i = 0; i < join->_size && ir_insn_ref(join, i)->op == IR_PHI; i++) {
+            const struct ir_insn *phi = ir_insn_ref(join, i);
+            for (uint32_t a = 0; a < phi->u.phi.count; a++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, phi->u.phi.first + a);
+                if (arg.block == (uint32_t) b && defs[arg.value].block == (uint32_t) b) forwarded++;
+            }
+        }
+        if (phis != insns->_size - 1 || forwarded != phis) continue;
+
+        for (int i = 0; i < join->_size && ir_insn_ref(join, i)->op == IR_PHI; i++) {
+            struct ir_insn *phi = ir_insn_ref(join, i);
+            const uint32_t first = fn->phi_args->_size;
+
+            for (uint32_t a = 0; a < phi->u.phi.count; a++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, phi->u.phi.first + a);
+                if (arg.block != (uint32_t) b) {
+                    ir_phi_arg_insert(fn->phi_args, arg);
+                    continue;
+                }
+
+                // the value b got from each predecessor, or what it passed on from above them
+                const struct ir_insn *inner = defs[arg.value].block == (uint32_t) b
+                    ? ir_insn_ref(insns, defs[arg.value].index) : NULL;
+                for (uint32_t p = cfg.first[b]; p < cfg.first[b + 1]; p++) {
+                    vreg value = arg.value;
+                    for (uint32_t k = 0; inner != NULL && k < inner->u.phi.count; k++) {
+                        const struct ir_phi_arg from = ir_phi_arg_at(fn->phi_args, inner->u.phi.first + k);
+                        if (from.block == cfg.preds[p]) value = from.value;
+                    }
+                    if (inner == NULL) uses[value]++;
+                    ir_phi_arg_insert(fn->phi_args, (struct ir_phi_arg) { cfg.preds[p], value });
+                }
+            }
+
+            phi->u.phi.first = first;
+            phi->u.phi.count = fn->phi_args->_size - first;
+        }
+
+        // a block with phis is only jumped to
+        for (uint32_t p = cfg.first[b]; p < cfg.first[b + 1]; p++) {
+            struct m_vector *from = ir_insns(fn, cfg.preds[p]);
+            ir_insn_ref(from, from->_size - 1)->u.target[0] = t;
+        }
+    }
+
+    ir_cfg_free(&cfg);
+    free(defs);
+    free(uses);
+}
+
+/**
+ * Append a block to its only predecessor when that ends in a jump to it,
+ * the jump goes away. Runs after propagate_copies(), so such a block has
+ * no phis left.
+ */
+static void merge_blocks(struct ir_function *fn, struct arena *arena) {
+    const int blocks = fn->blocks->_size;
+    struct ir_cfg cfg = ir_cfg_build(fn);
+    bool *keep = (bool*) malloc(blocks * sizeof(bool));
+    memset(keep, true, blocks * sizeof(bool));
+
+    for (int b = 0; b < blocks; b++) {
+        if (!keep[b]) continue;
+        struct m_vector *insns = ir_insns(fn, b);
+        struct m_vector *merged = NULL;
+
+        while (true) {
+            const struct ir_insn last = ir_insn_at(insns, insns->_size - 1);
+            if (last.op != IR_JMP) break;
+            const uint32_t next = last.u.target[0];
+            if (next == 0 || next == (uint32_t) b || cfg.first[next + 1] - cfg.first[next] != 1) break;
+            struct m_vector *tail = ir_insns(fn, next);
+            if (ir_insn_ref(tail, 0)->op == IR_PHI) break;
+
+            if (merged == NULL) {
+                merged = vector_init_arena(arena, sizeof(struct ir_insn));
+                vector_reserve(merged, insns->_size + tail->_size);
+                for (int i = 0; i < insns->_size - 1; i++) ir_insn_insert(merged, ir_insn_at(insns, i));
+            } else {
+                merged->_size--;    // the jump
+            }
+            for (int i = 0; i < tail->_size; i++) ir_insn_insert(merged, ir_insn_at(tail, i));
+            insns = merged;
+            keep[next] = false;
+
+            // the successors of `next` now come from b
+            const struct ir_insn *end = ir_insn_ref(tail, tail->_size - 1);
+            for (int t = 0; t < ir_successor_count(end); t++) {
+                struct m_vector *succ = ir_insns(fn, end->u.target[t]);
+                for (int i = 0; i < succ->_size && ir_insn_ref(succ, i)->op == IR_PHI; i++) {
+                    const struct ir_insn *phi = ir_insn_ref(succ, i);
+                    for (uint32_t a = 0; a < phi->u.phi.count; a++) {
+                        struct ir_phi_arg *arg = ir_phi_arg_ref(fn->phi_args, phi->u.phi.first + a);
+                        if (arg->block == next) arg->block = b;
+                    }
+                }
+            }
+        }
+        if (merged != NULL) ir_block_ref(fn->blocks, b)->insns = merged;
+    }
+
+    keep_blocks(fn, arena, keep);
+    free(keep);
+    ir_cfg_free(&cfg);
+}
+/* cfg end */
+
+/**
+ * Copy propagation. The IR has no copy instruction, but three things act
+ * like one: a phi whose arguments are all the same register (left behind
+ * when remove_unreachable() takes away its other predecessors), a zext32
+ * of a value whose upper half is clear already and `ne x, 0` of an x
+ * that is 0 or 1 (what && and || make of their right side). Their uses
+ * take the original register instead.
+ */
+static void propagate_copies(struct ir_function *fn) {
+    vreg *replace = (vreg*) calloc(fn->vreg_count, sizeof(vreg));
+    struct definition *defs = definitions(fn);
+    bool *boolean = booleans(fn);
+    bool removed = false;
+
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            vreg copied = IR_NONE;
+
+            if (insn->op == IR_PHI) {
+                // arguments may be copies found before: resolve them when comparing
+                bool same = true;
+                for (uint32_t a = 0; a < insn->u.phi.count && same; a++) {
+                    vreg value = ir_phi_arg_at(fn->phi_args, insn->u.phi.first + a).value;
+                    while (replace[value] != IR_NONE) value = replace[value];
+                    same = copied == IR_NONE || copied == value;
+                    copied = value;
+                }
+                if (!same) copied = IR_NONE;
+            } else if (insn->op == IR_ZEXT32) {
+                const struct definition def = defs[insn->args[0]];
+                if (ir_zero_extends(ir_insn_ref(ir_insns(fn, def.block), def.index))) copied = insn->args[0];
+            } else if (insn->op == IR_NE) {
+                if (boolean[insn->args[0]] && is_constant(fn, defs, insn->args[1], 0)) copied = insn->args[0];
+            }
+
+            if (copied != IR_NONE && copied != insn->dst) {
+                replace[insn->dst] = copied;
+                removed = true;
+            }
+        }
+    }
+
+    if (removed) {
+        apply_replacements(fn, replace);
+        for (int b = 0; b < fn->blocks->_size; b++) {
+            struct m_vector *insns = ir_insns(fn, b);
+            int kept = 0;
+            for (int i = 0; i < insns->_size; i++) {
+                const struct ir_insn insn = ir_insn_at(insns, i);
+                if (insn.dst == IR_NONE || replace[insn.dst] == IR_NONE) *ir_insn_ref(insns, kept++) = insn;
+            }
+            insns->_size = kept;
+        }
+    }
+    free(replace);
+    free(defs);
+    free(boolean);
+}
+
+/**
+ * Dead code elimination: what stores, branches and returns use is live,
+ * and so is whatever that is computed from. Everything else goes, none
+ * of it has side effects (division by zero doesn't trap on AArch64).
+ */
+static void eliminate_dead_code(struct ir_function *fn) {
+    bool *live = (bool*) calloc(fn->vreg_count, sizeof(bool));
+    struct definition *defs = definitions(fn);
+    struct m_vector *work = vector_init(sizeof(uint32_t));
+
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            if (insn->dst != IR_NONE) continue;
+            for (int a = 0; a < ir_arg_count(insn->op); a++) {
+                const vreg r = insn->args[a];
+                if (r == IR_NONE || live[r]) continue;
+                live[r] = true;
+                uint32_insert(work, r);
+            }
+        }
+    }
+
+    while (work->_size > 0) {
+        const struct definition def = defs[uint32_at(work, --work->_size)];
+        const struct ir_insn *insn = ir_insn_ref(ir_insns(fn, def.block), def.index);
+        const int args = insn->op == IR_PHI ? (int) insn->u.phi.count : ir_arg_count(insn->op);
+        for (int a = 0; a < args; a++) {
+            const vreg r = insn->op == IR_PHI
+                ? ir_phi_arg_at(fn->phi_args, insn->u.phi.first + a).value
+                : insn->args[a];
+            if (r == IR_NONE || live[r]) continue;
+            live[r] = true;
+            uint32_insert(work, r);
+        }
+    }
+
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        int kept = 0;
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn insn = ir_insn_at(insns, i);
+            if (insn.dst == IR_NONE || live[insn.dst]) *ir_insn_ref(insns, kept++) = insn;
+        }
+        insns->_size = kept;
+    }
+
+    vector_free(work);
+    free(defs);
+    free(live);
+}
+
+/* conditions start */
+/** instructions a right side of && or || may have to be computed unconditionally */
+#define IF_CONVERT_LIMIT 6
+
+/** whether computing it when it isn't needed is harmless and cheap */
+static bool is_speculable(enum ir_op op) {
+    switch (op) {
+        case IR_CONST: case IR_LOAD:
+        case IR_NEG: case IR_NOT: case IR_ZEXT32:
+        case IR_ADD: case IR_SUB: case IR_AND: case IR_OR: case IR_XOR:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** the block b jumps to, if it has one predecessor and nothing but `allowed` before the jump */
+static uint32_t straight_into(const struct ir_function *fn, const struct ir_cfg *cfg, uint32_t b,
+        bool (*allowed)(enum ir_op), int limit)
+{
+    if (cfg->first[b + 1] - cfg->first[b] != 1) return IR_NO_BLOCK;
+    struct m_vector *insns = ir_insns(fn, b);
+    if (insns->_size - 1 > limit) return IR_NO_BLOCK;
+    for (int i = 0; i < insns->_size - 1; i++)
+        if (!allowed(ir_insn_ref(insns, i)->op)) return IR_NO_BLOCK;
+
+    const struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+    return last->op == IR_JMP ? last->u.target[0] : IR_NO_BLOCK;
+}
+
+static bool is_constant_op(enum ir_op op) {
+    return op == IR_CONST;
+}
+
+/**
+ * If-conversion of && and ||. The builder leaves
+ *
+ *     c: br x, r, s           (br x, s, r for ||)
+ *     r: ... v = 0 or 1; jmp j
+ *     s: k = 0 (1 for ||); jmp j
+ *     j: phi [r: v], [s: k]
+ *
+ * When r is short and has no side effects it runs unconditionally in c,
+ * the phi gets `and x, v` (or) from there: no branch, and the backend
+ * makes cmp + ccmp of two compares. r and s become unreachable.
+ */
+static void if_convert(struct ir_function *fn) {
+    struct ir_cfg cfg = ir_cfg_build(fn);
+    struct definition *defs = definitions(fn);
+    bool *boolean = booleans(fn);
+
+    for (int c = 0; c < fn->blocks->_size; c++) {
+        struct m_vector *insns = ir_insns(fn, c);
+        const struct ir_insn branch = ir_insn_at(insns, insns->_size - 1);
+        if (branch.op != IR_BR) continue;
+
+        // which target is the right side: taken for && (k = 0), not taken for ||
+        for (int t = 0; t < 2; t++) {
+            const uint32_t r = branch.u.target[t], s = branch.u.target[1 - t];
+            const uint32_t j = straight_into(fn, &cfg, r, is_speculable, IF_CONVERT_LIMIT);
+            if (j == IR_NO_BLOCK || straight_into(fn, &cfg, s, is_constant_op, IF_CONVERT_LIMIT) != j) continue;
+
+            struct m_vector *join = ir_insns(fn, j);
+            struct ir_insn *phi = ir_insn_ref(join, 0);
+            if (phi->op != IR_PHI || phi->u.phi.count != 2 || ir_insn_ref(join, 1)->op == IR_PHI) continue;
+
+            vreg v = IR_NONE, k = IR_NONE;
+            for (uint32_t a = 0; a < 2; a++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, phi->u.phi.first + a);
+                if (arg.block == r) v = arg.value;
+                if (arg.block == s) k = arg.value;
+            }
+            if (v == IR_NONE || k == IR_NONE || !boolean[v] || !is_constant(fn, defs, k, t)) continue;
+
+            // c: ..., [x != 0], r without its jump, x and/or v, jmp j
+            insns->_size--;
+            vreg x = branch.args[0];
+            if (!boolean[x]) {
+                const vreg zero = fn->vreg_count++;
+                ir_insn_insert(insns, (struct ir_insn) { .op = IR_CONST, .type = IR_I64, .dst = zero });
+                ir_insn_insert(insns, (struct ir_insn) {
+                    .op = IR_NE, .type = IR_I64, .dst = fn->vreg_count++, .args = { x, zero },
+                });
+                x = fn->vreg_count - 1;
+            }
+            struct m_vector *right = ir_insns(fn, r);
+            for (int i = 0; i < right->_size - 1; i++) ir_insn_insert(insns, ir_insn_at(right, i));
+            const vreg result = fn->vreg_count++;
+            ir_insn_insert(insns, (struct ir_insn) {
+                .op = t == 0 ? IR_AND : IR_OR, .type = IR_I64, .dst = result, .args = { x, v },
+            });
+            ir_insn_insert(insns, (struct ir_insn) { .op = IR_JMP, .u.target = { j } });
+
+            // left with one argument, propagate_copies() takes the phi away
+            phi->u.phi.first = fn->phi_args->_size;
+            phi->u.phi.count = 1;
+            ir_phi_arg_insert(fn->phi_args, (struct ir_phi_arg) { c, result });
+            break;
+        }
+    }
+
+    ir_cfg_free(&cfg);
+    free(defs);
+    free(boolean);
+}
+
+/**
+ * Jump threading for conditions: a block that only branches on its phi,
+ * which nothing else uses, is skipped. Every predecessor branches on its
+ * own value instead, a constant one jumps, and the block is left
+ * unreachable. That is what an && or || the ternary uses as its
+ * condition looks like when if_convert() kept its branches.
+ */
+static void thread_branches(struct ir_function *fn) {
+    struct definition *defs = definitions(fn);
+    uint32_t *uses = use_counts(fn);
+
+    for (int j = 0; j < fn->blocks->_size; j++) {
+        struct m_vector *insns = ir_insns(fn, j);
+        if (insns->_size != 2) continue;
+        const struct ir_insn phi = ir_insn_at(insns, 0), branch = ir_insn_at(insns, 1);
+        if (phi.op != IR_PHI || branch.op != IR_BR || branch.args[0] != phi.dst || uses[phi.dst] != 1) continue;
+
+        // the targets of a branch have no phis, any predecessor may go there
+        for (uint32_t a = 0; a < phi.u.phi.count; a++) {
+            const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, phi.u.phi.first + a);
+            struct m_vector *from = ir_insns(fn, arg.block);
+            struct ir_insn *jump = ir_insn_ref(from, from->_size - 1);
+            const struct ir_insn *def = ir_insn_ref(ir_insns(fn, defs[arg.value].block), defs[arg.value].index);
+
+            if (def->op == IR_CONST) {
+                jump->u.target[0] = branch.u.target[def->u.imm != 0 ? 0 : 1];
+            } else {
+                *jump = branch;
+                jump->args[0] = arg.value;
+            }
+        }
+    }
+
+    free(defs);
+    free(uses);
+}
+/* conditions end */
+
+/**
+ * Unreachable blocks go first, mem2reg only walks what the entry reaches.
+ * SCCP turns branches on constants into jumps, which leaves blocks
+ * unreachable again and phis with a single argument, i.e. copies. The
+ * conditions are reshaped on the cleaned up code (ne of a compare is gone
+ * by then) and leave copies and unreachable blocks of their own. Once dead
+ * code is gone some blocks only jump (or hold phis and jump) and are
+ * branched past. Merging straight-line blocks comes last, once those phis
+ * are gone.
+ */
+void ir_optimize(struct ir_module *m, struct arena *arena) {
+    for (int i = 0; i < m->functions->_size; i++) {
+        struct ir_function *fn = ir_function_ref(m->functions, i);
+        remove_unreachable(fn, arena);
+        ir_mem2reg(fn, arena);
+        sccp(fn, arena);
+        remove_unreachable(fn, arena);
+        propagate_copies(fn);
+        eliminate_dead_code(fn);
+        if_convert(fn);
+        thread_branches(fn);
+        remove_unreachable(fn, arena);
+        propagate_copies(fn);
+        eliminate_dead_code(fn);
+        skip_joins(fn);
+        skip_jumps(fn);
+        remove_unreachable(fn, arena);
+        merge_blocks(fn, arena);
+    }
+}
@@ -0,0 +1,541 @@
+#include "ir.h"
+
+/**
+ * SSA construction. The builder keeps every local in memory and reaches
+ * it through loads and stores; ir_mem2reg() replaces those by the values
+ * themselves. Where different stores meet at a join a phi picks the
+ * right one: phis go on the iterated dominance frontier of the blocks
+ * that store a local, then a walk of the dominator tree gives every load
+ * the value of the closest store above it (Cytron et al.).
+ *
+ * There is no address-of operator, so no local can be reached any other
+ * way and all of them are promoted.
+ */
+
+/* dominators start */
+/** the children of every block in the dominator tree, laid out like struct ir_cfg */
+struct dominator_tree {
+    uint32_t *first;
+    uint32_t *children;
+};
+
+struct dfs_frame {
+    uint32_t block;
+    uint32_t next;      // successor or child to visit next
+};
+
+/** reachable blocks in reverse postorder, the entry first. Returns how many there are */
+static uint32_t reverse_postorder(const struct ir_function *fn, uint32_t *order) {
+    const int blocks = fn->blocks->_size;
+    bool *seen = (bool*) calloc(blocks, sizeof(bool));
+    struct dfs_frame *stack = (struct dfs_frame*) malloc(blocks * sizeof(struct dfs_frame));
+    uint32_t depth = 0, done = 0;
+
+    stack[depth++] = (struct dfs_frame) { 0, 0 };
+    seen[0] = true;
+    while (depth > 0) {
+        struct dfs_frame *top = &stack[depth - 1];
+        struct m_vector *insns = ir_insns(fn, top->block);
+        const struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+
+        if (top->next < (uint32_t) ir_successor_count(last)) {
+            const uint32_t next = last->u.target[top->next++];
+            if (!seen[next]) {
+                seen[next] = true;
+                stack[depth++] = (struct dfs_frame) { next, 0 };
+            }
+            continue;
+        }
+        order[done++] = top->block;     // postorder for now
+        depth--;
+    }
+
+    for (uint32_t i = 0; i < done / 2; i++) {
+        const uint32_t tmp = order[i];
+        order[i] = order[done - 1 - i];
+        order[done - 1 - i] = tmp;
+    }
+    free(seen);
+    free(stack);
+    return done;
+}
+
+static struct dominator_tree dominator_tree_build(const uint32_t *idom, int blocks) {
+    struct dominator_tree tree = {
+        (uint32_t*) calloc(blocks + 1, sizeof(uint32_t)),
+        (uint32_t*) malloc(blocks * sizeof(uint32_t)),
+    };
+    for (int b = 1; b < blocks; b++)
+        if (idom[b] != IR_NO_BLOCK) tree.first[idom[b] + 1]++;
+    for (int b = 0; b < blocks; b++) tree.first[b + 1] += tree.first[b];
+
+    uint32_t *fill = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    memcpy(fill, tree.first, blocks * sizeof(uint32_t));
+    for (int b = 1; b < blocks; b++)
+        if (idom[b] != IR_NO_BLOCK) tree.children[fill[idom[b]]++] = b;
+    free(fill);
+    return tree;
+}
+
+static void dominator_tree_free(struct dominator_tree *tree) {
+    free(tree->first);
+    free(tree->children);
+}
+
+/** closest common dominator of a and b, walking up by reverse postorder number */
+static uint32_t intersect(const uint32_t *idom, const uint32_t *rpo, uint32_t a, uint32_t b) {
+    while (a != b) {
+        while (rpo[a] > rpo[b]) a = idom[a];
+        while (rpo[b] > rpo[a]) b = idom[b];
+    }
+    return a;
+}
+
+/**
+ * "A Simple, Fast Dominance Algorithm" (Cooper, Harvey, Kennedy): iterate
+ * over the blocks in reverse postorder until nothing changes. Without back
+ * edges a single round already settles everything.
+ */
+struct ir_dominators ir_dominators_build(const struct ir_function *fn, const struct ir_cfg *cfg) {
+    const int blocks = fn->blocks->_size;
+    uint32_t *order = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    const uint32_t reachable = reverse_postorder(fn, order);
+
+    uint32_t *rpo = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    struct ir_dominators d = {
+        .idom = (uint32_t*) malloc(blocks * sizeof(uint32_t)),
+        ._enter = (uint32_t*) malloc(blocks * sizeof(uint32_t)),
+        ._leave = (uint32_t*) calloc(blocks, sizeof(uint32_t)),
+    };
+    for (int b = 0; b < blocks; b++) {
+        d.idom[b] = IR_NO_BLOCK;
+        d._enter[b] = UINT32_MAX;   // unreachable blocks dominate nothing
+    }
+    for (uint32_t i = 0; i < reachable; i++) rpo[order[i]] = i;
+    d.idom[0] = 0;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t i = 1; i < reachable; i++) {
+            const uint32_t b = order[i];
+            uint32_t idom = IR_NO_BLOCK;
+            for (uint32_t p = cfg->first[b]; p < cfg->first[b + 1]; p++) {
+                const uint32_t pred = cfg->preds[p];
+                if (d.idom[pred] == IR_NO_BLOCK) continue;     // not processed yet, or unreachable
+                idom = idom == IR_NO_BLOCK ? pred : intersect(d.idom, rpo, pred, idom);
+            }
+            if (d.idom[b] != idom) {
+                d.idom[b] = idom;
+                changed = true;
+            }
+        }
+    }
+
+    // number the tree in preorder, a block dominates the numbers between
+    // its own and the last one of its subtree
+    struct dominator_tree tree = dominator_tree_build(d.idom, blocks);
+    struct dfs_frame *stack = (struct dfs_frame*) malloc(blocks * sizeof(struct dfs_frame));
+    uint32_t depth = 0, counter = 0;
+    stack[depth++] = (struct dfs_frame) { 0, tree.first[0] };
+    d._enter[0] = counter++;
+    while (depth > 0) {
+        struct dfs_frame *top = &stack[depth - 1];
+        if (top->next < tree.first[top->block + 1]) {
+            const uint32_t child = tree.children[top->next++];
+            d._enter[child] = counter++;
+            stack[depth++] = (struct dfs_frame) { child, tree.first[child] };
+            continue;
+        }
+        d._leave[top->block] = counter - 1;
+        depth--;
+    }
+
+    free(stack);
+    dominator_tree_free(&tree);
+    free(order);
+    free(rpo);
+    return d;
+}
+
+void ir_dominators_free(struct ir_dominators *d) {
+    free(d->idom);
+    free(d->_enter);
+    free(d->_leave);
+}
+/* dominators end */
+
+/* mem2reg start */
+/** a phi placed for a local, they are grouped by block */
+struct new_phi {
+    uint32_t block;
+    uint32_t local;
+    vreg dst;
+    uint32_t first;     // its arguments in ir_function.phi_args
+};
+
+VECTOR_DEFINE(new_phi, struct new_phi)
+
+/** the value a local had before a block of the walk changed it */
+struct rename_undo {
+    uint32_t local;
+    vreg value;
+};
+
+VECTOR_DEFINE(rename_undo, struct rename_undo)
+
+struct mem2reg {
+    struct ir_function *fn;
+    struct arena *arena;
+
+    vreg *current;          // local -> its value at this point of the walk
+    vreg *replace;          // load -> the value it is replaced by
+    bool *zero_extended;    // vreg -> upper 32 bits are known to be clear
+    struct m_vector *undo;  //: struct rename_undo
+    vreg undefined;         // const 0 read by loads no store reaches, if any
+};
+
+/**
+ * CSR lists of the dominance frontier of every block: the blocks where
+ * its dominance ends, which is where its stores meet those of others.
+ */
+static struct ir_cfg dominance_frontiers(const struct ir_function *fn, const struct ir_cfg *cfg,
+        const uint32_t *idom)
+{
+    const int blocks = fn->blocks->_size;
+    struct ir_cfg df = { (uint32_t*) calloc(blocks + 1, sizeof(uint32_t)), NULL };
+    uint32_t *last = (uint32_t*) malloc(blocks * sizeof(uint32_t));     // to add a join only once
+
+    // two rounds: count, then fill
+    for (int round = 0; round < 2; round++) {
+        memset(last, 0xFF, blocks * sizeof(uint32_t));
+        for (int b = 0; b < blocks; b++) {
+            if (cfg->first[b + 1] - cfg->first[b] < 2 || idom[b] == IR_NO_BLOCK) continue;
+            for (uint32_t p = cfg->first[b]; p < cfg->first[b + 1]; p++) {
+                for (uint32_t runner = cfg->preds[p]; idom[runner] != IR_NO_BLOCK && runner != idom[b];
+                        runner = idom[runner]) {
+                    if (last[runner] == (uint32_t) b) continue;
+                    last[runner] = b;
+                    if (round == 0) df.first[runner + 1]++;
+                    else df.preds[df.first[runner]++] = b;
+                }
+            }
+        }
+
+        if (round == 0) {
+            for (int b = 0; b < blocks; b++) df.first[b + 1] += df.first[b];
+            df.preds = (uint32_t*) malloc((df.first[blocks] + 1) * sizeof(uint32_t));
+        } else {
+            // filling moved every start to the next one
+            memmove(df.first + 1, df.first, blocks * sizeof(uint32_t));
+            df.first[0] = 0;
+        }
+    }
+
+    free(last);
+    return df;
+}
+
+/**
+ * Place the phis: a block storing to a local needs one at each block of
+ * its dominance frontier, and those phis are stores of their own. Phis
+ * nobody reads are left to dead code elimination. Returns them grouped
+ * by block, `first` is indexed by block.
+ */
+static struct m_vector *place_phis(struct ir_function *fn, struct arena *arena, const struct ir_cfg *cfg,
+        const struct ir_dominators *dom, uint32_t **first)
+{
+    const int blocks = fn->blocks->_size, locals = fn->locals->_size;
+    struct ir_cfg df = dominance_frontiers(fn, cfg, dom->idom);
+
+    // blocks storing each local, as a CSR list
+    uint32_t *stored_first = (uint32_t*) calloc(locals + 1, sizeof(uint32_t));
+    uint32_t *stored = NULL;
+    uint32_t *stamp = (uint32_t*) malloc((blocks > locals ? blocks : locals) * sizeof(uint32_t));
+    for (int round = 0; round < 2; round++) {
+        memset(stamp, 0xFF, locals * sizeof(uint32_t));
+        for (int b = 0; b < blocks; b++) {
+            if (dom->idom[b] == IR_NO_BLOCK) continue;
+            struct m_vector *insns = ir_insns(fn, b);
+            for (int i = 0; i < insns->_size; i++) {
+                const struct ir_insn *insn = ir_insn_ref(insns, i);
+                if (insn->op != IR_STORE || insn->u.var.global) continue;
+                const uint32_t local = insn->u.var.index;
+                if (stamp[local] == (uint32_t) b) continue;
+                stamp[local] = b;
+                if (round == 0) stored_first[local + 1]++;
+                else stored[stored_first[local]++] = b;
+            }
+        }
+
+        if (round == 0) {
+            for (int l = 0; l < locals; l++) stored_first[l + 1] += stored_first[l];
+            stored = (uint32_t*) malloc((stored_first[locals] + 1) * sizeof(uint32_t));
+        } else {
+            memmove(stored_first + 1, stored_first, locals * sizeof(uint32_t));
+            stored_first[0] = 0;
+        }
+    }
+
+    // worklist per local, stamps tell whether a block already has its phi
+    // or has been queued
+    struct m_vector *placed = vector_init(sizeof(struct new_phi));
+    uint32_t *has_phi = stamp;
+    uint32_t *queued = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    uint32_t *work = (uint32_t*) malloc(blocks * sizeof(uint32_t));
+    memset(has_phi, 0xFF, blocks * sizeof(uint32_t));
+    memset(queued, 0xFF, blocks * sizeof(uint32_t));
+
+    for (int l = 0; l < locals; l++) {
+        uint32_t size = 0;
+        for (uint32_t s = stored_first[l]; s < stored_first[l + 1]; s++) {
+            work[size++] = stored[s];
+            queued[stored[s]] = l;
+        }
+
+        while (size > 0) {
+            const uint32_t b = work[--size];
+            for (uint32_t f = df.first[b]; f < df.first[b + 1]; f++) {
+                const uint32_t join = df.preds[f];
+                if (has_phi[join] == (uint32_t) l) continue;
+                has_phi[join] = l;
+                new_phi_insert(placed, (struct new_phi) { join, l, fn->vreg_count++, 0 });
+                if (queued[join] != (uint32_t) l) {
+                    queued[join] = l;
+                    work[size++] = join;
+                }
+            }
+        }
+    }
+
+    // group by block, reserving one argument per predecessor
+    struct m_vector *sorted = vector_init_arena(arena, sizeof(struct new_phi));
+    vector_reserve(sorted, placed->_size);
+    *first = (uint32_t*) calloc(blocks + 1, sizeof(uint32_t));
+    for (int i = 0; i < placed->_size; i++) (*first)[new_phi_at(placed, i).block + 1]++;
+    for (int b = 0; b < blocks; b++) (*first)[b + 1] += (*first)[b];
+    sorted->_size = placed->_size;
+    memcpy(queued, *first, blocks * sizeof(uint32_t));
+    for (int i = 0; i < placed->_size; i++) {
+        struct new_phi phi = new_phi_at(placed, i);
+        phi.first = fn->phi_args->_size;
+        for (uint32_t p = cfg->first[phi.block]; p < cfg->first[phi.block + 1]; p++)
+            ir_phi_arg_insert(fn->phi_args, (struct ir_phi_arg) { cfg->preds[p], IR_NONE });
+        *new_phi_ref(sorted, queued[phi.block]++) = phi;
+    }
+
+    vector_free(placed);
+    free(work);
+    free(queued);
+    free(stamp);
+    free(stored);
+    free(stored_first);
+    ir_cfg_free(&df);
+    return sorted;
+}
+
+static vreg resolve(const vreg *replace, vreg r) {
+    while (replace[r] != IR_NONE) r = replace[r];
+    return r;
+}
+
+/** value of a local nothing was stored to on the way here, only possible in dead code */
+static vreg undefined_value(struct mem2reg *m) {
+    if (m->undefined == IR_NONE) {
+        m->undefined = m->fn->vreg_count++;
+        m->zero_extended[m->undefined] = true;
+    }
+    return m->undefined;
+}
+
+static void set_local(struct mem2reg *m, uint32_t local, vreg value) {
+    rename_undo_insert(m->undo, (struct rename_undo) { local, m->current[local] });
+    m->current[local] = value;
+}
+
+/**
+ * Rewrite one block of the walk: its phis define the locals first, then
+ * loads take the current value and stores change it. A store truncates
+ * and a load zero extends, so a value whose upper half may be set goes
+ * through zext32 on the way.
+ */
+static void rename_block(struct mem2reg *m, uint32_t b, struct m_vector *phis, const uint32_t *phi_first,
+        const struct ir_cfg *cfg)
+{
+    struct ir_function *fn = m->fn;
+    struct m_vector *insns = ir_insns(fn, b);
+    struct m_vector *out = vector_init_arena(m->arena, sizeof(struct ir_insn));
+    vector_reserve(out, insns->_size + (phi_first[b + 1] - phi_first[b]));
+
+    for (uint32_t p = phi_first[b]; p < phi_first[b + 1]; p++) {
+        const struct new_phi *phi = new_phi_ref(phis, p);
+        struct ir_insn insn = { .op = IR_PHI, .type = IR_I64, .dst = phi->dst };
+        insn.u.phi.first = phi->first;
+        insn.u.phi.count = cfg->first[b + 1] - cfg->first[b];
+        ir_insn_insert(out, insn);
+        set_local(m, phi->local, phi->dst);
+    }
+
+    for (int i = 0; i < insns->_size; i++) {
+        const struct ir_insn insn = ir_insn_at(insns, i);
+        if ((insn.op != IR_LOAD && insn.op != IR_STORE) || insn.u.var.global) {
+            ir_insn_insert(out, insn);
+            continue;
+        }
+
+        const uint32_t local = insn.u.var.index;
+        if (insn.op == IR_LOAD) {
+            const vreg value = m->current[local];
+            m->replace[insn.dst] = value != IR_NONE ? value : undefined_value(m);
+            continue;
+        }
+
+        vreg value = resolve(m->replace, insn.args[0]);
+        if (!m->zero_extended[value]) {
+            const vreg truncated = fn->vreg_count++;
+            ir_insn_insert(out, (struct ir_insn) {
+                .op = IR_ZEXT32, .type = IR_I64, .dst = truncated, .args = { value, IR_NONE },
+            });
+            m->zero_extended[truncated] = true;
+            value = truncated;
+        }
+        set_local(m, local, value);
+    }
+    ir_block_ref(fn->blocks, b)->insns = out;
+}
+
+/** hand the current values to the phis of the successors */
+static void fill_phis(struct mem2reg *m, uint32_t b, struct m_vector *phis, const uint32_t *phi_first,
+        const struct ir_cfg *cfg)
+{
+    struct m_vector *insns = ir_insns(m->fn, b);
+    const struct ir_insn *last = ir_insn_ref(insns, insns->_size - 1);
+    for (int t = 0; t < ir_successor_count(last); t++) {
+        const uint32_t target = last->u.target[t];
+        for (uint32_t p = phi_first[target]; p < phi_first[target + 1]; p++) {
+            const struct new_phi *phi = new_phi_ref(phis, p);
+            const uint32_t count = cfg->first[target + 1] - cfg->first[target];
+            for (uint32_t a = 0; a < count; a++) {
+                struct ir_phi_arg *arg = ir_phi_arg_ref(m->fn->phi_args, phi->first + a);
+                if (arg->block != b || arg->value != IR_NONE) continue;
+                const vreg value = m->current[phi->local];
+                arg->value = value != IR_NONE ? value : undefined_value(m);
+                break;
+            }
+        }
+    }
+}
+
+void ir_mem2reg(struct ir_function *fn, struct arena *arena) {
+    const int blocks = fn->blocks->_size, locals = fn->locals->_size;
+    if (locals == 0) return;
+
+    struct ir_cfg cfg = ir_cfg_build(fn);
+    struct ir_dominators dom = ir_dominators_build(fn, &cfg);
+    uint32_t *phi_first;
+    struct m_vector *phis = place_phis(fn, arena, &cfg, &dom, &phi_first);
+
+    // every store may add a zext32, one more register for undefined_value()
+    uint32_t stores = 0;
+    for (int b = 0; b < blocks; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++)
+            if (ir_insn_ref(insns, i)->op == IR_STORE) stores++;
+    }
+    const uint32_t capacity = fn->vreg_count + stores + 1;
+
+    struct mem2reg m = {
+        .fn = fn,
+        .arena = arena,
+        .current = (vreg*) calloc(locals, sizeof(vreg)),
+        .replace = (vreg*) calloc(capacity, sizeof(vreg)),
+        .zero_extended = (bool*) calloc(capacity, sizeof(bool)),
+        .undo = vector_init(sizeof(struct rename_undo)),
+    };
+    for (int b = 0; b < blocks; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            if (insn->dst != IR_NONE) m.zero_extended[insn->dst] = ir_zero_extends(insn);
+            if (insn->op != IR_PHI) continue;
+
+            // the arms of a ternary come before its join
+            bool all = true;
+            for (uint32_t a = 0; a < insn->u.phi.count; a++)
+                all = all && m.zero_extended[ir_phi_arg_at(fn->phi_args, insn->u.phi.first + a).value];
+            m.zero_extended[insn->dst] = all;
+        }
+    }
+    for (int p = 0; p < phis->_size; p++) m.zero_extended[new_phi_ref(phis, p)->dst] = true;
+
+    // walk the dominator tree, a block sees the stores of those above it
+    struct dominator_tree tree = dominator_tree_build(dom.idom, blocks);
+    struct dfs_frame *stack = (struct dfs_frame*) malloc(blocks * sizeof(struct dfs_frame));
+    uint32_t *marks = (uint32_t*) malloc(blocks * sizeof(uint32_t));     // undo size when entered
+    uint32_t depth = 0;
+
+    stack[depth] = (struct dfs_frame) { 0, tree.first[0] };
+    marks[depth++] = 0;
+    rename_block(&m, 0, phis, phi_first, &cfg);
+    fill_phis(&m, 0, phis, phi_first, &cfg);
+    while (depth > 0) {
+        struct dfs_frame *top = &stack[depth - 1];
+        if (top->next < tree.first[top->block + 1]) {
+            const uint32_t child = tree.children[top->next++];
+            stack[depth] = (struct dfs_frame) { child, tree.first[child] };
+            marks[depth++] = m.undo->_size;
+            rename_block(&m, child, phis, phi_first, &cfg);
+            fill_phis(&m, child, phis, phi_first, &cfg);
+            continue;
+        }
+
+        depth--;
+        while ((uint32_t) m.undo->_size > marks[depth]) {
+            const struct rename_undo undo = rename_undo_at(m.undo, --m.undo->_size);
+            m.current[undo.local] = undo.value;
+        }
+    }
+
+    // uses of the loads take the stored values. Blocks the entry can't
+    // reach were never walked, their loads and stores are dropped as well
+    for (int b = 0; b < blocks; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        int kept = 0;
+        for (int i = 0; i < insns->_size; i++) {
+            struct ir_insn *insn = ir_insn_ref(insns, i);
+            if ((insn->op == IR_LOAD || insn->op == IR_STORE) && !insn->u.var.global) {
+                if (insn->op == IR_LOAD) m.replace[insn->dst] = undefined_value(&m);
+                continue;
+            }
+            for (int a = 0; a < ir_arg_count(insn->op); a++)
+                if (insn->args[a] != IR_NONE) insn->args[a] = resolve(m.replace, insn->args[a]);
+            *ir_insn_ref(insns, kept++) = *insn;
+        }
+        insns->_size = kept;
+    }
+    for (int a = 0; a < fn->phi_args->_size; a++) {
+        struct ir_phi_arg *arg = ir_phi_arg_ref(fn->phi_args, a);
+        if (arg->value != IR_NONE) arg->value = resolve(m.replace, arg->value);
+    }
+    if (m.undefined != IR_NONE) {
+        struct m_vector *entry = ir_insns(fn, 0);
+        struct m_vector *out = vector_init_arena(arena, sizeof(struct ir_insn));
+        vector_reserve(out, entry->_size + 1);
+        ir_insn_insert(out, (struct ir_insn) { .op = IR_CONST, .type = IR_I64, .dst = m.undefined });
+        for (int i = 0; i < entry->_size; i++) ir_insn_insert(out, ir_insn_at(entry, i));
+        ir_block_ref(fn->blocks, 0)->insns = out;
+    }
+
+    fn->locals = vector_init_arena(arena, sizeof(struct ir_local));
+
+    free(stack);
+    free(marks);
+    dominator_tree_free(&tree);
+    ir_dominators_free(&dom);
+    vector_free(m.undo);
+    free(m.replace);
+    free(m.zero_extended);
+    free(m.current);
+    free(phi_first);
+    ir_cfg_free(&cfg);
+}
+/* mem2reg end */
@@ -0,0 +1,114 @@
+#include "intern.h"
+
+struct intern_table {
+    struct interned *entries;
+    int size;
+    int capacity;
+
+    int *buckets;       // open addressing, holds id + 1 (0 = empty)
+    unsigned int mask;  // bucket count - 1, bucket count is a power of two
+};
+
+static struct intern_table table;
+
+// FNV-1a
+static unsigned int hash_string(const char *str, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char) str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void rehash(struct intern_table *t, unsigned int bucket_count) {
+    free(t->buckets);
+    t->buckets = (int*) calloc(bucket_count, sizeof(int));
+    t->mask = bucket_count - 1;
+
+    for (int id = 0; id < t->size; id++) {
+        unsigned int i = t->entries[id].hash & t->mask;
+        while (t->buckets[i] != 0)
+            i = (i + 1) & t->mask;
+        t->buckets[i] = id + 1;
+    }
+}
+
+static int lookup(struct intern_table *t, const char *str, int length, unsigned int hash) {
+    if (t->buckets == NULL)
+        rehash(t, 1024);
+
+    unsigned int i = hash & t->mask;
+
+    for (; t->buckets[i] != 0; i = (i + 1) & t->mask) {
+        struct interned *e = &t->entries[t->buckets[i] - 1];
+        if (e->hash == hash && e->length == length && memcmp(e->value, str, length) == 0)
+            return t->buckets[i] - 1;
+    }
+
+    // not found, add a new entry
+    if (t->size == t->capacity) {
+        t->capacity = t->capacity == 0 ? 256 : t->capacity * 2;
+        t->entries = (struct interned*) realloc(t->entries,
+            t->capacity * sizeof(struct interned));
+    }
+
+    const int id = t->size++;
+    t->entries[id] = (struct interned) {
+        .value = str,
+        .length = length,
+        .hash = hash,
+    };
+
+    // keep the load factor under 1/2
+    if ((unsigned int) t->size * 2 > t->mask + 1)
+        rehash(t, (t->mask + 1) * 2);
+    else
+        t->buckets[i] = id + 1;
+
+    return id;
+}
+
+int intern(const char *str, int length) {
+    return lookup(&table, str, length, hash_string(str, length));
+}
+
+int intern_hashed(const char *str, int length, unsigned int hash) {
+    return lookup(&table, str, length, hash);
+}
+
+struct interned intern_at(int id) {
+    return table.entries[id];
+}
+
+int intern_count(void) {
+    return table.size;
+}
+
+void intern_cleanup(void) {
+    free(table.entries);
+    free(table.buckets);
+    memset(&table, 0, sizeof(table));
+}
+
+struct intern_table *intern_table_init(void) {
+    return (struct intern_table*) calloc(1, sizeof(struct intern_table));
+}
+
+int intern_local(struct intern_table *t, const char *str, int length) {
+    return lookup(t, str, length, hash_string(str, length));
+}
+
+struct interned intern_local_at(struct intern_table *t, int id) {
+    return t->entries[id];
+}
+
+int intern_local_count(struct intern_table *t) {
+    return t->size;
+}
+
+void intern_table_free(struct intern_table *t) {
+    free(t->entries);
+    free(t->buckets);
+    free(t);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../helpers.h"
+
+/**
+ * Global identifier table. Every distinct identifier seen by the lexer
+ * gets a dense integer id (0, 1, 2, ...) so later phases can compare and
+ * index symbols by id instead of by string.
+ *
+ * Interned strings are views into the source buffer, so the table must be
+ * cleaned up before the source is closed.
+ */
+struct interned {
+    const char *value;  // not null terminated
+    int length;
+    unsigned int hash;
+};
+
+/** returns the id of the string, adding it to the table if it is new */
+int intern(const char *str, int length);
+
+/** intern() with the hash already known, e.g. from a private table */
+int intern_hashed(const char *str, int length, unsigned int hash);
+
+struct interned intern_at(int id);
+int intern_count(void);
+void intern_cleanup(void);
+
+/**
+ * Private tables, for lexing on several threads at once. Ids are local to
+ * the table; intern_hashed() an entry to get its global id.
+ */
+struct intern_table;
+
+struct intern_table *intern_table_init(void);
+int intern_local(struct intern_table *t, const char *str, int length);
+struct interned intern_local_at(struct intern_table *t, int id);
+int intern_local_count(struct intern_table *t);
+void intern_table_free(struct intern_table *t);
@@ -1,557 +1,674 @@
-#include "token.h"
+#include "lexer.h"
+#include "intern.h"
+#include "scan.h"
 
-int seek_identifier(int start, const char *content, struct m_vector* tokens, int line)
+static enum token_type seek_identifier(struct lexer *lex, uint32_t *payload)
 {
     // seek to the end of the identifier/keyword
-    int end = start;
-    while (is_alnum(content[end]))
-        end++;
-
-    const int size = end - start;
-    char *token_text = str_sub(content, start, size);
-    enum token_type token_type = token_get_keyword(token_text);
+    const int start = lex->current;
+    const int end = scan.ident_end(lex->content, start);
+    lex->current = end;
 
     // check whether the text gotten is either a keyword or identifier
-    if (token_type != TOKEN_NOT_KEYWORD)
-    {
-        token_insert(tokens, (struct token) {
-            .type = token_type,
-            .value = token_text,
-            .line = line,
-            .allocated = true,
-        });
-    }
+    enum token_type token_type = token_get_keyword(lex->content + start, end - start);
+    if (token_type != TOKEN_NOT_KEYWORD) return token_type;
+
+    // ids are handed out in source order, so a speculative lexer uses a
+    // private table and the global id is assigned when it is stitched
+    if (lex->speculative)
+        *payload = intern_local(lex->symbols, lex->content + start, end - start);
     else
-    {
-        token_insert(tokens, (struct token) {
-            .type = TOKEN_IDENTIFIER,
-            .value = token_text,
-            .line = line,
-            .allocated = true
-        });
+        *payload = intern(lex->content + start, end - start);
+    return TOKEN_IDENTIFIER;
+}
+
+static int hex_value(char c) {
+    return is_digit(c) ? c - '0' : (c | 0x20) - 'a' + 10;
+}
+
+/**
+ * The type of an integer constant is the first of int, long, long long
+ * (or the unsigned counterpart) that can hold the value, starting at the
+ * suffix's rank. Decimal constants only become unsigned with a `u`.
+ */
+static enum constant_type integer_type(uint64_t value, bool decimal, bool is_unsigned, int longs)
+{
+    static const uint64_t max[] = {
+        [CONSTANT_INT] = INT32_MAX,             [CONSTANT_UNSIGNED] = UINT32_MAX,
+        [CONSTANT_LONG] = INT64_MAX,            [CONSTANT_UNSIGNED_LONG] = UINT64_MAX,
+        [CONSTANT_LONG_LONG] = INT64_MAX,       [CONSTANT_UNSIGNED_LONG_LONG] = UINT64_MAX,
+    };
+
+    for (int type = 2 * longs; type <= CONSTANT_LONG_LONG; type += 2) {
+        if (!is_unsigned && value <= max[type]) return type;
+        if ((is_unsigned || !decimal) && value <= max[type + 1]) return type + 1;
     }
 
-    return end;
+    // too big for long long, unsigned as an extension (like gcc)
+    return CONSTANT_UNSIGNED_LONG_LONG;
 }
 
-int seek_constant(int start, const char *content, struct m_vector* tokens, int line)
+/**
+ * Parse the integer constant at content[pos]: decimal, octal (leading 0),
+ * hex (0x) or binary (0b), with an optional u/l/ll suffix in either order.
+ * Returns the position after it, or -1 with *error set to the reason.
+ */
+static int seek_integer(const char *content, int pos, struct constant *constant, const char **error)
 {
-    // seek to the end of the constant
-    int end = start;
-    while (is_digit(content[end]))
-        end++;
-    
-    const int size = end - start;
-    char *token_text = str_sub(content, start, size);
-
-    // push it to the token list
-    token_insert(tokens, (struct token) {
-        .type = TOKEN_CONSTANT,
-        .value = token_text,
-        .line = line,
-        .allocated = true,
-    });
-
-    return end;
+    int base = 10;
+    if (content[pos] == '0') {
+        const char prefix = content[pos + 1] | 0x20;
+        base = prefix == 'x' ? 16 : prefix == 'b' ? 2 : 8;
+        if (base != 8) pos += 2;
+    }
+
+    const int digits = pos;
+    uint64_t value = 0;
+    bool overflow = false;
+
+    for (;; pos++) {
+        const char c = content[pos];
+        const int digit = is_digit(c) ? c - '0' : base == 16 && is_hex(c) ? hex_value(c) : -1;
+        if (digit < 0) break;
+
+        if (digit >= base) {
+            *error = "invalid digit";
+            return -1;
+        }
+
+        if (value > (UINT64_MAX - digit) / base) overflow = true;
+        value = value * base + digit;
+    }
+
+    if (pos == digits) {
+        *error = "missing digits";
+        return -1;
+    }
+
+    // suffix: u, l, ll (not lL) in either order
+    bool is_unsigned = false;
+    int longs = 0;
+    for (int part = 0; part < 2; part++) {
+        if (!is_unsigned && (content[pos] | 0x20) == 'u') {
+            is_unsigned = true;
+            pos++;
+        } else if (longs == 0 && (content[pos] | 0x20) == 'l') {
+            longs = content[pos + 1] == content[pos] ? 2 : 1;
+            pos += longs;
+        }
+    }
+
+    if (is_ident(content[pos])) {
+        *error = "invalid suffix";
+        return -1;
+    }
+
+    if (overflow) {
+        *error = "value too large";
+        return -1;
+    }
+
+    constant->value = value;
+    constant->type = integer_type(value, base == 10, is_unsigned, longs);
+    return pos;
 }
 
-struct m_vector *lexer(const char *content)
+/**
+ * Punctuators are matched by a maximal-munch DFA whose states are the
+ * token types themselves: `punct_start` maps the first character to the
+ * single character token, and `punct_next` extends the current token by
+ * the class of the next character while a longer token exists.
+ * TOKEN_IDENTIFIER (0) is never a punctuator, so 0 means "no match".
+ */
+#define PUNCT_NONE 0
+
+enum punct_class {
+    P_OTHER, P_EQUAL, P_AND, P_PIPE, P_PLUS, P_MINUS, P_LESS, P_GREATER,
+    PUNCT_CLASS_COUNT
+};
+
+static const unsigned char punct_classes[256] = {
+    ['='] = P_EQUAL, ['&'] = P_AND, ['|'] = P_PIPE, ['+'] = P_PLUS,
+    ['-'] = P_MINUS, ['<'] = P_LESS, ['>'] = P_GREATER,
+};
+
+static const unsigned char punct_start[256] = {
+    ['('] = TOKEN_OPEN_PARENTHESIS, [')'] = TOKEN_CLOSE_PARENTHESIS,
+    ['{'] = TOKEN_OPEN_BRACE, ['}'] = TOKEN_CLOSE_BRACE,
+    [';'] = TOKEN_SEMICOLON, ['~'] = TOKEN_TILDA,
+    ['?'] = TOKEN_QUESTION_MARK, [':'] = TOKEN_COLON,
+    ['^'] = TOKEN_CARET, ['%'] = TOKEN_PERCENT, ['&'] = TOKEN_AND,
+    ['|'] = TOKEN_PIPE, ['='] = TOKEN_EQUAL, ['!'] = TOKEN_BANG,
+    ['>'] = TOKEN_GREATER_THAN, ['<'] = TOKEN_LESS_THAN,
+    ['-'] = TOKEN_MINUS, ['+'] = TOKEN_PLUS, ['/'] = TOKEN_SLASH,
+    ['*'] = TOKEN_STAR,
+};
+
+static const unsigned char punct_next[TOKEN_TYPE_COUNT][PUNCT_CLASS_COUNT] = {
+    [TOKEN_CARET]           = { [P_EQUAL] = TOKEN_CARET_EQUAL },
+    [TOKEN_PERCENT]         = { [P_EQUAL] = TOKEN_PERCENT_EQUAL },
+    [TOKEN_AND]             = { [P_AND] = TOKEN_AND_AND, [P_EQUAL] = TOKEN_AND_EQUAL },
+    [TOKEN_PIPE]            = { [P_PIPE] = TOKEN_PIPE_PIPE, [P_EQUAL] = TOKEN_PIPE_EQUAL },
+    [TOKEN_EQUAL]           = { [P_EQUAL] = TOKEN_EQUAL_EQUAL },
+    [TOKEN_BANG]            = { [P_EQUAL] = TOKEN_BANG_EQUAL },
+    [TOKEN_GREATER_THAN]    = { [P_EQUAL] = TOKEN_GREATER_THAN_EQUAL, [P_GREATER] = TOKEN_GT_GT },
+    [TOKEN_GT_GT]           = { [P_EQUAL] = TOKEN_GT_GT_EQUAL },
+    [TOKEN_LESS_THAN]       = { [P_EQUAL] = TOKEN_LESS_THAN_EQUAL, [P_LESS] = TOKEN_LT_LT },
+    [TOKEN_LT_LT]           = { [P_EQUAL] = TOKEN_LT_LT_EQUAL },
+    [TOKEN_MINUS]           = { [P_MINUS] = TOKEN_MINUS_MINUS, [P_EQUAL] = TOKEN_MINUS_EQUAL },
+    [TOKEN_PLUS]            = { [P_PLUS] = TOKEN_PLUS_PLUS, [P_EQUAL] = TOKEN_PLUS_EQUAL },
+    [TOKEN_SLASH]           = { [P_EQUAL] = TOKEN_SLASH_EQUAL },
+    [TOKEN_STAR]            = { [P_EQUAL] = TOKEN_STAR_EQUAL },
+};
+
+/**
+ * Parse the character literal starting at content[start] (the opening
+ * quote) into *value. Returns the position of the closing quote.
+ */
+static int seek_char_literal(int start, const char *content, int *value)
 {
-    struct m_vector *tokens = vector_init(sizeof(struct token));
-    int current = 0;
-    int line = 1;
-    size_t size = strlen(content);
+    int current = start + 1;
+    char c = content[current++];
 
-    while (current < size)
-    {
-        switch (content[current])
-        {
-            // symbols
-            case '(':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_OPEN_PARENTHESIS,
-                    .value = "(",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case ')':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_CLOSE_PARENTHESIS,
-                    .value = ")",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case '{':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_OPEN_BRACE,
-                    .value = "{",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case '}':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_CLOSE_BRACE,
-                    .value = "{",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case ';':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_SEMICOLON,
-                    .value = "{",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case '^':
-                current++;
-                if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_CARET_EQUAL,
-                        .value = "^=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_CARET,
-                        .value = "^",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '%':
-                current++;
-                if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PERCENT_EQUAL,
-                        .value = "%=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PERCENT,
-                        .value = "%",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '&':
-                current++;
-                if (content[current] == '&') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_AND_AND,
-                        .value = "&&",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_AND_EQUAL,
-                        .value = "&=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_AND,
-                        .value = "&",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '|':
-                current++;
-                if (content[current] == '|') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PIPE_PIPE,
-                        .value = "||",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PIPE_EQUAL,
-                        .value = "|=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PIPE,
-                        .value = "|",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '=':
-                current++;
-                if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_EQUAL_EQUAL,
-                        .value = "==",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_EQUAL,
-                        .value = "=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '!':
-                current++;
-                if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_BANG_EQUAL,
-                        .value = "!=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_BANG,
-                        .value = "!",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '>':
-                current++;
-                if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_GREATER_THAN_EQUAL,
-                        .value = ">=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else if (content[current] == '>') {
-                    current++;
-                    if (content[current] == '=') {
-                        token_insert(tokens, (struct token) {
-                            .type = TOKEN_GT_GT_EQUAL,
-                            .value = ">>=",
-                            .line = line,
-                            .allocated = false,
-                        });
-                        current++;
-                    } else {
-                        token_insert(tokens, (struct token) {
-                            .type = TOKEN_GT_GT,
-                            .value = ">>",
-                            .line = line,
-                            .allocated = false,
-                        });
-                    }
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_GREATER_THAN,
-                        .value = ">",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '<':
-                current++;
-                if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_LESS_THAN_EQUAL,
-                        .value = "<=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else if (content[current] == '<') {
-                    current++;
-                    if (content[current] == '=') {
-                        token_insert(tokens, (struct token) {
-                            .type = TOKEN_LT_LT_EQUAL,
-                            .value = "<<=",
-                            .line = line,
-                            .allocated = false,
-                        });
-                        current++;
-                    } else {
-                        token_insert(tokens, (struct token) {
-                            .type = TOKEN_LT_LT,
-                            .value = "<<",
-                            .line = line,
-                            .allocated = false,
-                        });
-                    }
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_LESS_THAN,
-                        .value = "<",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '-':
-                current++;
-                if (content[current] == '-') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_MINUS_MINUS,
-                        .value = "--",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_MINUS_EQUAL,
-                        .value = "-=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_MINUS,
-                        .value = "-",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '+':
-                current++;
-                if (content[current] == '+') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PLUS_PLUS,
-                        .value = "++",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PLUS_EQUAL,
-                        .value = "+=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_PLUS,
-                        .value = "+",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '/':
-                current++;
-                if (content[current] == '/') {
-                    current++;
-                    for (; content[current] != '\n' && content[current] != '\0'; current++);
-                } else if (content[current] == '*') {
-                    current++;
-                    int starting_line = line;
-
-                    while (true) {
-                        if (content[current] == '\0') {
-                            fprintf(stderr,
-                                "Unexpected EOF symbol, missing comment terminator '*/' for line %d\n",
-                                starting_line);
-                            goto cleanup;
-                        } else if (content[current] == '\n') {
-                            line++;
-                            current++;
-                        } else if (content[current] == '*') {
-                            current++;
-
-                            if (content[current] == '/') {
-                                current++;
-                                break;
-                            }
-                        } else current++;
-                    }
-                } else if (content[current] == '=') {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_SLASH_EQUAL,
-                        .value = "/=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                    current++;
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_SLASH,
-                        .value = "/",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '~':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_TILDA,
-                    .value = "~",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case '?':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_QUESTION_MARK,
-                    .value = "?",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case ':':
-                token_insert(tokens, (struct token) {
-                    .type = TOKEN_COLON,
-                    .value = ":",
-                    .line = line,
-                    .allocated = false,
-                });
-                current++;
-                break;
-            case '*':
-                current++;
-                if (content[current] == '=') {
-                    current++;
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_STAR_EQUAL,
-                        .value = "*=",
-                        .line = line,
-                        .allocated = false,
-                    });
-                } else {
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_STAR,
-                        .value = "*",
-                        .line = line,
-                        .allocated = false,
-                    });
-                }
-                break;
-            case '\'':
-                current++;
-                {
-                    char toinsert;
-
-                    if (content[current] == '\\') {
-                        current++;
-                        char c = content[current];
-
-                        toinsert =  c == 'a' ? '\a' :
-                                    c == 'b' ? '\b' :
-                                    c == 'e' ? '\e' :
-                                    c == 'f' ? '\f' :
-                                    c == 'n' ? '\n' :
-                                    c == 'r' ? '\r' :
-                                    c == 't' ? '\t' :
-                                    c == 'v' ? '\v' :
-                                    c == '\\' ? '\\' :
-                                    c == '\'' ? '\'' :
-                                    c == '"' ? '"' :
-                                    c == '?' ? '\?' :
-                                    0;
-
-                        if (toinsert == 0) {
-                            if (is_digit(content[current]) && is_digit(content[current + 1]) && is_digit(content[current + 2])) {
-                                char *octal = str_sub(content, current, 3);
-                                toinsert = (int) strtol(octal, NULL, 8);
-                                free(octal);
-                                current += 3;
-                            } else if (content[current] == 'x' && is_hex(content[current + 1]) && is_hex(content[current + 2])) {
-                                current++;
-                                char *hex = str_sub(content, current, 2);
-                                toinsert = (int) strtol(hex, NULL, 16);
-                                free(hex);
-                                current += 2;
-                            } else {
-                                toinsert = ' ';
-                                current++;
-                            }
-                        }
-                    } else {
-                        toinsert = content[current++];
-                    }
-
-                    token_insert(tokens, (struct token) {
-                        .type = TOKEN_CONSTANT, 
-                        .value = int_to_str((int) toinsert),
-                        .line = line,
-                        .allocated = true,
-                    });
-                }
-                    
-                if (content[current] == '\'') current++;
-                else goto syntax_error;
+    if (c == '\\') {
+        c = content[current++];
+
+        switch (c) {
+            case 'a': c = '\a'; break;
+            case 'b': c = '\b'; break;
+            case 'e': c = '\e'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'v': c = '\v'; break;
+
+            case 'x': {
+                // unsigned, so a long escape wraps instead of overflowing;
+                // only the low byte is kept anyway
+                unsigned hex = 0;
+                while (is_hex(content[current]))
+                    hex = hex * 16 + hex_value(content[current++]);
+                c = (char) hex;
                 break;
+            }
 
-            // skips
-            case '\n':
-                line++;
-            case '\r':
-            case '\t':
-            case ' ':
-                current++;
+            case '0': case '1': case '2': case '3':
+            case '4': case '5': case '6': case '7': {
+                // up to three octal digits
+                int octal = c - '0';
+                for (int n = 1; n < 3 && content[current] >= '0' && content[current] <= '7'; n++)
+                    octal = octal * 8 + (content[current++] - '0');
+                c = (char) octal;
                 break;
+            }
 
-            default:
-                // identifier
-                if (is_alpha(content[current]))
-                    current = seek_identifier(current, content, tokens, line);
-                // constants
-                else if (is_digit(content[current]))
-                    current = seek_constant(current, content, tokens, line);
-                else goto syntax_error;
+            default:    // \\ \' \" \? stand for themselves
                 break;
         }
     }
 
-    token_insert(tokens, (struct token) {
-        .type = TOKEN_EOF,
-        .value = "EOF",
-        .line = line
-    });
+    *value = c;     // char is signed, so '\377' is -1 like in gcc
+    return current;
+}
+
+/**
+ * Walk the punctuator DFA from content[pos], returning the position after
+ * the longest match (pos itself, with TOKEN_ERROR, if there is none).
+ */
+static int punct_end(const char *content, int pos, enum token_type *type)
+{
+    enum token_type state = punct_start[(unsigned char) content[pos]];
+    if (state == PUNCT_NONE) {
+        *type = TOKEN_ERROR;
+        return pos;
+    }
+    pos++;
+
+    enum token_type next;
+    while ((next = punct_next[state][punct_classes[(unsigned char) content[pos]]]) != PUNCT_NONE) {
+        state = next;
+        pos++;
+    }
+
+    *type = state;
+    return pos;
+}
+
+static void lexer_start(struct lexer *lex, struct source *src, int position, bool speculative)
+{
+    *lex = (struct lexer) {
+        .src = src,
+        .content = src->data,
+        .current = position,
+        .speculative = speculative,
+    };
+}
+
+static bool parallel_worthwhile(struct source *src)
+{
+    return src->size >= LEXER_PARALLEL_MIN && cpu_count() > 1;
+}
+
+void lexer_init(struct lexer *lex, struct source *src)
+{
+    scan_init();
+    lexer_start(lex, src, 0, false);
+}
+
+bool lexer_tokenize_all(struct lexer *lex)
+{
+    if (lex->store != NULL) return true;
+    if (lex->error) return false;   // already reported by lex_token() or an earlier call
+
+    lex->store = lexer(lex->src);
+    if (lex->store == NULL) lex->error = true;
+    return lex->store != NULL;
+}
+
+void lexer_replay(struct lexer *lex, const struct lexer *from, int position)
+{
+    *lex = (struct lexer) {
+        .src = from->src,
+        .content = from->content,
+        .store = from->store,
+        .position = position,
+    };
+}
+
+void lexer_cleanup(struct lexer *lex)
+{
+    if (lex->store != NULL) token_store_free(lex->store);
+    lex->store = NULL;
+}
+
+/**
+ * Scan the next token, skipping whitespace and comments. Its position is
+ * stored in *offset, the symbol id of an identifier in *payload and the
+ * value of a constant in lex->constant.
+ */
+static enum token_type lex_token(struct lexer *lex, uint32_t *offset, uint32_t *payload)
+{
+    const char *content = lex->content;
+    const int size = (int) lex->src->size;
+
+    *payload = 0;
+    if (lex->error) {
+        *offset = lex->current;
+        return TOKEN_ERROR;
+    }
+
+    while (lex->current < size)
+    {
+        const char c = content[lex->current];
+        *offset = lex->current;
+
+        // skips, single separators are common enough to handle inline
+        if (is_space(c)) {
+            lex->current++;
+            if (is_space(content[lex->current]))
+                lex->current = scan.skip_space(content, lex->current);
+            continue;
+        }
+
+        // identifier
+        if (is_ident_start(c))
+            return seek_identifier(lex, payload);
+
+        // constants
+        if (is_digit(c)) {
+            const char *reason;
+            const int end = seek_integer(content, lex->current, &lex->constant, &reason);
+            if (end < 0) {
+                if (!lex->speculative) fprintf(stderr,
+                    "Syntax error on line %d, %s in integer constant '%.*s'\n",
+                    source_line(lex->src, *offset), reason,
+                    scan.ident_end(content, lex->current) - lex->current, content + lex->current);
+                goto error;
+            }
+
+            lex->current = end;
+            return TOKEN_CONSTANT;
+        }
+
+        if (c == '/' && content[lex->current + 1] == '/') {
+            lex->current += 2;
+            for (; content[lex->current] != '\n' && content[lex->current] != '\0'; lex->current++);
+            continue;
+        }
+
+        if (c == '/' && content[lex->current + 1] == '*') {
+            lex->current = scan.comment_end(content, lex->current + 2);
+            if (content[lex->current] == '\0') {
+                if (!lex->speculative) fprintf(stderr,
+                    "Unexpected EOF symbol, missing comment terminator '*/' for line %d\n",
+                    source_line(lex->src, *offset));
+                goto error;
+            }
+
+            lex->current += 2;
+            continue;
+        }
+
+        if (c == '\'') {
+            int value;
+            lex->current = seek_char_literal(lex->current, content, &value);
+            if (content[lex->current] != '\'') goto syntax_error;
+
+            lex->current++;
+            lex->constant = (struct constant) { .value = (int64_t) value, .type = CONSTANT_INT };
+            return TOKEN_CONSTANT;
+        }
+
+        // symbols
+        enum token_type type;
+        lex->current = punct_end(content, lex->current, &type);
+        if (lex->current == (int) *offset) goto syntax_error;
+        return type;
+    }
+
+    *offset = size;
+    return TOKEN_EOF;
 
-    return tokens;
-    
 syntax_error:
-    fprintf(stderr,
+    if (!lex->speculative) fprintf(stderr,
         "Syntax error on line %d, unexpected character '%c'\n",
-        line, content[current]
+        source_line(lex->src, lex->current), content[lex->current]
     );
 
-cleanup:
-    token_cleanup(tokens);
+error:
+    lex->error = true;
+    *offset = lex->current;
+    return TOKEN_ERROR;
+}
+
+struct token token_view(const char *content, enum token_type kind, uint32_t offset, uint32_t payload,
+                        const struct constant *constant)
+{
+    struct token t = {
+        .type = kind,
+        .value = content + offset,
+        .offset = offset,
+    };
+
+    int end = offset, value;
+    switch (kind) {
+        case TOKEN_EOF:
+            t.value = "EOF";
+            t.length = 3;
+            return t;
+
+        case TOKEN_ERROR:
+            return t;
+
+        case TOKEN_IDENTIFIER:
+            t.symbol = payload;
+            t.length = intern_at(payload).length;
+            return t;
+
+        case TOKEN_CONSTANT:
+            t.constant = *constant;
+            if (content[offset] == '\'')
+                end = seek_char_literal(offset, content, &value) + 1;
+            else
+                end = scan.ident_end(content, offset);     // digits and suffix
+            break;
+
+        default:
+            if (is_ident_start(content[offset]))
+                end = scan.ident_end(content, offset);      // keyword
+            else
+                end = punct_end(content, offset, &kind);
+            break;
+    }
+
+    t.length = end - offset;
+    return t;
+}
+
+struct token token_store_at(struct token_store *store, const char *content, int index)
+{
+    const uint32_t payload = store->payloads[index];
+    return token_view(content, store->kinds[index], store->offsets[index], payload,
+                      store->kinds[index] == TOKEN_CONSTANT ? &store->constants[payload] : NULL);
+}
+
+enum token_type peek_kind(struct lexer *lex, int k)
+{
+    if (lex->store != NULL) {
+        // the store ends with TOKEN_EOF, which repeats forever
+        const int i = lex->position + k < lex->store->count ? lex->position + k : lex->store->count - 1;
+        return lex->store->kinds[i];
+    }
+
+    while (lex->count <= k) {
+        const int slot = (lex->head + lex->count) & (LEXER_LOOKAHEAD - 1);
+        lex->kinds[slot] = lex_token(lex, &lex->offsets[slot], &lex->payloads[slot]);
+        if (lex->kinds[slot] == TOKEN_CONSTANT) lex->constants[slot] = lex->constant;
+        lex->count++;
+    }
+
+    return lex->kinds[(lex->head + k) & (LEXER_LOOKAHEAD - 1)];
+}
+
+struct token peek_token(struct lexer *lex, int k)
+{
+    const enum token_type kind = peek_kind(lex, k);
+
+    if (lex->store != NULL) {
+        const int i = lex->position + k < lex->store->count ? lex->position + k : lex->store->count - 1;
+        return token_store_at(lex->store, lex->content, i);
+    }
+
+    const int slot = (lex->head + k) & (LEXER_LOOKAHEAD - 1);
+    return token_view(lex->content, kind, lex->offsets[slot], lex->payloads[slot], &lex->constants[slot]);
+}
+
+void skip_token(struct lexer *lex)
+{
+    if (lex->store != NULL) {
+        if (lex->position < lex->store->count - 1) lex->position++;
+        return;
+    }
+
+    peek_kind(lex, 0);
+    lex->head = (lex->head + 1) & (LEXER_LOOKAHEAD - 1);
+    lex->count--;
+}
+
+struct token next_token(struct lexer *lex)
+{
+    struct token t = peek_token(lex, 0);
+    skip_token(lex);
+    return t;
+}
+
+/**
+ * A slice of the input for the parallel lexer. Tokens starting in
+ * [start, end) belong to the chunk; exit is the offset of the first token
+ * past it, where the next chunk has to pick up.
+ */
+struct chunk {
+    int start;
+    int end;
+    struct token_store *tokens;
+    struct intern_table *symbols;   // identifier payloads are ids in here when speculative
+    int exit;
+    bool error;         // lexing stopped at a lexical error
+};
+
+static void lex_chunk(struct source *src, struct chunk *c, bool speculative)
+{
+    struct lexer lex;
+    lexer_start(&lex, src, c->start, speculative);
+    if (speculative)
+        lex.symbols = c->symbols = intern_table_init();
+
+    c->tokens = token_store_init();
+    c->error = false;
+
+    while (true) {
+        uint32_t offset, payload;
+        enum token_type kind = lex_token(&lex, &offset, &payload);
+
+        if (kind == TOKEN_ERROR) c->error = true;
+        if (kind == TOKEN_ERROR || (int) offset >= c->end) {
+            c->exit = offset;
+            return;
+        }
+
+        if (kind == TOKEN_CONSTANT)
+            token_store_push_constant(c->tokens, offset, lex.constant);
+        else
+            token_store_push(c->tokens, kind, offset, payload);
+    }
+}
+
+struct token_store *lexer(struct source *src)
+{
+    scan_init();
+
+    if (parallel_worthwhile(src)) {
+        struct pool *pool = pool_init(0);
+        struct token_store *tokens = lexer_parallel(src, pool, LEXER_CHUNK_SIZE);
+        pool_free(pool);
+        return tokens;
+    }
+
+    struct chunk all = { .start = 0, .end = (int) src->size };
+    lex_chunk(src, &all, false);
+
+    if (all.error) {
+        token_store_free(all.tokens);
+        return NULL;
+    }
+
+    token_store_push(all.tokens, TOKEN_EOF, src->size, 0);
+    return all.tokens;
+}
+
+struct parallel_lex {
+    struct source *src;
+    struct chunk *chunks;
+};
+
+static void lex_chunk_task(void *arg, int index)
+{
+    struct parallel_lex *job = (struct parallel_lex*) arg;
+    lex_chunk(job->src, &job->chunks[index], true);
+}
+
+/** index of the token starting at offset, -1 if there is none */
+static int find_offset(struct token_store *tokens, uint32_t offset)
+{
+    int low = 0, high = tokens->count;
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (tokens->offsets[mid] < offset) low = mid + 1;
+        else high = mid;
+    }
+
+    return low < tokens->count && tokens->offsets[low] == offset ? low : -1;
+}
+
+/**
+ * Every chunk is lexed as if it started outside of any comment or
+ * literal. The chunks are then stitched in order: lexing is deterministic
+ * from the start of a token, so once the previous chunk exits at a token
+ * this chunk also produced, everything after it is what the sequential
+ * lexer would have seen. A chunk that guessed wrong (it starts inside a
+ * block comment or a character literal spanning the break) never
+ * produces that token and is lexed again from the exit point.
+ */
+struct token_store *lexer_parallel(struct source *src, struct pool *pool, size_t chunk_size)
+{
+    scan_init();
+
+    const int size = (int) src->size;
+    struct chunk *chunks = (struct chunk*) malloc((size / chunk_size + 1) * sizeof(struct chunk));
+    int count = 0;
+
+    // split after a newline at or past every chunk_size bytes
+    for (int start = 0; start < size || count == 0; count++) {
+        int end = start + (int) chunk_size;
+        if (end >= size) {
+            end = size;
+        } else {
+            const char *newline = memchr(src->data + end, '\n', size - end);
+            end = newline == NULL ? size : (int) (newline - src->data) + 1;
+        }
+
+        chunks[count] = (struct chunk) { .start = start, .end = end };
+        start = end;
+    }
+
+    struct parallel_lex job = { .src = src, .chunks = chunks };
+    pool_run(pool, count, lex_chunk_task, &job);
+
+    struct token_store *tokens = token_store_init();
+    int position = 0;       // the sequential lexer is at a token (or the start) here
+
+    for (int i = 0; i < count; i++) {
+        struct chunk *c = &chunks[i];
+        if (position >= c->end) continue;   // swallowed by a comment
+
+        int first = position == c->start ? 0 : find_offset(c->tokens, position);
+        if (first < 0) {
+            token_store_free(c->tokens);
+            intern_table_free(c->symbols);
+            c->start = position;
+            lex_chunk(src, c, true);
+            first = 0;
+        }
+
+        if (c->error) {
+            // the error is real, lex again to report it
+            struct chunk report = { .start = position, .end = c->end };
+            lex_chunk(src, &report, false);
+            token_store_free(report.tokens);
+            goto error;
+        }
+
+        // local ids get their global id on first use, which keeps the
+        // global ids in order of first appearance
+        const int local_count = intern_local_count(c->symbols);
+        int *global = (int*) malloc((local_count + 1) * sizeof(int));
+        memset(global, -1, local_count * sizeof(int));
+
+        const int base = tokens->count;
+        token_store_append(tokens, c->tokens, first);
+
+        for (int t = base; t < tokens->count; t++) {
+            if (tokens->kinds[t] != TOKEN_IDENTIFIER) continue;
+
+            const uint32_t id = tokens->payloads[t];
+            if (global[id] < 0) {
+                struct interned local = intern_local_at(c->symbols, id);
+                global[id] = intern_hashed(local.value, local.length, local.hash);
+            }
+            tokens->payloads[t] = global[id];
+        }
+
+        free(global);
+
+        position = c->exit;
+    }
+
+    token_store_push(tokens, TOKEN_EOF, size, 0);
+
+    for (int i = 0; i < count; i++) {
+        token_store_free(chunks[i].tokens);
+        intern_table_free(chunks[i].symbols);
+    }
+    free(chunks);
+    return tokens;
+
+error:
+    for (int i = 0; i < count; i++) {
+        token_store_free(chunks[i].tokens);
+        intern_table_free(chunks[i].symbols);
+    }
+    free(chunks);
+    token_store_free(tokens);
     return NULL;
-}
\ No newline at end of file
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "token.h"
+#include "../source.h"
+#include "../pool.h"
+
+/** tokens buffered ahead of the parser, must be a power of two */
+#define LEXER_LOOKAHEAD 4
+
+/** lexer_tokenize_all() splits inputs at least this big over all CPUs, in chunks of LEXER_CHUNK_SIZE */
+#define LEXER_PARALLEL_MIN (4 << 20)
+#define LEXER_CHUNK_SIZE (1 << 20)
+
+/**
+ * Pull based lexer. The parser asks for tokens with next_token() and
+ * peek_token() and the source is only scanned as far as it has looked,
+ * so token memory stays at LEXER_LOOKAHEAD tokens no matter the input size.
+ *
+ * lexer_tokenize_all() instead lexes everything up front (in parallel
+ * for large inputs) and the tokens are replayed from the resulting store;
+ * the parser can't tell the difference. That gives up the constant token
+ * memory and the overlap of lexing with parsing, so it is only done on
+ * request: for --lazy, which jumps around in the tokens, and --parallel.
+ *
+ * Once the input is exhausted every further token is TOKEN_EOF. After a
+ * lexical error (already reported on stderr) every further token is
+ * TOKEN_ERROR.
+ */
+struct lexer {
+    struct source *src;
+    const char *content;
+    int current;
+    bool error;         // a lexical error was reported
+    bool speculative;   // lexing a chunk that may start inside a comment,
+                        // report nothing and intern into `symbols`
+    struct intern_table *symbols;
+    struct constant constant;   // value of the last constant scanned
+
+    // prebuilt tokens, NULL when lexing on demand
+    struct token_store *store;
+    int position;
+
+    // lookahead ring, packed like struct token_store
+    uint8_t kinds[LEXER_LOOKAHEAD];
+    uint32_t offsets[LEXER_LOOKAHEAD];
+    uint32_t payloads[LEXER_LOOKAHEAD];
+    struct constant constants[LEXER_LOOKAHEAD];
+    int head;       // ring index of the next token
+    int count;      // number of buffered tokens
+};
+
+/** src must outlive the lexer, tokens are views into it */
+void lexer_init(struct lexer *lex, struct source *src);
+void lexer_cleanup(struct lexer *lex);
+
+/**
+ * Tokenize the whole input now, so the parser can jump around in it,
+ * on all CPUs from LEXER_PARALLEL_MIN bytes on. Call it before reading
+ * the first token. Does nothing if the tokens were prebuilt already;
+ * false (after reporting it) on a lexical error.
+ */
+bool lexer_tokenize_all(struct lexer *lex);
+
+/**
+ * Another reader of the prebuilt tokens of `from`, starting at token
+ * `position`. Readers only share the store, so each can be used on its
+ * own thread; only `from` needs lexer_cleanup().
+ */
+void lexer_replay(struct lexer *lex, const struct lexer *from, int position);
+
+/** kind of the token k positions ahead, k < LEXER_LOOKAHEAD */
+enum token_type peek_kind(struct lexer *lex, int k);
+
+/** return the token k positions ahead without consuming it, k < LEXER_LOOKAHEAD */
+struct token peek_token(struct lexer *lex, int k);
+
+/** consume and return the next token */
+struct token next_token(struct lexer *lex);
+
+/** consume the next token without unpacking it */
+void skip_token(struct lexer *lex);
+
+/** tokenize the whole input at once, NULL on error */
+struct token_store *lexer(struct source *src);
+
+/**
+ * Tokenize the input in chunks of about chunk_size bytes split at line
+ * breaks, lexing all chunks at once on the pool. The result is identical
+ * to the sequential lexer, NULL on error.
+ */
+struct token_store *lexer_parallel(struct source *src, struct pool *pool, size_t chunk_size);
+
+/**
+ * Unpack a packed token, content is the source it was lexed from.
+ * constant is only read for a TOKEN_CONSTANT.
+ */
+struct token token_view(const char *content, enum token_type kind, uint32_t offset, uint32_t payload,
+                        const struct constant *constant);
+struct token token_store_at(struct token_store *store, const char *content, int index);
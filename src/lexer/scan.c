@@ -0,0 +1,158 @@
+#include "scan.h"
+#include "../helpers.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_X86
+#endif
+
+/* scalar fallback */
+
+static int skip_space_scalar(const char *content, int pos) {
+    while (is_space(content[pos]))
+        pos++;
+    return pos;
+}
+
+static int comment_end_scalar(const char *content, int pos) {
+    for (;; pos++) {
+        const char c = content[pos];
+        if (c == '\0' || (c == '*' && content[pos + 1] == '/')) return pos;
+    }
+}
+
+static int ident_end_scalar(const char *content, int pos) {
+    while (is_ident(content[pos]))
+        pos++;
+    return pos;
+}
+
+#ifdef SCAN_X86
+
+/**
+ * Each kernel builds a bitmask of the bytes that end the scan and stops
+ * at its lowest set bit. Byte ranges are checked with signed compares,
+ * which is fine because every class we look for is ASCII (bytes >= 0x80
+ * compare as negative).
+ */
+
+#define SSE2_IN_RANGE(v, lo, hi) _mm_and_si128( \
+    _mm_cmpgt_epi8(v, _mm_set1_epi8((lo) - 1)), \
+    _mm_cmpgt_epi8(_mm_set1_epi8((hi) + 1), v))
+
+static int skip_space_sse2(const char *content, int pos) {
+    for (;; pos += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*) (content + pos));
+        const __m128i space = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+
+        const unsigned int stop = ~_mm_movemask_epi8(space) & 0xFFFF;
+        if (stop) return pos + __builtin_ctz(stop);
+    }
+}
+
+static int comment_end_sse2(const char *content, int pos) {
+    for (;; pos += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*) (content + pos));
+        const __m128i next = _mm_loadu_si128((const __m128i*) (content + pos + 1));
+        const __m128i end = _mm_or_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')),
+                          _mm_cmpeq_epi8(next, _mm_set1_epi8('/'))),
+            _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+
+        const unsigned int stop = _mm_movemask_epi8(end);
+        if (stop) return pos + __builtin_ctz(stop);
+    }
+}
+
+static int ident_end_sse2(const char *content, int pos) {
+    for (;; pos += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*) (content + pos));
+        const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        const __m128i ident = _mm_or_si128(
+            _mm_or_si128(SSE2_IN_RANGE(lower, 'a', 'z'), SSE2_IN_RANGE(v, '0', '9')),
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+
+        const unsigned int stop = ~_mm_movemask_epi8(ident) & 0xFFFF;
+        if (stop) return pos + __builtin_ctz(stop);
+    }
+}
+
+#define AVX2_IN_RANGE(v, lo, hi) _mm256_and_si256( \
+    _mm256_cmpgt_epi8(v, _mm256_set1_epi8((lo) - 1)), \
+    _mm256_cmpgt_epi8(_mm256_set1_epi8((hi) + 1), v))
+
+__attribute__((target("avx2,bmi")))
+static int skip_space_avx2(const char *content, int pos) {
+    for (;; pos += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*) (content + pos));
+        const __m256i space = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+
+        const unsigned int stop = ~(unsigned int) _mm256_movemask_epi8(space);
+        if (stop) return pos + __builtin_ctz(stop);
+    }
+}
+
+__attribute__((target("avx2,bmi")))
+static int comment_end_avx2(const char *content, int pos) {
+    for (;; pos += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*) (content + pos));
+        const __m256i next = _mm256_loadu_si256((const __m256i*) (content + pos + 1));
+        const __m256i end = _mm256_or_si256(
+            _mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')),
+                             _mm256_cmpeq_epi8(next, _mm256_set1_epi8('/'))),
+            _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+
+        const unsigned int stop = _mm256_movemask_epi8(end);
+        if (stop) return pos + __builtin_ctz(stop);
+    }
+}
+
+__attribute__((target("avx2,bmi")))
+static int ident_end_avx2(const char *content, int pos) {
+    for (;; pos += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*) (content + pos));
+        const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        const __m256i ident = _mm256_or_si256(
+            _mm256_or_si256(AVX2_IN_RANGE(lower, 'a', 'z'), AVX2_IN_RANGE(v, '0', '9')),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+
+        const unsigned int stop = ~(unsigned int) _mm256_movemask_epi8(ident);
+        if (stop) return pos + __builtin_ctz(stop);
+    }
+}
+
+#endif
+
+struct scan_kernels scan = {
+    .skip_space = skip_space_scalar,
+    .comment_end = comment_end_scalar,
+    .ident_end = ident_end_scalar,
+};
+
+void scan_init(void) {
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        scan = (struct scan_kernels) {
+            .skip_space = skip_space_avx2,
+            .comment_end = comment_end_avx2,
+            .ident_end = ident_end_avx2,
+        };
+    } else if (__builtin_cpu_supports("sse2")) {
+        scan = (struct scan_kernels) {
+            .skip_space = skip_space_sse2,
+            .comment_end = comment_end_sse2,
+            .ident_end = ident_end_sse2,
+        };
+    }
+#endif
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * Vectorized scanning kernels for the lexer's longest runs: whitespace,
+ * block comments and identifiers. An SSE2 or AVX2 version is picked at
+ * runtime (CPUID), with a scalar fallback on other CPUs.
+ *
+ * All kernels may read up to 32 bytes past the position they return, so
+ * the buffer needs SOURCE_PADDING bytes of zero padding (see source.h).
+ * '\0' always stops a scan.
+ */
+struct scan_kernels {
+    /** returns the first non-whitespace position at or after pos */
+    int (*skip_space)(const char *content, int pos);
+
+    /** returns the position of the first "*" of a "*" "/" pair (or of
+     *  a '\0') at or after pos */
+    int (*comment_end)(const char *content, int pos);
+
+    /** returns the first position at or after pos that is not [A-Za-z0-9_] */
+    int (*ident_end)(const char *content, int pos);
+};
+
+extern struct scan_kernels scan;
+
+/** select the kernels for this CPU, safe to call more than once */
+void scan_init(void);
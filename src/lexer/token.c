@@ -1,31 +1,146 @@
 #include "token.h"
 
-void token_insert(struct m_vector* vec, struct token data) {
-    if (vec->_size + 1 >= vec->_capacity)
-        vector_resize(vec, vec->_capacity + 100);
+_Static_assert(TOKEN_TYPE_COUNT <= 256, "token kinds are stored in one byte");
 
-    ((struct token*) vec->_data)[vec->_size] = data;
-    vec->_size++;
+struct token_store *token_store_init(void) {
+    struct token_store *store = (struct token_store*) malloc(sizeof(struct token_store));
+    store->count = 0;
+    store->_capacity = 1024;
+    store->kinds = (uint8_t*) malloc(store->_capacity * sizeof(uint8_t));
+    store->offsets = (uint32_t*) malloc(store->_capacity * sizeof(uint32_t));
+    store->payloads = (uint32_t*) malloc(store->_capacity * sizeof(uint32_t));
+
+    store->constant_count = 0;
+    store->_constant_capacity = 256;
+    store->constants = (struct constant*) malloc(store->_constant_capacity * sizeof(struct constant));
+    return store;
+}
+
+static void token_store_reserve(struct token_store *store, int count) {
+    if (count <= store->_capacity) return;
+
+    while (store->_capacity < count)
+        store->_capacity *= 2;
+    store->kinds = (uint8_t*) realloc(store->kinds, store->_capacity * sizeof(uint8_t));
+    store->offsets = (uint32_t*) realloc(store->offsets, store->_capacity * sizeof(uint32_t));
+    store->payloads = (uint32_t*) realloc(store->payloads, store->_capacity * sizeof(uint32_t));
+}
+
+void token_store_push(struct token_store *store, enum token_type kind, uint32_t offset, uint32_t payload) {
+    if (store->count == store->_capacity)
+        token_store_reserve(store, store->count + 1);
+
+    store->kinds[store->count] = kind;
+    store->offsets[store->count] = offset;
+    store->payloads[store->count] = payload;
+    store->count++;
 }
 
-enum token_type token_get_keyword(const char *str) {
-    if (strcmp(str, "int") == 0) return TOKEN_INT;
-    else if (strcmp(str, "return") == 0) return TOKEN_RETURN;
-    else if (strcmp(str, "void") == 0) return TOKEN_VOID;
-    else if (strcmp(str, "char") == 0) return TOKEN_CHAR;
-    else return TOKEN_NOT_KEYWORD;
+static uint32_t add_constant(struct token_store *store, struct constant constant) {
+    if (store->constant_count == store->_constant_capacity) {
+        store->_constant_capacity *= 2;
+        store->constants = (struct constant*) realloc(store->constants,
+            store->_constant_capacity * sizeof(struct constant));
+    }
+
+    store->constants[store->constant_count] = constant;
+    return store->constant_count++;
 }
 
-struct token token_at(struct m_vector *vec, int pos) {
-    return ((struct token*) vec->_data)[pos];
+void token_store_push_constant(struct token_store *store, uint32_t offset, struct constant constant) {
+    token_store_push(store, TOKEN_CONSTANT, offset, add_constant(store, constant));
 }
 
-void token_cleanup(struct m_vector *tokens) {
-    for (int i = 0; i < tokens->_size; i++) {
-        struct token t = ((struct token*) tokens->_data)[i];
-        if (t.allocated) {
-            free(t.value);
-        }
+void token_store_append(struct token_store *store, struct token_store *from, int first) {
+    const int count = from->count - first;
+    if (count <= 0) return;
+
+    const int base = store->count;
+    token_store_reserve(store, store->count + count);
+    memcpy(store->kinds + base, from->kinds + first, count * sizeof(uint8_t));
+    memcpy(store->offsets + base, from->offsets + first, count * sizeof(uint32_t));
+    memcpy(store->payloads + base, from->payloads + first, count * sizeof(uint32_t));
+    store->count += count;
+
+    // constants are renumbered into this store's table
+    for (int i = base; i < store->count; i++) {
+        if (store->kinds[i] == TOKEN_CONSTANT)
+            store->payloads[i] = add_constant(store, from->constants[store->payloads[i]]);
     }
-    vector_free(tokens);
+}
+
+void token_store_free(struct token_store *store) {
+    free(store->kinds);
+    free(store->offsets);
+    free(store->payloads);
+    free(store->constants);
+    free(store);
+}
+
+/**
+ * Keyword recognition uses a perfect hash over (first char, last char,
+ * length), which is unique for every C89/C99 keyword. The table is laid
+ * out by the compiler through KEYWORD_HASH, so adding a keyword is one
+ * line; build with -Wextra (-Woverride-init) to catch a collision.
+ */
+#define KEYWORD_HASH(first, last, length) \
+    ((((first) + (last)) * 3 + (length) * 13) & 127)
+
+#define KEYWORD(first, last, text, token_type) \
+    [KEYWORD_HASH(first, last, sizeof(text) - 1)] = { text, sizeof(text) - 1, token_type }
+
+static const struct {
+    const char *text;
+    int length;
+    enum token_type type;
+} keywords[128] = {
+    KEYWORD('a', 'o', "auto", TOKEN_AUTO),
+    KEYWORD('b', 'k', "break", TOKEN_BREAK),
+    KEYWORD('c', 'e', "case", TOKEN_CASE),
+    KEYWORD('c', 'r', "char", TOKEN_CHAR),
+    KEYWORD('c', 't', "const", TOKEN_CONST),
+    KEYWORD('c', 'e', "continue", TOKEN_CONTINUE),
+    KEYWORD('d', 't', "default", TOKEN_DEFAULT),
+    KEYWORD('d', 'o', "do", TOKEN_DO),
+    KEYWORD('d', 'e', "double", TOKEN_DOUBLE),
+    KEYWORD('e', 'e', "else", TOKEN_ELSE),
+    KEYWORD('e', 'm', "enum", TOKEN_ENUM),
+    KEYWORD('e', 'n', "extern", TOKEN_EXTERN),
+    KEYWORD('f', 't', "float", TOKEN_FLOAT),
+    KEYWORD('f', 'r', "for", TOKEN_FOR),
+    KEYWORD('g', 'o', "goto", TOKEN_GOTO),
+    KEYWORD('i', 'f', "if", TOKEN_IF),
+    KEYWORD('i', 'e', "inline", TOKEN_INLINE),
+    KEYWORD('i', 't', "int", TOKEN_INT),
+    KEYWORD('l', 'g', "long", TOKEN_LONG),
+    KEYWORD('r', 'r', "register", TOKEN_REGISTER),
+    KEYWORD('r', 't', "restrict", TOKEN_RESTRICT),
+    KEYWORD('r', 'n', "return", TOKEN_RETURN),
+    KEYWORD('s', 't', "short", TOKEN_SHORT),
+    KEYWORD('s', 'd', "signed", TOKEN_SIGNED),
+    KEYWORD('s', 'f', "sizeof", TOKEN_SIZEOF),
+    KEYWORD('s', 'c', "static", TOKEN_STATIC),
+    KEYWORD('s', 't', "struct", TOKEN_STRUCT),
+    KEYWORD('s', 'h', "switch", TOKEN_SWITCH),
+    KEYWORD('t', 'f', "typedef", TOKEN_TYPEDEF),
+    KEYWORD('u', 'n', "union", TOKEN_UNION),
+    KEYWORD('u', 'd', "unsigned", TOKEN_UNSIGNED),
+    KEYWORD('v', 'd', "void", TOKEN_VOID),
+    KEYWORD('v', 'e', "volatile", TOKEN_VOLATILE),
+    KEYWORD('w', 'e', "while", TOKEN_WHILE),
+    KEYWORD('_', 'l', "_Bool", TOKEN_BOOL),
+    KEYWORD('_', 'x', "_Complex", TOKEN_COMPLEX),
+    KEYWORD('_', 'y', "_Imaginary", TOKEN_IMAGINARY),
+};
+
+enum token_type token_get_keyword(const char *str, int length) {
+    if (length < 2 || length > 10) return TOKEN_NOT_KEYWORD;
+
+    const int slot = KEYWORD_HASH(
+        (unsigned char) str[0], (unsigned char) str[length - 1], length);
+
+    if (keywords[slot].length == length && memcmp(keywords[slot].text, str, length) == 0)
+        return keywords[slot].type;
+    else
+        return TOKEN_NOT_KEYWORD;
 }
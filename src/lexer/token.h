@@ -2,17 +2,26 @@
 
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "../helpers.h"
 
 enum token_type
 {
     TOKEN_IDENTIFIER, TOKEN_CONSTANT, TOKEN_EOF, TOKEN_NOT_KEYWORD,
+    TOKEN_ERROR,
 
     // types
-    TOKEN_INT, TOKEN_VOID, TOKEN_CHAR,
+    TOKEN_INT, TOKEN_VOID, TOKEN_CHAR, TOKEN_SHORT, TOKEN_LONG,
+    TOKEN_FLOAT, TOKEN_DOUBLE, TOKEN_SIGNED, TOKEN_UNSIGNED,
+    TOKEN_BOOL, TOKEN_COMPLEX, TOKEN_IMAGINARY,
 
     // keywords
-    TOKEN_RETURN,
+    TOKEN_RETURN, TOKEN_AUTO, TOKEN_BREAK, TOKEN_CASE, TOKEN_CONST,
+    TOKEN_CONTINUE, TOKEN_DEFAULT, TOKEN_DO, TOKEN_ELSE, TOKEN_ENUM,
+    TOKEN_EXTERN, TOKEN_FOR, TOKEN_GOTO, TOKEN_IF, TOKEN_INLINE,
+    TOKEN_REGISTER, TOKEN_RESTRICT, TOKEN_SIZEOF, TOKEN_STATIC,
+    TOKEN_STRUCT, TOKEN_SWITCH, TOKEN_TYPEDEF, TOKEN_UNION,
+    TOKEN_VOLATILE, TOKEN_WHILE,
 
     // symbols
     TOKEN_OPEN_PARENTHESIS, TOKEN_CLOSE_PARENTHESIS,
@@ -32,19 +41,73 @@ enum token_type
     TOKEN_EQUAL, TOKEN_PLUS_EQUAL, TOKEN_MINUS_EQUAL,
     TOKEN_STAR_EQUAL, TOKEN_SLASH_EQUAL, TOKEN_PERCENT_EQUAL,
     TOKEN_LT_LT_EQUAL, TOKEN_GT_GT_EQUAL, TOKEN_AND_EQUAL,
-    TOKEN_CARET_EQUAL, TOKEN_PIPE_EQUAL
+    TOKEN_CARET_EQUAL, TOKEN_PIPE_EQUAL,
+
+    TOKEN_TYPE_COUNT
+};
+
+/**
+ * Integer constants are parsed by the lexer. The types follow C11 6.4.4.1
+ * on an LP64 target and are laid out as signed/unsigned pairs.
+ */
+enum constant_type
+{
+    CONSTANT_INT, CONSTANT_UNSIGNED,
+    CONSTANT_LONG, CONSTANT_UNSIGNED_LONG,
+    CONSTANT_LONG_LONG, CONSTANT_UNSIGNED_LONG_LONG,
 };
 
+struct constant
+{
+    uint64_t value;     // two's complement, sign extended for signed types
+    enum constant_type type;
+};
+
+/**
+ * A token is a view into the source buffer: `value` points at the first
+ * character of the token and is NOT null terminated, so always print it
+ * with "%.*s" and `length`. Tokens own no memory.
+ *
+ * This is the unpacked form handed out to the parser; the lexer itself
+ * only keeps kind, offset and payload (see struct token_store).
+ */
 struct token
 {
     enum token_type type;
-    char* value;
-    bool allocated;
-    int line;
+    const char* value;
+    int length;
+    uint32_t offset;    // byte offset in the source, see source_line()
+    struct constant constant;   // value of a TOKEN_CONSTANT
+    int symbol;         // interned id of a TOKEN_IDENTIFIER (see intern.h)
+};
+
+/**
+ * Packed token stream, one array per field. Every token is a one byte
+ * kind, the source offset of its first character and a payload holding
+ * the symbol id of an identifier or the index of a constant in
+ * `constants` (most tokens are not constants, so values are kept out of
+ * line). Length and
+ * line are not stored: the length is cheap to rescan from the offset
+ * (token_view() in lexer.h) and lines are only needed for diagnostics.
+ */
+struct token_store
+{
+    uint8_t *kinds;         /* enum token_type */
+    uint32_t *offsets;
+    uint32_t *payloads;
+    int count;
+    int _capacity;
+
+    struct constant *constants;
+    int constant_count;
+    int _constant_capacity;
 };
 
-void token_insert(struct m_vector* vec, struct token data);
-enum token_type token_get_keyword(const char *str);
-struct token token_at(struct m_vector *vec, int pos);
-void token_cleanup(struct m_vector *tokens);
+struct token_store *token_store_init(void);
+void token_store_push(struct token_store *store, enum token_type kind, uint32_t offset, uint32_t payload);
+void token_store_push_constant(struct token_store *store, uint32_t offset, struct constant constant);
+/** append the tokens of `from` starting at index first */
+void token_store_append(struct token_store *store, struct token_store *from, int first);
+void token_store_free(struct token_store *store);
 
+enum token_type token_get_keyword(const char *str, int length);
@@ -1,101 +1,157 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
-#include "lexer/token.h"
+#include "compilation.h"
 #include "parser/nodes.h"
 #include "helpers.h"
-
-// from lexer/lexer.c
-struct m_vector *lexer(const char *content);
+#include "output.h"
+#include "ir.h"
 
 // from parser/parser.c
-void parser_cleanup(struct program *p);
-struct program *parse(struct m_vector *tokens);
+struct program *parse(struct lexer *lex, struct arena *arena, const char **roots);
 
-// from target_arm.c
-const char* arm_compile(struct program *p);
-
-char* read_file(const char *c_file) {
-    FILE *fptr = fopen(c_file, "r");
-    char buffer[100];
-    memset(buffer, 0, 100);
-
-    char *result = (char *) malloc(100);
-    int capacity = 100;
-    int size = 0;
-
-    while (fgets(buffer, 100, fptr)) {
-        int bytes = strlen(buffer);
-
-        while (size + bytes >= capacity) {
-            char *newaddr = (char*) malloc(capacity + 100);
-            memcpy(newaddr, result, capacity);
-            capacity += 100;
-            free(result);
-            result = newaddr;
-        }
+// from fold.c
+void fold_program(struct program *p, struct arena *scratch);
 
-        memcpy(result + size, buffer, bytes);
-        size += bytes;
-        memset(buffer, 0, 100);
-    }
+// from target_arm.c
+bool arm_compile(const struct ir_module *m, struct arena *scratch, struct output *out);
 
-    result[size] = '\0';
-    fclose(fptr);
-    return result;
+static void usage(void) {
+    fprintf(stderr, "usage: comp [-o <output.s> | -o -] [--lazy] [--root <function>]... [--parallel] [--emit-ir] [-O0] <file.c>\n");
 }
 
 int main(int argc, char** argv)
 {
-    // get c file from arguments
+    // get c file and output path from arguments
+    const char* c_file = NULL;
+    const char* output_path = "./sample/output.s";
+
+    // --lazy only compiles functions reachable from main, the functions
+    // that aren't static and every --root (which implies --lazy)
+    bool lazy = false;
+    const char *roots[argc];     // NULL terminated
+    int root_count = 0;
+
+    // --parallel lexes the whole input up front and parses the function
+    // bodies on all CPUs, at the cost of keeping every token in memory
+    bool parallel = false;
+
+    // --emit-ir writes the intermediate representation instead of assembly
+    bool emit_ir = false;
+
+    // -O0 lowers the IR as it was built, without the SSA optimizations
+    bool optimize = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--root") == 0) {
+            if (i + 1 == argc) {
+                usage();
+                return EXIT_FAILURE;
+            }
+            if (argv[i][1] == 'o') {
+                output_path = argv[++i];
+            } else {
+                roots[root_count++] = argv[++i];
+                lazy = true;
+            }
+        } else if (strcmp(argv[i], "--lazy") == 0) {
+            lazy = true;
+        } else if (strcmp(argv[i], "--parallel") == 0) {
+            parallel = true;
+        } else if (strcmp(argv[i], "--emit-ir") == 0) {
+            emit_ir = true;
+        } else if (strcmp(argv[i], "-O0") == 0) {
+            optimize = false;
+        } else {
+            c_file = argv[i];
+        }
+    }
+    roots[root_count] = NULL;
+
 #ifndef DEBUG
-    if (argc < 2)
+    if (c_file == NULL)
     {
-        std::cerr << "You need to provide a c path." << std::endl;
+        fprintf(stderr, "You need to provide a c path.\n");
+        usage();
         return EXIT_FAILURE;
     }
-    const char* c_file = argv[argc - 1];
 #else
-    const char* c_file = argc < 2 ? "./sample/main.c" : argv[argc - 1];
+    if (c_file == NULL) c_file = "./sample/main.c";
 #endif
 
     int exit_signal = EXIT_SUCCESS;
-    const char* assembly;
     struct program *p;
 
-    // read c file
-    char* content = read_file(c_file);
+    // load c file
+    struct compilation c;
+    if (!compilation_open(&c, c_file)) return EXIT_FAILURE;
 
-    // pass it to the lexer
-    struct m_vector *tokens = lexer(content);
-    if (tokens == NULL) {
+    if (parallel && !lexer_tokenize_all(&c.lex)) {
         exit_signal = EXIT_FAILURE;
-        goto file_cleanup;
+        goto cleanup;
     }
 
-    // parse the tokens
-    p = parse(tokens);
+    p = parse(&c.lex, c.arena, lazy ? roots : NULL);
+    compilation_report(&c, "parse");
     if (p == NULL) {
         exit_signal = EXIT_FAILURE;
-        goto lexer_cleanup;
+        goto cleanup;
+    }
+
+    // evaluate what is known at compile time
+    fold_program(p, c.scratch);
+
+    struct ir_module *m = ir_build(p, c.scratch);
+    if (m == NULL || !ir_verify(m)) {
+        exit_signal = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    if (optimize) {
+        ir_optimize(m, c.scratch);
+        compilation_report(&c, "optimize");
+        if (!ir_verify(m)) {
+            exit_signal = EXIT_FAILURE;
+            goto cleanup;
+        }
+    }
+
+    // the assembly is written out as it is generated, "-" is stdout
+    const bool to_stdout = strcmp(output_path, "-") == 0;
+    int fd = to_stdout ? STDOUT_FILENO : open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Unable to open %s: %s\n", output_path, strerror(errno));
+        exit_signal = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    struct output out;
+    output_init_fd(&out, fd);
+
+    // convert program to assembly, or just write out the IR
+    bool compiled = true;
+    if (emit_ir) ir_dump(m, &out);
+    else compiled = arm_compile(m, c.scratch, &out);
+
+    if (!compiled) {
+        exit_signal = EXIT_FAILURE;
+    } else if (!output_flush(&out)) {
+        fprintf(stderr, "Unable to write %s: %s\n", output_path, strerror(errno));
+        exit_signal = EXIT_FAILURE;
+    }
+    compilation_report(&c, "compile");
+
+    output_free(&out);
+    if (!to_stdout) {
+        close(fd);
+        // don't leave half an assembly file behind
+        if (exit_signal != EXIT_SUCCESS) unlink(output_path);
     }
 
-    // convert program to assembly
-    assembly = arm_compile(p);
-    if (assembly == NULL) goto parser_clean;
-    
-    // write assembly to file
-    FILE *fptr = fopen("./sample/output.s", "w");
-    fputs(assembly, fptr);
-    fclose(fptr);
-
-    // cleanup process
-    free((void*) assembly);
-
-parser_clean:
-    parser_cleanup(p);
-lexer_cleanup:
-    token_cleanup(tokens);
-file_cleanup:
-    free(content);
+cleanup:
+    compilation_close(&c);
     return exit_signal;
 }
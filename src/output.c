@@ -0,0 +1,89 @@
+#include "output.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void output_alloc(struct output *out, size_t capacity, int fd) {
+    out->_capacity = capacity;
+    out->data = (char*) malloc(out->_capacity);
+    out->data[0] = '\0';
+    out->size = 0;
+    out->fd = fd;
+    out->error = false;
+}
+
+void output_init(struct output *out) {
+    output_alloc(out, 4096, -1);
+}
+
+void output_init_fd(struct output *out, int fd) {
+    output_alloc(out, OUTPUT_BLOCK_SIZE, fd);
+}
+
+void output_free(struct output *out) {
+    free(out->data);
+    out->data = NULL;
+}
+
+bool output_flush(struct output *out) {
+    if (out->fd < 0) return !out->error;
+
+    for (size_t written = 0; written < out->size && !out->error; ) {
+        ssize_t bytes = write(out->fd, out->data + written, out->size - written);
+        if (bytes < 0) {
+            if (errno == EINTR) continue;
+            out->error = true;
+        } else {
+            written += bytes;
+        }
+    }
+
+    // on errors the rest of the output is dropped, callers check at the end
+    out->size = 0;
+    out->data[0] = '\0';
+    return !out->error;
+}
+
+void output_reserve(struct output *out, size_t extra) {
+    if (out->fd >= 0) {
+        output_flush(out);
+        if (extra < out->_capacity) return;
+    }
+
+    size_t capacity = out->_capacity;
+    while (out->size + extra >= capacity)
+        capacity *= 2;
+    if (capacity == out->_capacity) return;
+
+    char *data = (char*) realloc(out->data, capacity);
+    if (data == NULL) {
+        fprintf(stderr, "Out of memory growing the output to %zu bytes\n", capacity);
+        exit(EXIT_FAILURE);
+    }
+    out->data = data;
+    out->_capacity = capacity;
+}
+
+void output_uint(struct output *out, uint64_t value) {
+    // digits are produced backwards into a scratch buffer, 20 is enough for 2^64-1
+    char digits[20];
+    int i = sizeof(digits);
+    do {
+        digits[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    output_append(out, digits + i, sizeof(digits) - i);
+}
+
+void output_int(struct output *out, int64_t value) {
+    if (value < 0) {
+        output_literal(out, "-");
+        // negate as unsigned so INT64_MIN doesn't overflow
+        output_uint(out, -(uint64_t) value);
+    } else {
+        output_uint(out, (uint64_t) value);
+    }
+}
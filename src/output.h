@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** buffer size of an output that streams to a file */
+#define OUTPUT_BLOCK_SIZE (256 << 10)
+
+/**
+ * Text buffer the backend writes assembly into. Numbers are formatted
+ * straight into the buffer without temporary strings.
+ *
+ * An in-memory output doubles its capacity when full so appending n bytes
+ * costs O(n) overall. An output with a file descriptor never grows past
+ * OUTPUT_BLOCK_SIZE (unless a single append is bigger): a full buffer is
+ * written out instead, and output_flush() writes what is left.
+ */
+struct output {
+    char *data;     // always '\0' terminated
+    size_t size;
+    size_t _capacity;
+
+    int fd;         // -1 keeps everything in memory
+    bool error;     // a write failed, errno tells why
+};
+
+/** an output that keeps everything in `data` */
+void output_init(struct output *out);
+
+/** an output that streams to fd, which the caller opens and closes */
+void output_init_fd(struct output *out, int fd);
+void output_free(struct output *out);
+
+/**
+ * Write everything buffered to the file (nothing to do in memory).
+ * Returns false if this or an earlier write failed.
+ */
+bool output_flush(struct output *out);
+
+/** make room for `extra` more bytes plus the terminator */
+void output_reserve(struct output *out, size_t extra);
+
+static inline void output_append(struct output *out, const char *text, size_t size) {
+    if (out->size + size >= out->_capacity)
+        output_reserve(out, size);
+    memcpy(out->data + out->size, text, size);
+    out->size += size;
+    out->data[out->size] = '\0';
+}
+
+/** append a string literal, its length is known at compile time */
+#define output_literal(out, text) output_append(out, text, sizeof(text) - 1)
+
+/** decimal representation of value */
+void output_int(struct output *out, int64_t value);
+void output_uint(struct output *out, uint64_t value);
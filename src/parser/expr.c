@@ -1,496 +1,370 @@
 #include "nodes.h"
 #include "parser.h"
 #include <stdlib.h>
+#include <string.h>
 
-void cleanupExpression(struct Expr *expr) {
-    switch (expr->type) {
-        case EXPR_UNARY_OPERATION:
-            cleanupExpression(expr->obj.unary.value);
-            free(expr);
-            break;
-
-        case EXPR_PRIMARY:
-            free(expr);
-            break;
-
-        case EXPR_BINARY_OPERATION:
-            cleanupExpression(expr->obj.binary.left);
-            cleanupExpression(expr->obj.binary.right);
-            free(expr);
-            break;
-
-        case EXPR_TERNARY_OPERATION:
-            cleanupExpression(expr->obj.ternary.condition);
-            cleanupExpression(expr->obj.ternary.left);
-            cleanupExpression(expr->obj.ternary.right);
-            free(expr);
-            break;
-
-        case EXPR_ASSIGNMENT:
-            cleanupExpression(expr->obj.assignment.right);
-            free(expr);
-            break;
-    }
+VECTOR_DEFINE(expr, struct Expr)
+
+/** append a node to the AST of the current declaration, after its children */
+static expr_id new_expr(struct global_vars *vars, struct Expr node) {
+    expr_insert(vars->nodes, node);
+    return vars->nodes->_size - 1;
 }
 
 /**
  * Grammar for expressions:
- * expression      → precedence14 ;
- * precedence14    → IDENTIFIER ( "=" | "+=" | "-=" | "*=" | "/=" | "%=" | "<<=" | ">>=" | "&=" | "^=" | "|=" ) precedence13
- *                 | precedence13 ;
- * precedence13    → precedence12 ( "?" precedence12 ":" precedence12 )* ;
- * precedence12    → precedence11 ( "||" precedence11 )* ;
- * precedence11    → precedence10 ( "&&" precedence10 )* ;
- * precedence10    → precedence9 ( "|" precedence9 )* ;
- * precedence9     → precedence8 ( "^" precedence8 )* ;
- * precedence8     → precedence7 ( "&" precedence7 )* ;
- * precedence7     → precedence6 ( ( "!=" | "==" ) precedence6 )* ;
- * precedence6     → precedence5 ( ( ">" | ">=" | "<" | "<=" ) precedence5 )* ;
- * precedence5     → precedence4 ( ( "<<" | ">>" ) precedence4 )* ;
- * precedence4     → precedence3 ( ( "+" | "-" ) precedence3 )* ;
- * precedence3     → precedence2 ( ( "/" | "*" | "%" ) precedence2 )* ;
- * precedence2     → ("++" | "--" | "+" | "-" | "!" | "~" ) precedence2
- *                 | precedence1 ;
- * precedence1     → primary ("--" | "++")* ;
+ * expression      → IDENTIFIER ( "=" | "+=" | "-=" | "*=" | "/=" | "%=" | "<<=" | ">>=" | "&=" | "^=" | "|=" ) conditional
+ *                 | conditional ;
+ * conditional     → binary ( "?" binary ":" binary )* ;
+ * binary          → unary ( BINARY_OPERATOR unary )* ;
+ * unary           → ("++" | "--" | "+" | "-" | "!" | "~" ) unary
+ *                 | postfix ;
+ * postfix         → primary ("--" | "++")* ;
  * primary         → NUMBER | CHAR | STRING | IDENTIFIER | "(" expression ")" ;
+ *
+ * The parser doesn't recurse: finished subtrees wait on an operand stack
+ * and everything still missing operands (operators, open parentheses,
+ * half parsed conditionals) on a stack of pending nodes, so nesting depth
+ * is only limited by memory. Binary operators are reduced by precedence
+ * climbing over the table below; every level is left associative.
+ * Nodes are only created once their operands are complete, which keeps
+ * the node array in post order.
  */
 
-static struct Expr *parsePrimary(struct global_vars *vars) {
-    struct Expr *result = NULL;
-
-    if (check(TOKEN_CONSTANT, vars) || check(TOKEN_IDENTIFIER, vars)) {
-        result = malloc(sizeof(struct Expr));
-        result->type = EXPR_PRIMARY;
-        result->obj.primary.value = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-        return result;
-    } else if (check(TOKEN_OPEN_PARENTHESIS, vars)) {
-        vars->progress++;
-
-        result = parseExpression(vars);
-        if (result == NULL) return NULL;
-
-        if (check(TOKEN_CLOSE_PARENTHESIS, vars)) {
-            vars->progress++;
-        } else {
-            cleanupExpression(result);
-            fprintf(stderr, "Syntax error on line %d, missing closing parenthesis ')'\n",
-                token_at(vars->tokens, vars->progress).line);
-            return NULL;
-        }
-
-        return result;
-    } else {
-        fprintf(stderr, "Syntax error on line %d, unexpected '%s'\n",
-            token_at(vars->tokens, vars->progress).line,
-            token_at(vars->tokens, vars->progress).value);
-        return NULL;
+/** binding power of binary operators, 0 for tokens that aren't one */
+static const unsigned char binary_precedence[TOKEN_TYPE_COUNT] = {
+    [TOKEN_PIPE_PIPE]           = 1,
+    [TOKEN_AND_AND]             = 2,
+    [TOKEN_PIPE]                = 3,
+    [TOKEN_CARET]               = 4,
+    [TOKEN_AND]                 = 5,
+    [TOKEN_BANG_EQUAL]          = 6,
+    [TOKEN_EQUAL_EQUAL]         = 6,
+    [TOKEN_GREATER_THAN]        = 7,
+    [TOKEN_GREATER_THAN_EQUAL]  = 7,
+    [TOKEN_LESS_THAN]           = 7,
+    [TOKEN_LESS_THAN_EQUAL]     = 7,
+    [TOKEN_LT_LT]               = 8,
+    [TOKEN_GT_GT]               = 8,
+    [TOKEN_PLUS]                = 9,
+    [TOKEN_MINUS]               = 9,
+    [TOKEN_STAR]                = 10,
+    [TOKEN_SLASH]               = 10,
+    [TOKEN_PERCENT]             = 10,
+};
+
+static bool is_prefix_operator(enum token_type type) {
+    switch (type) {
+        case TOKEN_PLUS_PLUS:
+        case TOKEN_MINUS_MINUS:
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+        case TOKEN_BANG:
+        case TOKEN_TILDA:
+            return true;
+        default:
+            return false;
     }
 }
 
-static struct Expr *precedence1(struct global_vars *vars) {
-    struct Expr *primary = parsePrimary(vars);
-    if (primary == NULL) return NULL;
-
-    while (check(TOKEN_MINUS_MINUS, vars) || check(TOKEN_PLUS_PLUS, vars)) {
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_UNARY_OPERATION;
-        result->obj.unary.prefix = token_at(vars->tokens, vars->progress);
-        result->obj.unary.value = primary;
-        vars->progress++;
-
-        primary = result;
+static bool is_assignment_operator(enum token_type type) {
+    switch (type) {
+        case TOKEN_EQUAL:
+        case TOKEN_PLUS_EQUAL:
+        case TOKEN_MINUS_EQUAL:
+        case TOKEN_STAR_EQUAL:
+        case TOKEN_SLASH_EQUAL:
+        case TOKEN_PERCENT_EQUAL:
+        case TOKEN_LT_LT_EQUAL:
+        case TOKEN_GT_GT_EQUAL:
+        case TOKEN_AND_EQUAL:
+        case TOKEN_CARET_EQUAL:
+        case TOKEN_PIPE_EQUAL:
+            return true;
+        default:
+            return false;
     }
-
-    return primary;
 }
 
-static struct Expr *precedence2(struct global_vars *vars) {
-    if (check(TOKEN_MINUS, vars)        ||
-        check(TOKEN_BANG, vars)         ||
-        check(TOKEN_TILDA, vars)        ||
-        check(TOKEN_PLUS_PLUS, vars)    ||
-        check(TOKEN_MINUS_MINUS, vars)  ||
-        check(TOKEN_PLUS, vars))
-    {
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_UNARY_OPERATION;
-        result->obj.unary.prefix = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *value = precedence1(vars);
-        if (result == NULL) {
-            free(result);
-            return NULL;
-        }
-
-        result->obj.unary.value = value;
-        return result;
-    } else {
-        return precedence1(vars);
-    }
+/** a node on the pending stack of parseExpression */
+enum pending_type {
+    PENDING_PREFIX,         // unary operator waiting for its operand
+    PENDING_BINARY,         // binary operator waiting for its right operand
+    PENDING_ASSIGNMENT,     // waiting for the right side
+    PENDING_CONDITION,      // "?" seen, condition set, waiting for ":"
+    PENDING_ELSE,           // ":" seen, waiting for the last operand
+    PENDING_PARENTHESIS,    // "(" waiting for ")"
+};
+
+struct pending {
+    uint8_t type;           // enum pending_type
+    uint8_t precedence;     // PENDING_BINARY only
+    uint8_t operation;      // token kind of the operator
+    uint32_t offset;        // of the operator
+    uint32_t value;         // assigned symbol, or the condition of a conditional
+    expr_id left;           // middle operand of PENDING_ELSE
+};
+
+VECTOR_DEFINE(pending, struct pending)
+VECTOR_DEFINE(operand, expr_id)
+
+void initExpressionParser(struct global_vars *vars) {
+    vars->nodes = vector_init(sizeof(struct Expr));
+    vars->operands = vector_init(sizeof(expr_id));
+    vars->pending = vector_init(sizeof(struct pending));
 }
 
-static struct Expr *precedence3(struct global_vars *vars) {
-    struct Expr *left = precedence2(vars);
-    if (left == NULL) return NULL;
-
-    while ( check(TOKEN_SLASH, vars)    ||
-            check(TOKEN_STAR, vars)     ||
-            check(TOKEN_PERCENT, vars))
-    {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence2(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
-    }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+void cleanupExpressionParser(struct global_vars *vars) {
+    vector_free(vars->nodes);
+    vector_free(vars->operands);
+    vector_free(vars->pending);
 }
 
-static struct Expr *precedence4(struct global_vars *vars) {
-    struct Expr *left = precedence3(vars);
-    if (left == NULL) return NULL;
-
-    while ( check(TOKEN_PLUS, vars)     ||
-            check(TOKEN_MINUS, vars))
-    {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence3(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
-    }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+/** start the AST of a new declaration, the first node is the unused EXPR_NONE */
+void beginAST(struct global_vars *vars) {
+    vars->nodes->_size = 0;
+    new_expr(vars, (struct Expr) { 0 });
 }
 
-static struct Expr *precedence5(struct global_vars *vars) {
-    struct Expr *left = precedence4(vars);
-    if (left == NULL) return NULL;
-
-    while ( check(TOKEN_LT_LT, vars)     ||
-            check(TOKEN_GT_GT, vars))
-    {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
+/** move the finished AST to the arena, in one exactly sized block */
+struct ast endAST(struct global_vars *vars) {
+    const size_t size = vars->nodes->_size * sizeof(struct Expr);
+    struct Expr *nodes = (struct Expr*) arena_alloc(vars->arena, size);
+    memcpy(nodes, vars->nodes->_data, size);
 
-        struct Expr *right = precedence4(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
-    }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+    return (struct ast) {
+        .nodes = nodes,
+        .count = vars->nodes->_size,
+    };
 }
 
-static struct Expr *precedence6(struct global_vars *vars) {
-    struct Expr *left = precedence5(vars);
-    if (left == NULL) return NULL;
-
-    while ( check(TOKEN_GREATER_THAN, vars)         ||
-            check(TOKEN_GREATER_THAN_EQUAL, vars)   ||
-            check(TOKEN_LESS_THAN, vars)            ||
-            check(TOKEN_LESS_THAN_EQUAL, vars))
-    {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence5(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
-    }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+static expr_id pop_operand(struct global_vars *vars) {
+    return operand_at(vars->operands, --vars->operands->_size);
 }
 
-static struct Expr *precedence7(struct global_vars *vars) {
-    struct Expr *left = precedence6(vars);
-    if (left == NULL) return NULL;
-
-    while ( check(TOKEN_BANG_EQUAL, vars)   ||
-            check(TOKEN_EQUAL_EQUAL, vars))
-    {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence6(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
-    }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+static void push_pending(struct global_vars *vars, struct pending p) {
+    pending_insert(vars->pending, p);
 }
 
-static struct Expr *precedence8(struct global_vars *vars) {
-    struct Expr *left = precedence7(vars);
-    if (left == NULL) return NULL;
-
-    while (check(TOKEN_AND, vars)) {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence7(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
-    }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+static struct pending *top_pending(struct global_vars *vars) {
+    if (vars->pending->_size == 0) return NULL;
+    return pending_ref(vars->pending, vars->pending->_size - 1);
 }
 
-static struct Expr *precedence9(struct global_vars *vars) {
-    struct Expr *left = precedence8(vars);
-    if (left == NULL) return NULL;
-
-    while (check(TOKEN_CARET, vars)) {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence8(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
+/** complete pending binary operators that bind at least as tightly as `precedence` */
+static void reduce_binary(struct global_vars *vars, int precedence) {
+    struct pending *top;
+    while ((top = top_pending(vars)) != NULL &&
+           top->type == PENDING_BINARY && top->precedence >= precedence)
+    {
+        const expr_id right = pop_operand(vars);
+        const expr_id left = pop_operand(vars);
+        operand_insert(vars->operands, new_expr(vars, (struct Expr) {
+            .type = EXPR_BINARY_OPERATION,
+            .operation = top->operation,
+            .offset = top->offset,
+            .obj.binary = { left, right },
+        }));
+        vars->pending->_size--;
     }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
 }
 
-static struct Expr *precedence10(struct global_vars *vars) {
-    struct Expr *left = precedence9(vars);
-    if (left == NULL) return NULL;
-
-    while (check(TOKEN_PIPE, vars)) {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence9(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
-    }
-
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+/** complete a conditional on top of the pending stack, if it has all its operands */
+static struct pending *reduce_conditional(struct global_vars *vars) {
+    struct pending *top = top_pending(vars);
+    if (top == NULL || top->type != PENDING_ELSE) return top;
+
+    const expr_id arms = new_expr(vars, (struct Expr) {
+        .type = EXPR_TERNARY_ARMS,
+        .offset = top->offset,
+        .obj.binary = { top->left, pop_operand(vars) },
+    });
+    operand_insert(vars->operands, new_expr(vars, (struct Expr) {
+        .type = EXPR_TERNARY_OPERATION,
+        .operation = TOKEN_QUESTION_MARK,
+        .offset = top->offset,
+        .obj.ternary = { top->value, arms },
+    }));
+    vars->pending->_size--;
+    return top_pending(vars);
 }
 
-static struct Expr *precedence11(struct global_vars *vars) {
-    struct Expr *left = precedence10(vars);
-    if (left == NULL) return NULL;
-
-    while (check(TOKEN_AND_AND, vars)) {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence10(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
+/**
+ * complete the innermost expression, up to an open parenthesis or the
+ * start. Fails on a conditional that is missing its ":".
+ */
+static bool reduce_expression(struct global_vars *vars) {
+    reduce_binary(vars, 1);
 
-        left = result;
+    struct pending *top = reduce_conditional(vars);
+    if (top != NULL && top->type == PENDING_CONDITION) {
+        report_unexpected(vars);
+        return false;
     }
 
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
-}
-
-static struct Expr *precedence12(struct global_vars *vars) {
-    struct Expr *left = precedence11(vars);
-    if (left == NULL) return NULL;
-
-    while (check(TOKEN_PIPE_PIPE, vars)) {
-        struct token operation = token_at(vars->tokens, vars->progress);
-        vars->progress++;
-
-        struct Expr *right = precedence11(vars);
-        if (right == NULL) goto cleanup;
-
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_BINARY_OPERATION;
-        result->obj.binary.left = left;
-        result->obj.binary.right = right;
-        result->obj.binary.operation = operation;
-
-        left = result;
+    if (top != NULL && top->type == PENDING_ASSIGNMENT) {
+        const expr_id right = pop_operand(vars);
+        operand_insert(vars->operands, new_expr(vars, (struct Expr) {
+            .type = EXPR_ASSIGNMENT,
+            .operation = top->operation,
+            .offset = top->offset,
+            .obj.assignment = { top->value, right },
+        }));
+        vars->pending->_size--;
     }
 
-    return left;
-
-cleanup:
-    cleanupExpression(left);
-    return NULL;
+    return true;
 }
 
-static struct Expr *precedence13(struct global_vars *vars) {
-    struct Expr *cond = precedence12(vars);
-    if (cond == NULL) return NULL;
+/** returns the root of the expression in the current AST, EXPR_NONE on errors */
+expr_id parseExpression(struct global_vars *vars) {
+    vars->operands->_size = 0;
+    vars->pending->_size = 0;
+
+    bool expression_start = true;  // an assignment may start here
+    while (true) {
+        // expecting an operand
+        enum token_type kind = peek_kind(vars->lex, 0);
+
+        if (expression_start && kind == TOKEN_IDENTIFIER &&
+            is_assignment_operator(peek_kind(vars->lex, 1)))
+        {
+            const int name = next_token(vars->lex).symbol;
+            struct token operation = next_token(vars->lex);
+            push_pending(vars, (struct pending) {
+                .type = PENDING_ASSIGNMENT,
+                .operation = operation.type,
+                .offset = operation.offset,
+                .value = name,
+            });
+            expression_start = false;
+            continue;
+        }
 
-    while (check(TOKEN_QUESTION_MARK, vars)) {
-        vars->progress++;
+        expression_start = false;
+        if (is_prefix_operator(kind)) {
+            push_pending(vars, (struct pending) {
+                .type = PENDING_PREFIX,
+                .operation = kind,
+                .offset = next_token(vars->lex).offset,
+            });
+            continue;
+        }
 
-        struct Expr *left = precedence12(vars);
-        if (left == NULL) goto cleanup;
+        if (kind == TOKEN_OPEN_PARENTHESIS) {
+            skip_token(vars->lex);
+            push_pending(vars, (struct pending) { .type = PENDING_PARENTHESIS });
+            expression_start = true;
+            continue;
+        }
 
-        if (check(TOKEN_COLON, vars)) {
-            vars->progress++;
-        } else {
-            fprintf(stderr, "Syntax error on line %d, unexpected '%s'\n",
-                token_at(vars->tokens, vars->progress).line,
-                token_at(vars->tokens, vars->progress).value);
-            cleanupExpression(left);
-            goto cleanup;
+        if (kind != TOKEN_CONSTANT && kind != TOKEN_IDENTIFIER) {
+            report_unexpected(vars);
+            return EXPR_NONE;
         }
 
-        struct Expr *right = precedence12(vars);
-        if (left == NULL) {
-            cleanupExpression(left);
-            goto cleanup;
+        struct token value = next_token(vars->lex);
+        if (kind == TOKEN_CONSTANT) {
+            operand_insert(vars->operands, new_expr(vars, (struct Expr) {
+                .type = EXPR_PRIMARY,
+                .operation = TOKEN_CONSTANT,
+                .constant_type = value.constant.type,
+                .offset = value.offset,
+                .obj.constant = value.constant.value,
+            }));
+        } else {
+            operand_insert(vars->operands, new_expr(vars, (struct Expr) {
+                .type = EXPR_PRIMARY,
+                .operation = TOKEN_IDENTIFIER,
+                .offset = value.offset,
+                .obj.symbol = value.symbol,
+            }));
         }
 
-        struct Expr *result = malloc(sizeof(struct Expr));
-        result->type = EXPR_TERNARY_OPERATION;
-        result->obj.ternary.condition = cond;
-        result->obj.ternary.left = left;
-        result->obj.ternary.right = right;
+        // an operand is complete, expecting an operator. Closing a
+        // parenthesis completes another one, so this loops until an
+        // operator asks for the next operand
+        while (true) {
+            // postfix operators bind tightest, then the pending prefixes
+            while ((kind = peek_kind(vars->lex, 0)) == TOKEN_MINUS_MINUS || kind == TOKEN_PLUS_PLUS) {
+                const expr_id operand = pop_operand(vars);
+                operand_insert(vars->operands, new_expr(vars, (struct Expr) {
+                    .type = EXPR_UNARY_OPERATION,
+                    .operation = kind,
+                    .offset = next_token(vars->lex).offset,
+                    .obj.unary.value = operand,
+                }));
+            }
+
+            struct pending *top;
+            while ((top = top_pending(vars)) != NULL && top->type == PENDING_PREFIX) {
+                const expr_id operand = pop_operand(vars);
+                operand_insert(vars->operands, new_expr(vars, (struct Expr) {
+                    .type = EXPR_UNARY_OPERATION,
+                    .operation = top->operation,
+                    .offset = top->offset,
+                    .obj.unary.value = operand,
+                }));
+                vars->pending->_size--;
+            }
+
+            const int precedence = binary_precedence[kind];
+            if (precedence > 0) {
+                reduce_binary(vars, precedence);
+                push_pending(vars, (struct pending) {
+                    .type = PENDING_BINARY,
+                    .precedence = precedence,
+                    .operation = kind,
+                    .offset = next_token(vars->lex).offset,
+                });
+                break;
+            }
+
+            if (kind == TOKEN_QUESTION_MARK) {
+                // the conditional so far becomes the condition of the next
+                // one, but a "?" can't start inside the middle operand
+                reduce_binary(vars, 1);
+                top = reduce_conditional(vars);
+                if (top != NULL && top->type == PENDING_CONDITION) {
+                    report_unexpected(vars);
+                    return EXPR_NONE;
+                }
 
-        cond = result;
-    }
+                push_pending(vars, (struct pending) {
+                    .type = PENDING_CONDITION,
+                    .offset = next_token(vars->lex).offset,
+                    .value = pop_operand(vars),
+                });
+                break;
+            }
+
+            if (kind == TOKEN_COLON) {
+                reduce_binary(vars, 1);
+                top = top_pending(vars);
+                if (top != NULL && top->type == PENDING_CONDITION) {
+                    skip_token(vars->lex);
+                    top->left = pop_operand(vars);
+                    top->type = PENDING_ELSE;
+                    break;
+                }
+            }
 
-    return cond;
+            // anything else ends the innermost parenthesis or the expression
+            if (!reduce_expression(vars)) return EXPR_NONE;
 
-cleanup:
-    cleanupExpression(cond);
-    return NULL;
-}
+            top = top_pending(vars);
+            if (top == NULL)
+                return pop_operand(vars);
 
-static struct Expr *precedence14(struct global_vars *vars) {
-    struct Expr *result = NULL;
-
-    if (token_at(vars->tokens, vars->progress).type ==  TOKEN_IDENTIFIER) {
-        switch (token_at(vars->tokens, vars->progress + 1).type) {
-            case TOKEN_EQUAL:
-            case TOKEN_PLUS_EQUAL:
-            case TOKEN_MINUS_EQUAL:
-            case TOKEN_STAR_EQUAL:
-            case TOKEN_SLASH_EQUAL:
-            case TOKEN_PERCENT_EQUAL:
-            case TOKEN_LT_LT_EQUAL:
-            case TOKEN_GT_GT_EQUAL:
-            case TOKEN_CARET_EQUAL:
-            case TOKEN_PIPE_EQUAL:
-                result = malloc(sizeof(struct Expr));
-                result->type = EXPR_ASSIGNMENT;
-                result->obj.assignment.name = token_at(vars->tokens, vars->progress);
-                vars->progress++;
-                result->obj.assignment.operation = token_at(vars->tokens, vars->progress);
-                vars->progress++;
-                result->obj.assignment.right = precedence13(vars);
-                if (result->obj.assignment.right == NULL) {
-                    free(result);
-                    return NULL;
-                }
-                return result;
+            if (kind != TOKEN_CLOSE_PARENTHESIS) {
+                if (kind != TOKEN_ERROR)
+                    report_error(vars, "Syntax error on line %d, missing closing parenthesis ')'\n",
+                        source_line(vars->lex->src, peek_token(vars->lex, 0).offset));
+                return EXPR_NONE;
+            }
 
-            default:
-                return precedence13(vars);
+            skip_token(vars->lex);
+            vars->pending->_size--;
         }
-
-    } else return precedence13(vars);
-}
-
-struct Expr *parseExpression(struct global_vars *vars) {
-    return precedence14(vars);
+    }
 }
@@ -17,55 +17,80 @@ enum expr_type {
     EXPR_UNARY_OPERATION,
     EXPR_BINARY_OPERATION,
     EXPR_TERNARY_OPERATION,
+    EXPR_TERNARY_ARMS,      // both results of a ternary, only referenced by it
 };
 
+/** index of a node in its struct ast, 0 is never a node */
+typedef uint32_t expr_id;
+#define EXPR_NONE 0
+
+/**
+ * Expression nodes are 16 bytes and hold no pointers: children are
+ * indices into the same node array, operators are token kinds, names are
+ * interned symbol ids (see intern.h) and `offset` points back into the
+ * source for diagnostics and spellings (token_view() in lexer.h).
+ */
 struct Expr
 {
-    enum expr_type type;
+    uint8_t type;               // enum expr_type
+    uint8_t operation;          // enum token_type of the operator, or CONSTANT/IDENTIFIER
+    uint16_t constant_type;     // enum constant_type of a constant
+    uint32_t offset;            // of the operator or literal
 
     union {
         struct {
-            struct token name;
-            struct token operation;
-            struct Expr *right;
+            int name;           // symbol id
+            expr_id right;
         } assignment;
 
         struct {
-            struct token prefix;    // prefix or postfix
-            struct Expr* value;
-        } unary;                // unary
+            expr_id value;
+        } unary;                // prefix or postfix
 
         struct {
-            struct Expr *condition;
-            struct Expr *left;
-            struct Expr *right;
+            expr_id condition;
+            expr_id arms;       // EXPR_TERNARY_ARMS, its left and right are the results
         } ternary;
 
         struct {
-            struct token value;
-        } primary;              // single
+            expr_id left;
+            expr_id right;
+        } binary;               // also EXPR_TERNARY_ARMS
 
-        struct {
-            struct Expr *left;
-            struct token operation;
-            struct Expr *right;
-        } binary;               // binary
+        uint64_t constant;      // value of a TOKEN_CONSTANT primary
+        int symbol;             // symbol id of a TOKEN_IDENTIFIER primary
     } obj;
 };
 
+_Static_assert(sizeof(struct Expr) == 16, "expression nodes should stay 16 bytes");
+
+/**
+ * The expressions of one declaration. Nodes are stored in post order, so
+ * children always come before their parents, and the whole tree is one
+ * block that can be copied or written out as is.
+ */
+struct ast
+{
+    struct Expr *nodes;         // nodes[0] is unused
+    uint32_t count;
+};
+
+static inline const struct Expr *ast_node(const struct ast *ast, expr_id id) {
+    return &ast->nodes[id];
+}
+
 /** return <expr>; */
 struct Return
 {
-    struct Expr *value;
+    expr_id value;
 };
 
 /** <datatype> variable_name = <expr> */
 struct variable_decl
 {
     enum datatype type;
-    struct Expr *value;
-    const char* name;
-    int line;
+    expr_id value;
+    struct token name;
 };
 
 /* statement start */
@@ -81,18 +106,18 @@ struct statement
     union {
         struct Return ret;
         struct variable_decl var;
-        struct Expr *expr;
+        expr_id expr;
     } obj;
 };
 
-void statement_insert(struct m_vector* vec, struct statement data);
-struct statement statement_at(struct m_vector *vec, int pos);
+VECTOR_DEFINE(statement, struct statement)
 /* statement end */
 
 struct function
 {
     enum datatype type;
-    const char* name;
+    struct token name;
+    bool is_static;     // not visible outside the file
     struct m_vector *statements; //: struct statement
 };
 
@@ -105,18 +130,19 @@ enum declaration_type {
 struct declaration
 {
     enum declaration_type type;
+    struct ast ast;     // every expression in the declaration
     union {
         struct function func;
         struct variable_decl var;
     } obj;
 };
 
-void declaration_insert(struct m_vector* vec, struct declaration data);
-struct declaration declaration_at(struct m_vector *vec, int pos);
+VECTOR_DEFINE(declaration, struct declaration)
 /* declarations end */
 
 struct program
 {
     struct m_vector *declarations;     //: struct declaration
+    struct source *source;             // tokens point into it, lines for diagnostics
 };
 /** AST nodes definitions end **/
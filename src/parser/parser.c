@@ -1,14 +1,48 @@
 #include "nodes.h"
 #include "parser.h"
+#include "../pool.h"
+#include "../lexer/intern.h"
+#include <stdarg.h>
 
 // checkes whether the token at the current position matches 
 // the expected type
 bool check(enum token_type expected, struct global_vars *vars) {
     return (
-        expected == token_at(vars->tokens, vars->progress).type
+        expected == peek_kind(vars->lex, 0)
     );
 }
 
+// prints a parse error, or keeps it for later in parse_deferred().
+// Parsing stops at the first error, so one is enough
+void report_error(struct global_vars *vars, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    if (!vars->defer_errors) {
+        vfprintf(stderr, format, args);
+    } else if (vars->error == NULL) {
+        va_list measure;
+        va_copy(measure, args);
+        const int length = vsnprintf(NULL, 0, format, measure);
+        va_end(measure);
+
+        vars->error = (char*) arena_alloc(vars->arena, length + 1);
+        vsnprintf(vars->error, length + 1, format, args);
+    }
+
+    va_end(args);
+}
+
+// reports the token at the current position as unexpected. Lexical
+// errors have been reported by the lexer already
+void report_unexpected(struct global_vars *vars) {
+    struct token t = peek_token(vars->lex, 0);
+    if (t.type == TOKEN_ERROR) return;
+
+    report_error(vars, "Syntax error on line %d, unexpected '%.*s'\n",
+        source_line(vars->lex->src, t.offset), t.length, t.value);
+}
+
 /****
  * parse the current token for the data type
  * type :: "void" | "int" | "char"
@@ -17,8 +51,8 @@ static enum datatype parseDataType(struct global_vars *vars)
 {
     if (check(TOKEN_INT, vars) || check(TOKEN_VOID, vars) || check(TOKEN_CHAR, vars)) {
         enum datatype type = token_to_datatype(
-            token_at(vars->tokens, vars->progress).type);
-        vars->progress++;
+            peek_kind(vars->lex, 0));
+        skip_token(vars->lex);
 
         return type;
     }
@@ -31,30 +65,32 @@ static enum datatype parseDataType(struct global_vars *vars)
  */
 static struct m_vector *parseStatements(struct global_vars *vars) /* Statement */
 {
-    struct m_vector *statements = vector_init(sizeof(struct statement));
+    struct m_vector *statements = vector_init_arena(vars->arena, sizeof(struct statement));
 
     while (!check(TOKEN_CLOSE_BRACE, vars))
     {
         /* return :: "return " (CONSTANT | IDENTIFIER) ";" */
         if (check(TOKEN_RETURN, vars)) {
-            vars->progress++;
+            skip_token(vars->lex);
             
-            struct Expr *expr = parseExpression(vars);
+            expr_id expr = parseExpression(vars);
+            if (expr == EXPR_NONE) goto cleanup;
 
             statement_insert(statements, (struct statement) {
                 .type = STATEMENT_RETURN,
                 .obj.ret.value = expr,
             });
 
-            if (check(TOKEN_SEMICOLON, vars)) vars->progress++;
+            if (check(TOKEN_SEMICOLON, vars)) skip_token(vars->lex);
             else goto syntax_error;
         } else {
             // get variable declaration data type
             enum datatype type = parseDataType(vars);
             if (type == DATATYPE_ERR) {
-                struct Expr *expr = parseExpression(vars);
+                expr_id expr = parseExpression(vars);
+                if (expr == EXPR_NONE) goto cleanup;
 
-                if (check(TOKEN_SEMICOLON, vars)) vars->progress++;
+                if (check(TOKEN_SEMICOLON, vars)) skip_token(vars->lex);
                 else goto syntax_error;
 
                 statement_insert(statements, (struct statement) {
@@ -67,57 +103,95 @@ static struct m_vector *parseStatements(struct global_vars *vars) /* Statement *
                 // get variable declaration identifier (variable name)
                 struct token identifier;
                 if (check(TOKEN_IDENTIFIER, vars)) {
-                    identifier = token_at(vars->tokens, vars->progress);
-                    vars->progress++;
+                    identifier = next_token(vars->lex);
                 } else goto syntax_error;
 
                 // '='
-                if (check(TOKEN_EQUAL, vars)) vars->progress++;
+                if (check(TOKEN_EQUAL, vars)) skip_token(vars->lex);
                 else goto syntax_error;
 
                 // get constant to store the variable name in 
-                struct Expr *expr = parseExpression(vars);
+                expr_id expr = parseExpression(vars);
+                if (expr == EXPR_NONE) goto cleanup;
 
-                if (check(TOKEN_SEMICOLON, vars)) vars->progress++;
+                if (check(TOKEN_SEMICOLON, vars)) skip_token(vars->lex);
                 else goto syntax_error;
 
                 statement_insert(statements, (struct statement) {
                     .type = STATEMENT_VARIABLE_DECL,
                     .obj.var = {
-                        .name = identifier.value,
+                        .name = identifier,
                         .type = type,
                         .value = expr,
-                        .line = identifier.line,
                     }
                 });
             }
         }
     }
 
+    vector_shrink(statements);
     return statements;
 
 syntax_error:
-    fprintf(stderr, "Syntax error on line %d, unexpected '%s'\n",
-        token_at(vars->tokens, vars->progress).line,
-        token_at(vars->tokens, vars->progress).value);
+    report_unexpected(vars);
 
 cleanup:
-    // cleanup statements vector
-    vector_free(statements);
+    // the statements are left in the arena
     return NULL;
 }
 
+/** a top level function body, parsed apart from the rest (see parse_deferred) */
+struct body {
+    int open;           // token index of the "{"
+    int close;          // and of its "}"
+    int declaration;    // index of the function in the declarations
+
+    // results
+    struct m_vector *statements;    //: struct statement, NULL on errors
+    struct ast ast;
+    char *error;
+};
+
+VECTOR_DEFINE(body, struct body)
+
+// leaves the body of a function for later, the lexer is left at its
+// closing brace. The header pass only gets past top level braces here,
+// so the next body found by the pre-pass has to open at the "{" just
+// read; if it doesn't the two disagree and false tells the caller to
+// give up on skipping (see parse())
+static bool skip_body(struct global_vars *vars, int declaration) {
+    const int open = vars->lex->position - 1;
+    if (vars->next_body >= vars->bodies->_size || body_ref(vars->bodies, vars->next_body)->open != open) {
+        vars->bodies_mismatch = true;
+        return false;
+    }
+
+    struct body *body = body_ref(vars->bodies, vars->next_body++);
+    body->declaration = declaration;
+    vars->lex->position = body->close;
+    return true;
+}
+
 /****
  * function_declaration
- * :: <type> IDENTIFIER "(void){" <statement>* "}"
+ * :: ["static"] <type> IDENTIFIER "(void){" <statement>* "}"
  * :: Function ( type = <type>, name = IDENTIFIER, body = [ <statement>* ] )
  */
 static struct m_vector *parseDeclarations(struct global_vars *vars)
 {
-    struct m_vector *declarations = vector_init(sizeof(struct declaration));
+    struct m_vector *declarations = vector_init_arena(vars->arena, sizeof(struct declaration));
 
     while (!check(TOKEN_EOF, vars))
     {
+        beginAST(vars);
+
+        // optional storage class, only functions make use of it
+        bool is_static = false;
+        if (check(TOKEN_STATIC, vars)) {
+            skip_token(vars->lex);
+            is_static = true;
+        }
+
         // get datatype of the declaration
         enum datatype type = parseDataType(vars);
         if (type == DATATYPE_ERR) goto cleanup;
@@ -125,56 +199,65 @@ static struct m_vector *parseDeclarations(struct global_vars *vars)
         // get declaration name/identifier
         struct token identifier;
         if (check(TOKEN_IDENTIFIER, vars)) {
-            identifier = token_at(vars->tokens, vars->progress);
-            vars->progress++;
+            identifier = next_token(vars->lex);
         } else goto syntax_error;
 
         if (check(TOKEN_OPEN_PARENTHESIS, vars)) {
-            vars->progress++;
+            skip_token(vars->lex);
             // function declaration
             // (void){
-            if (check(TOKEN_VOID, vars)) vars->progress++;      // optional `void`
-            if (check(TOKEN_CLOSE_PARENTHESIS, vars)) vars->progress++;
+            if (check(TOKEN_VOID, vars)) skip_token(vars->lex);      // optional `void`
+            if (check(TOKEN_CLOSE_PARENTHESIS, vars)) skip_token(vars->lex);
             else goto syntax_error;
-            if (check(TOKEN_OPEN_BRACE, vars)) vars->progress++;
+            if (check(TOKEN_OPEN_BRACE, vars)) skip_token(vars->lex);
             else goto syntax_error;
 
-            // parse all statements inside the function
-            struct m_vector *stmts = parseStatements(vars);
-            if (stmts == NULL) goto cleanup;
+            // parse all statements inside the function, unless that is
+            // left for later (see parse_deferred)
+            struct m_vector *stmts = NULL;
+            if (vars->bodies != NULL) {
+                if (!skip_body(vars, declarations->_size)) goto cleanup;
+            } else {
+                stmts = parseStatements(vars);
+                if (stmts == NULL) goto cleanup;
+            }
 
             // }
-            if (check(TOKEN_CLOSE_BRACE, vars)) vars->progress++;
+            if (check(TOKEN_CLOSE_BRACE, vars)) skip_token(vars->lex);
             else goto syntax_error;
 
             declaration_insert(declarations, (struct declaration) {
                 .type = DECLARATION_FUNCTION,
+                .ast = endAST(vars),
                 .obj = {
                     .func = {
-                        .name = identifier.value,
+                        .name = identifier,
                         .type = type,
+                        .is_static = is_static,
                         .statements = stmts,
                     }
                 }
             });
         } else if (check(TOKEN_EQUAL, vars)) {
             // variable declaration
-            vars->progress++;
+            skip_token(vars->lex);
 
             // get number after `=`
-            struct Expr *expr = parseExpression(vars);
+            expr_id expr = parseExpression(vars);
+            if (expr == EXPR_NONE) goto cleanup;
 
             // check for semicolon
-            if (check(TOKEN_SEMICOLON, vars)) vars->progress++;
+            if (check(TOKEN_SEMICOLON, vars)) skip_token(vars->lex);
             else goto syntax_error;
 
             declaration_insert(declarations, (struct declaration) {
                 .type = DECLARATION_VARIABLE,
+                .ast = endAST(vars),
                 .obj = {
                     .var = {
                         .type = type,
                         .value = expr,
-                        .name = identifier.value,
+                        .name = identifier,
                     }
                 }
             });
@@ -182,79 +265,309 @@ static struct m_vector *parseDeclarations(struct global_vars *vars)
         } else goto syntax_error;
     }
 
+    vector_shrink(declarations);
     return declarations;
 
 syntax_error:
-    fprintf(stderr, "Syntax error on line %d, unexpected '%s'\n",
-        token_at(vars->tokens, vars->progress).line,
-        token_at(vars->tokens, vars->progress).value);
+    report_unexpected(vars);
 
 cleanup:
-    vector_free(declarations);
     return NULL;
 }
 
-/****
- *  program ::  <declaration>*  :: Program( declarations = [ <declaration>* ] )
+/**
+ * Token ranges of every top level "{...}" in the token store, found by
+ * counting braces. Returns NULL if they don't balance; the sequential
+ * parser then reports the error where it finds it.
  */
-struct program *parse(struct m_vector *tokens) {
+static struct m_vector *match_braces(struct token_store *tokens, int position) {
+    struct m_vector *bodies = vector_init(sizeof(struct body));
+    int depth = 0, open = 0;
+
+    for (int i = position; i < tokens->count; i++) {
+        if (tokens->kinds[i] == TOKEN_OPEN_BRACE) {
+            if (depth++ == 0) open = i;
+        } else if (tokens->kinds[i] == TOKEN_CLOSE_BRACE) {
+            if (depth == 0) goto unbalanced;
+            if (--depth == 0)
+                body_insert(bodies, (struct body) { .open = open, .close = i });
+        }
+    }
+
+    if (depth == 0) return bodies;
+
+unbalanced:
+    vector_free(bodies);
+    return NULL;
+}
+
+/** consecutive bodies parsed by one task, with an arena of its own */
+struct batch {
+    int first;
+    int end;
+    struct arena *arena;
+};
+
+struct deferred_parse {
+    struct lexer *lex;
+    struct m_vector *bodies;    //: struct body
+    struct batch *batches;
+};
+
+static void parse_batch(void *arg, int index) {
+    struct deferred_parse *job = (struct deferred_parse*) arg;
+    struct batch *batch = &job->batches[index];
+
+    struct lexer lex;
     struct global_vars vars = {
-        .tokens = tokens,
-        .progress = 0,
+        .lex = &lex,
+        .arena = batch->arena,
+        .defer_errors = true,
     };
-    struct m_vector *decls = parseDeclarations(&vars);
+    initExpressionParser(&vars);
+
+    for (int i = batch->first; i < batch->end; i++) {
+        struct body *body = body_ref(job->bodies, i);
+        lexer_replay(&lex, job->lex, body->open + 1);
+
+        beginAST(&vars);
+        body->statements = parseStatements(&vars);
+        if (body->statements == NULL) {
+            // nothing after the first error gets reported
+            body->error = vars.error;
+            break;
+        }
+        body->ast = endAST(&vars);
+    }
 
-    if (decls == NULL) {
-        return NULL;
-    } else {
-        struct program *result = (struct program*) malloc(sizeof(struct program));
-        result->declarations = decls;
-        return result;
+    cleanupExpressionParser(&vars);
+}
+
+/**
+ * Lazy parsing: keep only the first count bodies that are reachable from
+ * the roots, which are main, every function that isn't static and the
+ * names in `roots`, and return how many that is. The language has no
+ * calls yet, so a function counts as reachable when its name appears in
+ * a reachable body; any call would have to name it too.
+ */
+static int select_live_bodies(struct global_vars *vars, struct m_vector *declarations,
+        struct m_vector *bodies, int count, const char **roots)
+{
+    struct token_store *tokens = vars->lex->store;
+    const int main_symbol = intern("main", 4);
+    for (const char **name = roots; *name != NULL; name++)
+        intern(*name, strlen(*name));
+
+    // symbol -> body of the function, -1 for everything else
+    const int symbol_count = intern_count();
+    int *body_of = (int*) malloc(symbol_count * sizeof(int));
+    memset(body_of, -1, symbol_count * sizeof(int));
+    bool *live = (bool*) calloc(count, sizeof(bool));
+    int *worklist = (int*) malloc(count * sizeof(int));
+    int pending = 0;
+
+    for (int i = 0; i < count; i++) {
+        struct body *body = body_ref(bodies, i);
+        struct function *f = &declaration_ref(declarations, body->declaration)->obj.func;
+        body_of[f->name.symbol] = i;
+
+        if (!f->is_static || f->name.symbol == main_symbol) {
+            live[i] = true;
+            worklist[pending++] = i;
+        }
     }
+
+    for (const char **name = roots; *name != NULL; name++) {
+        const int b = body_of[intern(*name, strlen(*name))];
+        if (b >= 0 && !live[b]) {
+            live[b] = true;
+            worklist[pending++] = b;
+        }
+    }
+
+    while (pending > 0) {
+        struct body *body = body_ref(bodies, worklist[--pending]);
+        for (int t = body->open + 1; t < body->close; t++) {
+            if (tokens->kinds[t] != TOKEN_IDENTIFIER) continue;
+
+            const int b = body_of[tokens->payloads[t]];
+            if (b >= 0 && !live[b]) {
+                live[b] = true;
+                worklist[pending++] = b;
+            }
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (live[i]) *body_ref(bodies, kept++) = body_at(bodies, i);
+    }
+
+    free(body_of);
+    free(live);
+    free(worklist);
+    return kept;
 }
 
-/** cleanup functions (only vectors are cleaned up here) */
-static void cleanup_statements(struct m_vector* statements /*: struct variable_decl */) {
-    for (int i = 0; i < statements->_size; i++) {
-        struct statement st = statement_at(statements, i);
-        switch (st.type) {
-            case STATEMENT_RETURN:
-                cleanupExpression(st.obj.ret.value);
-                break;
-            case STATEMENT_VARIABLE_DECL:
-                cleanupExpression(st.obj.var.value);
-                break;
-            case STATEMENT_EXPRESSION:
-                cleanupExpression(st.obj.expr);
-                break;
+/**
+ * Parse with the function bodies set aside. The main thread parses
+ * everything outside of them, which the pre-pass in match_braces() lets
+ * it skip. The bodies are then parsed in batches of about the same number
+ * of tokens, spread over the pool if there is one, and the results are
+ * put together in source order. Of all the errors found only the first in
+ * source order is printed, just like the sequential parser would.
+ *
+ * With `roots` (see parse()) only the reachable bodies are parsed and
+ * the other functions are dropped from the declarations.
+ */
+static struct m_vector *parse_deferred(struct global_vars *vars, struct m_vector *bodies,
+        const char **roots, struct pool *pool)
+{
+    vars->bodies = bodies;
+    vars->defer_errors = true;
+    struct m_vector *declarations = parseDeclarations(vars);
+    if (vars->bodies_mismatch) return NULL;
+    int count = vars->next_body;     // bodies before any error
+
+    // after an error every body before it is parsed, the first error wins
+    if (roots != NULL && declarations != NULL)
+        count = select_live_bodies(vars, declarations, bodies, count, roots);
+
+    // source_line() builds its table on first use, which isn't thread safe
+    if (pool != NULL) source_line(vars->lex->src, 0);
+
+    const int batch_count = pool != NULL ? pool_size(pool) * 4 : 1;
+    struct batch *batches = (struct batch*) malloc(batch_count * sizeof(struct batch));
+
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        struct body *body = body_ref(bodies, i);
+        total += body->close - body->open;
+    }
+
+    int tasks = 0, tokens = 0;
+    for (int i = 0; i < count; tasks++) {
+        batches[tasks] = (struct batch) { .first = i, .arena = arena_init() };
+        const long limit = (long) total * (tasks + 1) / batch_count;
+        do {
+            struct body *body = body_ref(bodies, i++);
+            tokens += body->close - body->open;
+        } while (i < count && tokens < limit);
+        batches[tasks].end = i;
+    }
+
+    struct deferred_parse job = { .lex = vars->lex, .bodies = bodies, .batches = batches };
+    if (pool != NULL) {
+        pool_run(pool, tasks, parse_batch, &job);
+    } else {
+        for (int i = 0; i < tasks; i++) parse_batch(&job, i);
+    }
+
+    for (int i = 0; i < tasks; i++)
+        arena_adopt(vars->arena, batches[i].arena);
+    free(batches);
+
+    for (int i = 0; i < count; i++) {
+        struct body *body = body_ref(bodies, i);
+        if (body->statements == NULL) {
+            if (body->error != NULL) fputs(body->error, stderr);
+            return NULL;
         }
+
+        if (declarations != NULL) {
+            struct declaration *d = declaration_ref(declarations, body->declaration);
+            d->obj.func.statements = body->statements;
+            d->ast = body->ast;
+        }
+    }
+
+    if (declarations == NULL) {
+        if (vars->error != NULL) fputs(vars->error, stderr);
+        return NULL;
     }
+
+    // functions left without a body weren't reachable
+    int kept = 0;
+    for (int i = 0; i < declarations->_size; i++) {
+        struct declaration d = declaration_at(declarations, i);
+        if (d.type == DECLARATION_FUNCTION && d.obj.func.statements == NULL) continue;
+        *declaration_ref(declarations, kept++) = d;
+    }
+    declarations->_size = kept;
+
+    return declarations;
 }
 
-static void cleanup_declaration(struct declaration d) {
-    switch (d.type)
-    {
-    case DECLARATION_FUNCTION:
-        cleanup_statements(d.obj.func.statements);
-        vector_free(d.obj.func.statements);
-        break;
-
-    case DECLARATION_VARIABLE:
-        cleanupExpression(d.obj.var.value);
-        break;
-    
-    default:
-        break;
+/** every name in `roots` has to be a function, false after reporting one that isn't */
+static bool check_roots(struct m_vector *declarations, const char **roots) {
+    for (const char **name = roots; *name != NULL; name++) {
+        const int symbol = intern(*name, strlen(*name));
+        bool found = false;
+        for (int i = 0; i < declarations->_size && !found; i++) {
+            const struct declaration *d = declaration_ref(declarations, i);
+            found = d->type == DECLARATION_FUNCTION && d->obj.func.name.symbol == symbol;
+        }
+
+        if (!found) {
+            fprintf(stderr, "There is no function %s to compile (--root)\n", *name);
+            return false;
+        }
     }
+    return true;
 }
 
-// cleanup the parser data
-void parser_cleanup(struct program *p) {
-    // iterate over declarations
-    for (int i = 0; i < p->declarations->_size; i++) {
-        cleanup_declaration(
-            declaration_at(p->declarations, i));
+/****
+ *  program ::  <declaration>*  :: Program( declarations = [ <declaration>* ] )
+ *
+ * `roots` turns on lazy parsing: a NULL terminated list of functions to
+ * compile besides main and the functions that aren't static. Bodies of
+ * other functions are only parsed if they are reachable from those (see
+ * select_live_bodies()), naming anything but a function is an error.
+ * NULL parses everything.
+ *
+ * When the tokens were lexed up front (--parallel) the function bodies
+ * are parsed in parallel, see parse_deferred().
+ */
+struct program *parse(struct lexer *lex, struct arena *arena, const char **roots) {
+    // skipping bodies needs all the tokens at once
+    if (roots != NULL && !lexer_tokenize_all(lex)) return NULL;
+
+    struct global_vars vars = {
+        .lex = lex,
+        .arena = arena,
+    };
+    initExpressionParser(&vars);
+
+    struct m_vector *bodies = NULL;
+    if (lex->store != NULL && (roots != NULL || cpu_count() > 1))
+        bodies = match_braces(lex->store, lex->position);
+
+    const int start = lex->position;
+    struct pool *pool = bodies != NULL && cpu_count() > 1 ? pool_init(0) : NULL;
+    struct m_vector *decls = bodies != NULL
+        ? parse_deferred(&vars, bodies, roots, pool)
+        : parseDeclarations(&vars);
+
+    // the brace pre-pass doesn't match what the parser sees: a bug, but
+    // parsing everything in one go doesn't need it
+    if (vars.bodies_mismatch) {
+        lex->position = start;
+        vars.bodies = NULL;
+        vars.defer_errors = false;
+        vars.error = NULL;
+        decls = parseDeclarations(&vars);
+    }
+
+    if (pool != NULL) pool_free(pool);
+    if (bodies != NULL) vector_free(bodies);
+    cleanupExpressionParser(&vars);
+
+    if (decls == NULL || (roots != NULL && !check_roots(decls, roots))) {
+        return NULL;
+    } else {
+        struct program *result = (struct program*) arena_alloc(arena, sizeof(struct program));
+        result->declarations = decls;
+        result->source = lex->src;
+        return result;
     }
-    vector_free(p->declarations);
-    free(p);
 }
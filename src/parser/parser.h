@@ -1,19 +1,42 @@
 #pragma once
 
 #include "nodes.h"
+#include "../lexer/lexer.h"
 
 /**
  * Only used by the parser code. This should not be imported anywhere else
  */
 
 struct global_vars {
-    struct m_vector *tokens; /* struct token */
-    int progress;
+    struct lexer *lex;  /* tokens are pulled on demand */
+    struct arena *arena;    /* owns every node, vector and the program */
+
+    /* nodes of the declaration being parsed, moved to the arena when it ends */
+    struct m_vector *nodes;     //: struct Expr
+
+    /* work stacks of parseExpression, reused for every expression */
+    struct m_vector *operands;  //: expr_id
+    struct m_vector *pending;   //: struct pending
+
+    /* function bodies parsed apart from the rest, NULL when parsing in one go */
+    struct m_vector *bodies;    //: struct body
+    int next_body;
+    bool bodies_mismatch;       /* a body wasn't where the pre-pass put it */
+
+    /* bodies parsed apart keep their first error here instead of printing
+       it, so errors come out in source order no matter who found them */
+    bool defer_errors;
+    char *error;
 };
 
 // source: parser.c
 bool check(enum token_type expected, struct global_vars *vars);
+void report_error(struct global_vars *vars, const char *format, ...);
+void report_unexpected(struct global_vars *vars);
 
 // source: expr.c
-extern struct Expr *parseExpression(struct global_vars *vars);
-void cleanupExpression(struct Expr *expr);
+extern expr_id parseExpression(struct global_vars *vars);
+void initExpressionParser(struct global_vars *vars);
+void cleanupExpressionParser(struct global_vars *vars);
+void beginAST(struct global_vars *vars);
+struct ast endAST(struct global_vars *vars);
@@ -0,0 +1,115 @@
+#include "pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct pool {
+    pthread_t *threads;
+    int thread_count;       // workers, not counting the caller
+
+    pthread_mutex_t lock;
+    pthread_cond_t work;    // signalled when a job is posted or on shutdown
+    pthread_cond_t done;    // signalled when the last task of a job finishes
+
+    // current job, guarded by lock
+    void (*task)(void *arg, int index);
+    void *arg;
+    int count;
+    int next;               // next index to hand out
+    int pending;            // tasks not finished yet
+    unsigned int job;       // bumped for every pool_run()
+    bool shutdown;
+};
+
+int cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+}
+
+/** take and run tasks of the current job until none are left, lock held on entry and exit */
+static void drain(struct pool *pool) {
+    while (pool->next < pool->count) {
+        const int index = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->task(pool->arg, index);
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->pending == 0)
+            pthread_cond_broadcast(&pool->done);
+    }
+}
+
+static void *worker(void *data) {
+    struct pool *pool = (struct pool*) data;
+    unsigned int seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (!pool->shutdown && pool->job == seen)
+            pthread_cond_wait(&pool->work, &pool->lock);
+        if (pool->shutdown) break;
+
+        seen = pool->job;
+        drain(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+struct pool *pool_init(int threads) {
+    if (threads <= 0) threads = cpu_count();
+
+    struct pool *pool = (struct pool*) calloc(1, sizeof(struct pool));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    // the caller works too, so one thread fewer is enough
+    pool->threads = (pthread_t*) malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&pool->threads[pool->thread_count], NULL, worker, pool) == 0)
+            pool->thread_count++;
+    }
+
+    return pool;
+}
+
+void pool_free(struct pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->thread_count; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool);
+}
+
+int pool_size(struct pool *pool) {
+    return pool->thread_count + 1;
+}
+
+void pool_run(struct pool *pool, int count, void (*task)(void *arg, int index), void *arg) {
+    if (count <= 0) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->count = count;
+    pool->next = 0;
+    pool->pending = count;
+    pool->job++;
+    pthread_cond_broadcast(&pool->work);
+
+    drain(pool);
+    while (pool->pending > 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+/**
+ * A fixed set of worker threads for data parallel loops. pool_run() hands
+ * out the indices 0..count-1 to the workers (and the calling thread) and
+ * returns once every task has finished, so callers never see the threads.
+ */
+struct pool;
+
+/** threads <= 0 starts one thread per online CPU */
+struct pool *pool_init(int threads);
+void pool_free(struct pool *pool);
+
+/** number of threads working on a pool_run(), including the caller */
+int pool_size(struct pool *pool);
+
+/** run task(arg, i) for every i in [0, count) and wait for all of them */
+void pool_run(struct pool *pool, int count, void (*task)(void *arg, int index), void *arg);
+
+/** number of online CPUs, at least 1 */
+int cpu_count(void);
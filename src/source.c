@@ -0,0 +1,146 @@
+#include "source.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Map the file into memory with zero padding behind it.
+ *
+ * An anonymous (zero filled) region SOURCE_PADDING bytes larger than the
+ * file is reserved first and the file is mapped over the front of it. The
+ * bytes after the end of the file are then guaranteed to be zero, even
+ * when the file size is an exact multiple of the page size.
+ */
+static bool map_file(struct source *src, int fd, size_t size) {
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    const size_t length = (size + SOURCE_PADDING + page - 1) / page * page;
+
+    char *base = mmap(NULL, length, PROT_READ,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return false;
+
+    if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, length);
+        return false;
+    }
+
+    madvise(base, length, MADV_SEQUENTIAL);
+    src->data = base;
+    src->size = size;
+    src->_mapped = length;
+    return true;
+}
+
+/**
+ * Read everything left in fd into one allocation. `hint` is the expected
+ * size (0 when unknown, e.g. pipes); the buffer doubles past that.
+ */
+static bool read_file(struct source *src, int fd, size_t hint) {
+    size_t capacity = hint + SOURCE_PADDING > 4096 ? hint + SOURCE_PADDING : 4096;
+    size_t size = 0;
+    char *data = (char*) malloc(capacity);
+    if (data == NULL) return false;
+
+    while (true) {
+        if (size + SOURCE_PADDING >= capacity) {
+            char *grown = (char*) realloc(data, capacity * 2);
+            if (grown == NULL) goto error;
+            data = grown;
+            capacity *= 2;
+        }
+
+        ssize_t bytes = read(fd, data + size, capacity - size - SOURCE_PADDING);
+        if (bytes == 0) break;
+        if (bytes < 0) {
+            if (errno == EINTR) continue;
+            goto error;
+        }
+        size += bytes;
+    }
+
+    memset(data + size, 0, SOURCE_PADDING);
+    src->data = data;
+    src->size = size;
+    src->_mapped = 0;
+    return true;
+
+error:
+    free(data);
+    return false;
+}
+
+struct source *source_open(const char *path) {
+    const bool is_stdin = strcmp(path, "-") == 0;
+    int fd = is_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Unable to open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct source *src = (struct source*) calloc(1, sizeof(struct source));
+    struct stat st;
+    bool loaded = false;
+
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size > 0)
+            loaded = map_file(src, fd, (size_t) st.st_size);
+        if (!loaded)
+            loaded = read_file(src, fd, (size_t) st.st_size);
+    } else {
+        loaded = read_file(src, fd, 0);
+    }
+
+    if (!is_stdin) close(fd);
+
+    if (!loaded) {
+        fprintf(stderr, "Unable to read %s: %s\n", path, strerror(errno));
+        free(src);
+        return NULL;
+    }
+
+    return src;
+}
+
+void source_close(struct source *src) {
+    if (src->_mapped)
+        munmap((void*) src->data, src->_mapped);
+    else
+        free((void*) src->data);
+    free(src->_newlines);
+    free(src);
+}
+
+static void build_newlines(struct source *src) {
+    int capacity = 64;
+    src->_newlines = (uint32_t*) malloc(capacity * sizeof(uint32_t));
+
+    const char *end = src->data + src->size;
+    for (const char *p = src->data; (p = memchr(p, '\n', end - p)) != NULL; p++) {
+        if (src->_newline_count == capacity) {
+            capacity *= 2;
+            src->_newlines = (uint32_t*) realloc(src->_newlines, capacity * sizeof(uint32_t));
+        }
+        src->_newlines[src->_newline_count++] = p - src->data;
+    }
+}
+
+int source_line(struct source *src, uint32_t offset) {
+    if (src->_newlines == NULL) build_newlines(src);
+
+    // number of newlines before offset
+    int low = 0, high = src->_newline_count;
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (src->_newlines[mid] < offset) low = mid + 1;
+        else high = mid;
+    }
+
+    return low + 1;
+}
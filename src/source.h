@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** number of zero bytes guaranteed after the end of the source */
+#define SOURCE_PADDING 64
+
+/**
+ * A loaded source file.
+ *
+ * `data` is followed by SOURCE_PADDING zero bytes that are not counted in
+ * `size`: the first one is a '\0' sentinel so the lexer can look one
+ * character ahead without bounds checks, and the rest let the vectorized
+ * scanners (lexer/scan.c) load a full block at any position up to `size`.
+ * Regular files are memory-mapped; pipes and stdin are read into a single
+ * allocation.
+ */
+struct source {
+    const char *data;
+    size_t size;
+    size_t _mapped;     /* length of the mapping, 0 when heap allocated */
+
+    uint32_t *_newlines;    /* offsets of every '\n', built on first use */
+    int _newline_count;
+};
+
+/**
+ * Load a source file. Pass "-" to read from stdin.
+ * Returns NULL (after printing the reason) if the file can't be read.
+ */
+struct source *source_open(const char *path);
+void source_close(struct source *src);
+
+/**
+ * 1-based line number of the byte at `offset`. Lines are only needed for
+ * diagnostics, so the newline table is built on the first call and every
+ * lookup is a binary search over it.
+ */
+int source_line(struct source *src, uint32_t offset);
@@ -0,0 +1,60 @@
+#include "symtab.h"
+
+struct scope {
+    int first;          // first index in _symbols that belongs to the scope
+    int frame_size;     // frame size when the scope was opened
+};
+
+VECTOR_DEFINE(scope, struct scope)
+
+struct symtab *symtab_init(struct arena *arena, int symbol_count) {
+    struct symtab *table = (struct symtab*) arena_alloc(arena, sizeof(struct symtab));
+    table->_symbols = vector_init_arena(arena, sizeof(struct symbol));
+    table->_scopes = vector_init_arena(arena, sizeof(struct scope));
+    table->_heads = (int*) arena_calloc(arena, symbol_count + 1, sizeof(int));
+    table->frame_size = 0;
+
+    // the file scope
+    symtab_push_scope(table);
+    return table;
+}
+
+void symtab_push_scope(struct symtab *table) {
+    scope_insert(table->_scopes, (struct scope) {
+        .first = table->_symbols->_size,
+        .frame_size = table->frame_size,
+    });
+}
+
+void symtab_pop_scope(struct symtab *table) {
+    const struct scope scope = scope_at(table->_scopes, table->_scopes->_size - 1);
+    table->_scopes->_size--;
+
+    for (int i = table->_symbols->_size - 1; i >= scope.first; i--) {
+        const struct symbol *s = symbol_ref(table->_symbols, i);
+        table->_heads[s->name.symbol] = s->_shadowed;
+    }
+    table->_symbols->_size = scope.first;
+    table->frame_size = scope.frame_size;
+}
+
+struct symbol *symtab_declare(struct symtab *table, struct token name,
+        enum datatype type, enum storage_class storage, int size)
+{
+    const struct scope scope = scope_at(table->_scopes, table->_scopes->_size - 1);
+    const int previous = table->_heads[name.symbol];
+    if (previous - 1 >= scope.first) return NULL;
+
+    table->frame_size += size;
+    symbol_insert(table->_symbols, (struct symbol) {
+        .name = name,
+        .type = type,
+        .storage = storage,
+        .size = size,
+        .offset = table->frame_size,
+        ._shadowed = previous,
+    });
+    table->_heads[name.symbol] = table->_symbols->_size;
+
+    return symbol_ref(table->_symbols, table->_symbols->_size - 1);
+}
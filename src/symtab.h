@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "arena.h"
+#include "helpers.h"
+#include "parser/nodes.h"
+
+enum storage_class {
+    STORAGE_AUTO,       // on the stack of the enclosing function
+    STORAGE_STATIC,     // declared at file scope
+};
+
+/** a declared variable */
+struct symbol {
+    struct token name;
+    enum datatype type;
+    enum storage_class storage;
+    int size;           // bytes reserved for it
+    int offset;         // frame size right after it was allocated
+    int index;          // left to the owner of the table, the IR numbers variables with it
+
+    int _shadowed;      // index + 1 of the declaration it hides, 0 if none
+};
+
+VECTOR_DEFINE(symbol, struct symbol)
+
+/**
+ * Variables in scope, looked up by interned name in O(1).
+ *
+ * Declarations are kept in a stack in declaration order. `_heads` maps a
+ * symbol id to the innermost declaration of that name and every entry
+ * links to the one it shadows, so popping a scope just unwinds the stack.
+ *
+ * Offsets are measured from the top of the frame: allocating a variable
+ * grows `frame_size` by its size and records the new total, so the
+ * variable ends `frame_size - offset` bytes above the current bottom of
+ * the frame.
+ */
+struct symtab {
+    struct m_vector *_symbols;  //: struct symbol
+    struct m_vector *_scopes;   //: struct scope
+    int *_heads;                // symbol id -> index in _symbols + 1, 0 if undeclared
+    int frame_size;
+};
+
+/** an empty table for names interned so far, it lives in the arena */
+struct symtab *symtab_init(struct arena *arena, int symbol_count);
+
+/**
+ * Open a scope. Closing it forgets everything declared since and gives
+ * their frame space back (the code generator has to release it too).
+ */
+void symtab_push_scope(struct symtab *table);
+void symtab_pop_scope(struct symtab *table);
+
+/**
+ * Declare a variable in the innermost scope and allocate `size` bytes of
+ * frame for it. Returns NULL if the name is already declared in that
+ * scope; outer declarations are shadowed.
+ */
+struct symbol *symtab_declare(struct symtab *table, struct token name,
+        enum datatype type, enum storage_class storage, int size);
+
+/** innermost declaration of a name, NULL if there is none */
+static inline struct symbol *symtab_lookup(struct symtab *table, int symbol) {
+    const int index = table->_heads[symbol] - 1;
+    return index < 0 ? NULL : symbol_ref(table->_symbols, index);
+}
+
+/** bytes between the current bottom of the frame and the variable */
+static inline int symtab_frame_pos(const struct symtab *table, const struct symbol *s) {
+    return table->frame_size - s->offset;
+}
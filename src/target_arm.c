@@ -1,555 +1,794 @@
 #include "helpers.h"
-#include "parser/nodes.h"
-#include "lexer/token.h"
+#include "ir.h"
+#include "output.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-struct var {
-    size_t size;
-    const char* name;
-};
+/**
+ * Lowers the IR to AArch64 assembly.
+ *
+ * Registers are handed out by linear scan (Poletto, Sarkar). The IR only
+ * branches forward, so laid out in order every block comes after its
+ * predecessors and a value is live from its definition to its last use
+ * in that order, a single interval. Values get the caller saved x0-x15:
+ * there are no calls to save them around. When all 16 are taken, the
+ * live value that is needed the longest goes to an 8 byte slot in the
+ * frame, and x16/x17 are the scratch registers it is loaded into.
+ *
+ * The frame is carved out once in the prologue: the spill slots at the
+ * bottom, the locals (only left when the IR isn't optimized), 4 bytes
+ * each, above them.
+ */
 
-struct var var_at(struct m_vector *vec, int pos) {
-    return ((struct var*) vec->_data)[pos];
-}
+/** registers x0 .. x15 are allocated */
+#define ARM_REGISTERS 16
 
-static void var_insert(struct m_vector* vec, struct var data) {
-    if (vec->_size + 1 >= vec->_capacity)
-        vector_resize(vec, vec->_capacity + 100);
+/** where a virtual register lives when it isn't in x0-x15 */
+enum {
+    HOME_NONE = -1,         // never used, computed into x16 and dropped
+    HOME_IMMEDIATE = -2,    // a constant every user takes as an immediate
+    HOME_SPILLED = -3,      // in its frame slot
+    HOME_FLAGS = -4,        // only in the condition flags, see arm_flags()
+};
 
-    ((struct var*) vec->_data)[vec->_size] = data;
-    vec->_size++;
-}
+/** largest immediate of add, sub and cmp */
+#define ARM_MAX_IMMEDIATE 4095
+
+struct vreg_info {
+    int uses;
+    bool immediate;     // a small constant only used where an immediate fits
+    bool returned;      // used by a ret, x0 saves a move
+    uint64_t value;     // of a constant
+    int start, end;     // live interval: position of the definition and of the last use
+    int reg;            // x0-x15 or HOME_*
+    int slot;           // frame offset of a spilled value
+    vreg phi;           // the phi this value flows into (or is), see arm_allocate()
+    int hint;           // of a phi: register one of its values already has, or -1
+    vreg next_dying;    // of a spilled value: the next one whose interval ends at the same instruction
+
+    // compares and their and/or, see arm_flags()
+    uint8_t condition;  // what the flags satisfy when the value is 1 (IR_EQ .. IR_GE), 0 for other values
+    bool combines;      // an and/or of two values in the flags, computed by the ccmp of the second
+    vreg after;         // of a compare done with ccmp: the value in the flags before it
+    uint8_t chain;      // and whether that is and-ed (IR_AND) or or-ed (IR_OR) with it
+};
 
 struct arm_program_global_var {
-    char *memory;
-    int _size; 
-    int _capacity;
-
-    int stack_size;
-    struct m_vector *_variables;    //: struct var
-    int l_pos;
+    struct output *out;
+    const struct ir_module *module;
+    const struct ir_function *fn;
+
+    struct vreg_info *vregs;        // of the current function
+    int _vreg_capacity;
+    vreg *_dying;                   // instruction -> first spilled value it uses for the last time
+    int _dying_capacity;
+    struct m_vector *_free_slots;   //: int, offsets of reusable slots
+
+    int frame_size;
+    int locals_offset;              // where the locals start in the frame
+    int l_pos;                      // label of the first block of the current function
 };
 
-static void arm_program_checkandresize(struct arm_program_global_var *var, size_t size) {
-    while (size >= var->_capacity) {
-        char *newaddr = (char*) malloc(var->_capacity + 100);
-        memcpy(newaddr, var->memory, var->_capacity);
-        var->_capacity += 100;
-        free(var->memory);
-        var->memory = newaddr;
-    }
+VECTOR_DEFINE(int, int)
+
+/** emit fixed text, usually a whole instruction: arm_emit(var, "    ret\n") */
+#define arm_emit(var, text) output_literal((var)->out, text)
+
+/**
+ * emit `prefix value suffix`, the shape of every instruction with one
+ * immediate, offset or label number:
+ *     arm_emit_int(var, "    ldr w0, [sp, #", 16, "]\n")
+ */
+#define arm_emit_int(var, prefix, value, suffix) do {   \
+        output_literal((var)->out, prefix);            \
+        output_int((var)->out, value);                 \
+        output_literal((var)->out, suffix);            \
+    } while (0)
+
+/** emit `Ln:` */
+static void arm_emit_label(struct arm_program_global_var *var, int label) {
+    arm_emit_int(var, "L", label, ":\n");
 }
 
-int max(int a, int b) {
-    return a > b ? a : b;
+/** emit `, xn` for a register operand or `, #value` for an immediate one */
+static void arm_emit_operand(struct arm_program_global_var *var, vreg r, int reg) {
+    if (var->vregs[r].reg == HOME_IMMEDIATE)
+        arm_emit_int(var, ", #", (int64_t) var->vregs[r].value, "");
+    else
+        arm_emit_int(var, ", x", reg, "");
 }
 
-static void arm_program_append(struct arm_program_global_var *var, const char *text, size_t size) {
-    arm_program_checkandresize(var, var->_size + size + 1);
-    memcpy(var->memory + var->_size, text, size);
-    var->_size += size;
-    var->memory[var->_size] = '\0';
+/** emit `    op xd, xa, <second>`, or `    op xd, xa` without a second operand */
+static void arm_emit_op(struct arm_program_global_var *var, const char *op, int d, int a,
+        vreg second, int b)
+{
+    arm_emit(var, "    ");
+    output_append(var->out, op, strlen(op));
+    arm_emit_int(var, " x", d, ", x");
+    output_int(var->out, a);
+    if (second != IR_NONE) arm_emit_operand(var, second, b);
+    arm_emit(var, "\n");
 }
 
+/** emit `    mov xd, xs` unless they are the same */
+static void arm_emit_move(struct arm_program_global_var *var, int d, int s) {
+    if (d == s) return;
+    arm_emit_int(var, "    mov x", d, ", x");
+    arm_emit_int(var, "", s, "\n");
+}
 
+/** emit `_name` */
+static void arm_emit_symbol(struct arm_program_global_var *var, struct token name) {
+    arm_emit(var, "_");
+    output_append(var->out, name.value, name.length);
+}
 
-static int get_stack_pos(struct arm_program_global_var *vars, const char *name) {
-    int j = 0;
+/***
+ * loads a constant into xd. `mov` takes any 16 bit value, anything wider
+ * is built 16 bits at a time with movz/movk
+ **/
+static void arm_load_constant(struct arm_program_global_var *var, int d, uint64_t value) {
+    if (value <= 0xFFFF || ((int64_t) value < 0 && (int64_t) value >= -0x10000)) {
+        arm_emit_int(var, "    mov x", d, ", #");
+        arm_emit_int(var, "", (int64_t) value, "\n");     // movn if negative
+        return;
+    }
 
-    for (int i = vars->_variables->_size - 1; i >= 0; i--) {
-        struct var v = var_at(vars->_variables, i);
+    for (int shift = 0; shift < 64; shift += 16) {
+        const int part = (value >> shift) & 0xFFFF;
+        if (part == 0 && shift != 0) continue;
 
-        if (strcmp(v.name, name) == 0) return j;
-        else j += max(v.size, 8);
+        if (shift == 0) arm_emit_int(var, "    movz x", d, ", #");
+        else arm_emit_int(var, "    movk x", d, ", #");
+        arm_emit_int(var, "", part, ", lsl #");
+        arm_emit_int(var, "", shift, "\n");
     }
-
-    return -1;
 }
 
-static struct var *get_var(struct arm_program_global_var *vars, const char *name) {
-    for (int i = 0; i < vars->_variables->_size; i++) {
-        struct var *v = &((struct var*) vars->_variables->_data)[i];
+/** `add sp, sp, #n` or `sub`, immediates only have 12 bits (optionally shifted by 12) */
+static void arm_adjust_sp(struct arm_program_global_var *var, const char *op, int n) {
+    if (n >= 4096) {
+        arm_emit(var, "    ");
+        output_append(var->out, op, 3);
+        arm_emit_int(var, " sp, sp, #", n >> 12, ", lsl #12\n");
+        n &= 4095;
+    }
+    if (n == 0) return;
 
-        if (strcmp(v->name, name) == 0) return v;
+    arm_emit(var, "    ");
+    output_append(var->out, op, 3);
+    arm_emit_int(var, " sp, sp, #", n, "\n");
+}
+
+/**
+ * emit a load or store of xn (wn for 4 bytes) at sp + offset. Offsets the
+ * scaled 12 bit immediate can't reach go through a register: the loaded
+ * one itself, x17 for stores (which therefore never store x17).
+ */
+static void arm_frame_access(struct arm_program_global_var *var, bool load, int reg, int size, int offset) {
+    const bool direct = offset % size == 0 && offset / size < 4096;
+    const int base = load ? reg : 17;
+    if (!direct) {
+        arm_load_constant(var, base, offset);
+        arm_emit_int(var, "    add x", base, ", sp, x");
+        arm_emit_int(var, "", base, "\n");
     }
 
-    return NULL;
+    arm_emit(var, "    ");
+    output_append(var->out, load ? "ldr " : "str ", 4);
+    output_append(var->out, size == 4 ? "w" : "x", 1);
+    output_int(var->out, reg);
+    if (direct) arm_emit_int(var, ", [sp, #", offset, "]\n");
+    else arm_emit_int(var, ", [x", base, "]\n");
 }
 
 /**
- * Store whatever is in the w0 register to the stack position of name
+ * register holding the value of r, loaded into x`scratch` (16 or 17) if
+ * it is spilled. Immediates aren't loaded, see arm_emit_operand().
  */
-static bool store_variable(struct arm_program_global_var *var, const char *name) {
-    struct var *v = get_var(var, name);
-    char *stack_pos = int_to_str(get_stack_pos(var, name));
+static int arm_operand(struct arm_program_global_var *var, vreg r, int scratch) {
+    const struct vreg_info *info = &var->vregs[r];
+    if (info->reg >= 0) return info->reg;
+    if (info->reg == HOME_IMMEDIATE) return -1;
 
-    if (v == NULL) {
-        fprintf(stderr, "Variable %s does not exist\n", name);
-        goto error;
-    }
+    arm_frame_access(var, true, scratch, 8, info->slot);
+    return scratch;
+}
 
-    switch (v->size) {
-        case 8:
-            arm_program_append(var, "    str w0, [x12, #", 19);
-            arm_program_append(var, stack_pos, strlen(stack_pos));
-            arm_program_append(var, "]\n", 2);
-            break;
+/** register an instruction computes r into: its own, x16 if it has none */
+static int arm_result(struct arm_program_global_var *var, vreg r) {
+    return var->vregs[r].reg >= 0 ? var->vregs[r].reg : 16;
+}
 
-        default:
-            fprintf(stderr, "Variable %s does not support assignment operations\n", name);
-            goto error;
+/** address of a global in x16 */
+static void arm_global_address(struct arm_program_global_var *var, struct token name) {
+    arm_emit(var, "    adrp x16, ");
+    arm_emit_symbol(var, name);
+    arm_emit(var, "@PAGE\n");
+}
+
+static void arm_compile_memory(struct arm_program_global_var *var, const struct ir_insn *insn) {
+    const bool load = insn->op == IR_LOAD;
+    if (!insn->u.var.global) {
+        const int value = load ? arm_result(var, insn->dst) : arm_operand(var, insn->args[0], 16);
+        arm_frame_access(var, load, value, 4, var->locals_offset + 4 * insn->u.var.index);
+        return;
     }
 
-    free(stack_pos);
-    return true;
+    // x16 has the page
+    const int value = load ? arm_result(var, insn->dst) : arm_operand(var, insn->args[0], 17);
+    const struct token name = ir_global_ref(var->module->globals, insn->u.var.index)->var.name;
+    arm_global_address(var, name);
+    arm_emit(var, "    ");
+    output_append(var->out, load ? "ldr w" : "str w", 5);
+    output_int(var->out, value);
+    arm_emit(var, ", [x16, ");
+    arm_emit_symbol(var, name);
+    arm_emit(var, "@PAGEOFF]\n");
+}
+
+/** condition code of a compare */
+static const char *const arm_conditions[] = {
+    [IR_EQ] = "eq", [IR_NE] = "ne", [IR_LT] = "lt",
+    [IR_LE] = "le", [IR_GT] = "gt", [IR_GE] = "ge",
+};
 
-error:
-    free(stack_pos);
-    return false;
+/** the compare that holds exactly when `op` doesn't */
+static enum ir_op arm_inverse(enum ir_op op) {
+    static const enum ir_op inverse[] = {
+        [IR_EQ] = IR_NE, [IR_NE] = IR_EQ, [IR_LT] = IR_GE,
+        [IR_LE] = IR_GT, [IR_GT] = IR_LE, [IR_GE] = IR_LT,
+    };
+    return inverse[op];
+}
+
+/** emit `    cset xd, cond` */
+static void arm_emit_cset(struct arm_program_global_var *var, int d, enum ir_op condition) {
+    arm_emit_int(var, "    cset x", d, ", ");
+    output_append(var->out, arm_conditions[condition], 2);
+    arm_emit(var, "\n");
 }
 
 /**
- * Load the data from stack position to the w0 register
+ * cmp, or ccmp when the compare is combined with the one before it:
+ * `ccmp a, b, #nzcv, cond` compares when cond holds and sets the flags
+ * to nzcv otherwise, which is picked to give the and/or its result
+ * without the second compare (Z for eq/le/gt, N for lt/ge).
  */
-static bool load_variable(struct arm_program_global_var *var, const char *name) {
-    struct var *v = get_var(var, name);
-    char *stack_pos = int_to_str(get_stack_pos(var, name));
-
-    if (v == NULL) {
-        fprintf(stderr, "Variable %s does not exist\n", name);
-        goto error;
+static void arm_compile_compare(struct arm_program_global_var *var, const struct ir_insn *insn) {
+    static const int holds[] = { [IR_EQ] = 4, [IR_NE] = 0, [IR_LT] = 8, [IR_LE] = 4, [IR_GT] = 0, [IR_GE] = 0 };
+    const struct vreg_info *info = &var->vregs[insn->dst];
+    const int a = arm_operand(var, insn->args[0], 16);
+    int b = arm_operand(var, insn->args[1], 17);
+
+    if (info->after == IR_NONE) {
+        arm_emit_int(var, "    cmp x", a, "");
+        arm_emit_operand(var, insn->args[1], b);
+        arm_emit(var, "\n");
+    } else {
+        // x && y: compare if x holds, else y is false. x || y: compare unless x holds, else y is true
+        const bool both = info->chain == IR_AND;
+        const enum ir_op before = var->vregs[info->after].condition;
+        const enum ir_op settled = both ? arm_inverse(insn->op) : insn->op;
+
+        if (b < 0 && var->vregs[insn->args[1]].value > 31) {     // ccmp only has 5 bits
+            b = 17;
+            arm_load_constant(var, b, var->vregs[insn->args[1]].value);
+        }
+        arm_emit_int(var, "    ccmp x", a, "");
+        if (b < 0) arm_emit_int(var, ", #", (int64_t) var->vregs[insn->args[1]].value, "");
+        else arm_emit_int(var, ", x", b, "");
+        arm_emit_int(var, ", #", holds[settled], ", ");
+        output_append(var->out, arm_conditions[both ? before : arm_inverse(before)], 2);
+        arm_emit(var, "\n");
     }
 
-    switch (v->size) {
-        case 8:
-            arm_program_append(var, "    ldr w0, [x12, #", 19);
-            arm_program_append(var, stack_pos, strlen(stack_pos));
-            arm_program_append(var, "]\n", 2);
-            break;
+    if (info->reg != HOME_FLAGS) arm_emit_cset(var, arm_result(var, insn->dst), insn->op);
+}
 
-        default:
-            fprintf(stderr, "Variable %s does not support assignment operations\n", name);
-            goto error;
+/** a - (a / b) * b */
+static void arm_compile_remainder(struct arm_program_global_var *var, const struct ir_insn *insn) {
+    const int a = arm_operand(var, insn->args[0], 16);
+    const int b = arm_operand(var, insn->args[1], 17);
+    const int d = arm_result(var, insn->dst);
+
+    // the quotient needs a register that is neither operand
+    const int candidates[] = { d, 16, 17 };
+    for (int c = 0; c < 3; c++) {
+        const int q = candidates[c];
+        if (q == a || q == b) continue;
+        arm_emit_op(var, "sdiv", q, a, insn->args[1], b);
+        arm_emit_int(var, "    msub x", d, ", x");
+        arm_emit_int(var, "", q, ", x");
+        arm_emit_int(var, "", b, ", x");
+        arm_emit_int(var, "", a, "\n");
+        return;
     }
 
-    free(stack_pos);
-    return true;
-
-error:
-    free(stack_pos);
-    return false;
+    // all three spilled: the quotient takes the place of a, which is
+    // loaded again for the subtraction
+    arm_emit_op(var, "sdiv", 16, 16, insn->args[1], 17);
+    arm_emit(var, "    mul x16, x16, x17\n");
+    arm_frame_access(var, true, 17, 8, var->vregs[insn->args[0]].slot);
+    arm_emit(var, "    sub x16, x17, x16\n");
 }
 
-/***
- * compiles an expression and stores its results at w0/x0
- **/
-static bool arm_compile_expression(struct arm_program_global_var *var, struct Expr* expr) {
-    int stack_pos = 0;
-    char* stack_pos_str = NULL;
-    int stack_pos_str_count = 0;
-
-    if (expr->type == EXPR_UNARY_OPERATION) {
-        arm_compile_expression(var, expr->obj.unary.value);
-
-        // prefix operations happen here
-        switch (expr->obj.unary.prefix.type) {
-            case TOKEN_PLUS:
-                break;
-            case TOKEN_MINUS:
-                arm_program_append(var, "    neg x0, x0\n", 15);
-                break;
-            case TOKEN_TILDA:
-                arm_program_append(var, "    mvn x0, x0\n", 15);
-                break;
-            case TOKEN_BANG:
-                arm_program_append(var, "    cmp x0, #0\n", 15);
-                arm_program_append(var, "    cset x0, eq\n", 16);
-                break;
-            case TOKEN_PLUS_PLUS:
-                if (expr->obj.unary.value->type != EXPR_PRIMARY &&
-                    expr->obj.unary.value->obj.primary.value.type != TOKEN_IDENTIFIER)
-                {
-                    fprintf(stderr, "Error on line %d, you can only increment identifiers",
-                        expr->obj.unary.prefix.line);
-                    return false;
+/**
+ * Give the phis of `target` what flows in from the current block. The
+ * copies happen at once, so their order matters: copies into spilled
+ * phis first (their slots are theirs alone, nothing reads them here),
+ * then register to register copies, each one after the copies that
+ * still need the register it overwrites (a cycle goes through x16), and
+ * loads of spilled values last.
+ */
+static void arm_compile_phi_copies(struct arm_program_global_var *var, uint32_t from, uint32_t target) {
+    struct m_vector *insns = ir_insns(var->fn, target);
+    int to[ARM_REGISTERS], source[ARM_REGISTERS];
+    int moves = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *phi = ir_insn_ref(insns, i);
+            if (phi->op != IR_PHI) break;
+            const struct vreg_info *dst = &var->vregs[phi->dst];
+            if (dst->reg == HOME_NONE) continue;
+
+            for (uint32_t a = 0; a < phi->u.phi.count; a++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(var->fn->phi_args, phi->u.phi.first + a);
+                if (arg.block != from) continue;
+                const struct vreg_info *value = &var->vregs[arg.value];
+
+                if (pass == 0 && dst->reg == HOME_SPILLED) {
+                    arm_frame_access(var, false, arm_operand(var, arg.value, 16), 8, dst->slot);
+                } else if (pass == 0 && value->reg >= 0 && value->reg != dst->reg) {
+                    to[moves] = dst->reg;
+                    source[moves++] = value->reg;
+                } else if (pass == 1 && dst->reg >= 0 && value->reg == HOME_SPILLED) {
+                    arm_frame_access(var, true, dst->reg, 8, value->slot);
                 }
+            }
+        }
 
-                arm_program_append(var, "    add x0, x0, #1\n", 19);
-                store_variable(var, expr->obj.unary.value->obj.primary.value.value);
-                break;
-            case TOKEN_MINUS_MINUS:
-                if (expr->obj.unary.value->type != EXPR_PRIMARY &&
-                    expr->obj.unary.value->obj.primary.value.type != TOKEN_IDENTIFIER)
-                {
-                    fprintf(stderr, "Error on line %d, you can only decrement identifiers",
-                        expr->obj.unary.prefix.line);
-                    return false;
-                }
+        while (pass == 0 && moves > 0) {
+            // a copy whose target no other copy still reads
+            int ready = -1;
+            for (int m = 0; m < moves && ready < 0; m++) {
+                ready = m;
+                for (int n = 0; n < moves; n++)
+                    if (n != m && source[n] == to[m]) ready = -1;
+            }
+
+            if (ready < 0) {
+                // only cycles left: move one register out of the way
+                const int saved = source[0];
+                arm_emit_move(var, 16, saved);
+                for (int n = 0; n < moves; n++)
+                    if (source[n] == saved) source[n] = 16;
+                continue;
+            }
+
+            arm_emit_move(var, to[ready], source[ready]);
+            to[ready] = to[--moves];
+            source[ready] = source[moves];
+        }
+    }
+}
 
-                arm_program_append(var, "    sub x0, x0, #1\n", 19);
-                store_variable(var, expr->obj.unary.value->obj.primary.value.value);
-                break;
+/** `b Ln`, nothing if the block comes next anyway */
+static void arm_compile_jump(struct arm_program_global_var *var, uint32_t from, uint32_t target) {
+    if (target != from + 1) arm_emit_int(var, "    b L", var->l_pos + target, "\n");
+}
 
-            default:
-                fprintf(stderr, "Unsupported unary operation '%s'\n", expr->obj.unary.prefix.value);
-                return false;
+static void arm_compile_insn(struct arm_program_global_var *var, uint32_t block, const struct ir_insn *insn) {
+    switch (insn->op) {
+        case IR_CONST:
+            if (var->vregs[insn->dst].reg == HOME_IMMEDIATE) return;
+            arm_load_constant(var, arm_result(var, insn->dst), insn->u.imm);
+            break;
+        case IR_LOAD:
+        case IR_STORE:
+            arm_compile_memory(var, insn);
+            break;
+
+        case IR_NEG:
+        case IR_NOT: {
+            const int a = arm_operand(var, insn->args[0], 16);
+            arm_emit_op(var, insn->op == IR_NEG ? "neg" : "mvn", arm_result(var, insn->dst), a, IR_NONE, 0);
+            break;
         }
-        return true;
-    } else if (expr->type == EXPR_PRIMARY) {
-        // mov w0, #23
-        if (expr->obj.primary.value.type == TOKEN_CONSTANT) {
-            arm_program_append(var, "    mov x0, #", 13);
-            arm_program_append(var, expr->obj.primary.value.value, strlen(expr->obj.primary.value.value));
-            arm_program_append(var, "\n", 1);
-        } else if (expr->obj.primary.value.type == TOKEN_IDENTIFIER) {
-            return load_variable(var, expr->obj.primary.value.value);
+        case IR_ZEXT32: {
+            // writing a w register clears the upper half
+            const int a = arm_operand(var, insn->args[0], 16);
+            arm_emit_int(var, "    mov w", arm_result(var, insn->dst), ", w");
+            arm_emit_int(var, "", a, "\n");
+            break;
         }
 
-        return true;
-    } else if (expr->type == EXPR_BINARY_OPERATION) {
-        // compile the left side of the expression.
-        arm_compile_expression(var, expr->obj.binary.left);
+        case IR_AND:
+        case IR_OR:
+            if (var->vregs[insn->dst].combines) {
+                // the ccmp did the work
+                if (var->vregs[insn->dst].reg != HOME_FLAGS)
+                    arm_emit_cset(var, arm_result(var, insn->dst), var->vregs[insn->dst].condition);
+                break;
+            }
+            // fallthrough
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_XOR: {
+            static const char *const mnemonics[] = {
+                [IR_ADD] = "add", [IR_SUB] = "sub", [IR_MUL] = "mul", [IR_DIV] = "sdiv",
+                [IR_AND] = "and", [IR_OR] = "orr", [IR_XOR] = "eor",
+            };
+            const int a = arm_operand(var, insn->args[0], 16);
+            const int b = arm_operand(var, insn->args[1], 17);
+            arm_emit_op(var, mnemonics[insn->op], arm_result(var, insn->dst), a, insn->args[1], b);
+            break;
+        }
+        case IR_REM:
+            arm_compile_remainder(var, insn);
+            break;
 
-        // This stores its results in w0/x0 register so 
-        // move it to stack before running the next side of the operation
-        arm_program_append(var, "    sub sp, sp, #16\n", 20);
-        arm_program_append(var, "    str x0, [sp]\n", 17);
+        case IR_EQ:
+        case IR_NE:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+            arm_compile_compare(var, insn);
+            break;
 
-        // compile the right side of the expression.
-        arm_compile_expression(var, expr->obj.binary.right);
+        case IR_PHI:
+            return;     // filled in by the predecessors
+
+        case IR_JMP:
+            arm_compile_phi_copies(var, block, insn->u.target[0]);
+            arm_compile_jump(var, block, insn->u.target[0]);
+            return;
+
+        case IR_BR: {
+            const uint32_t taken = insn->u.target[0], other = insn->u.target[1];
+            const struct vreg_info *flags = &var->vregs[insn->args[0]];
+            if (flags->reg == HOME_FLAGS) {
+                const bool fall = taken == block + 1;
+                arm_emit(var, "    b.");
+                output_append(var->out, arm_conditions[fall ? arm_inverse(flags->condition) : flags->condition], 2);
+                arm_emit_int(var, " L", var->l_pos + (fall ? other : taken), "\n");
+                if (!fall) arm_compile_jump(var, block, other);
+                return;
+            }
+
+            const int condition = arm_operand(var, insn->args[0], 16);
+            if (taken == block + 1) {
+                arm_emit_int(var, "    cbz x", condition, ", L");
+                arm_emit_int(var, "", var->l_pos + other, "\n");
+            } else {
+                arm_emit_int(var, "    cbnz x", condition, ", L");
+                arm_emit_int(var, "", var->l_pos + taken, "\n");
+                arm_compile_jump(var, block, other);
+            }
+            return;
+        }
 
-        arm_program_append(var, "    ldr x1, [sp]\n", 17);
-        arm_program_append(var, "    add sp, sp, #16\n", 20);   // restore stack pointer
+        case IR_RET:
+            if (insn->args[0] != IR_NONE) {
+                const struct vreg_info *value = &var->vregs[insn->args[0]];
+                if (value->reg == HOME_SPILLED) arm_frame_access(var, true, 0, 8, value->slot);
+                else arm_emit_move(var, 0, value->reg);
+            }
+
+            // give the frame back
+            arm_adjust_sp(var, "add", var->frame_size);
+            arm_emit(var, "    ret\n");
+            return;
+    }
 
-        struct {
-            char* str;
-            int   count;
-        } l_pos[2] = { 0 };
+    // a spilled result was computed in x16
+    if (insn->dst != IR_NONE && var->vregs[insn->dst].reg == HOME_SPILLED)
+        arm_frame_access(var, false, 16, 8, var->vregs[insn->dst].slot);
+}
 
-        switch (expr->obj.binary.operation.type) {
-            case TOKEN_PLUS:
-                arm_program_append(var, "    add x0, x1, x0\n", 19);
-                break;
-            case TOKEN_MINUS:
-                arm_program_append(var, "    sub x0, x1, x0\n", 19);
-                break;
-            case TOKEN_STAR:
-                arm_program_append(var, "    mul x0, x1, x0\n", 19);
-                break;
-            case TOKEN_SLASH:
-                arm_program_append(var, "    sdiv x0, x1, x0\n", 20);
-                break;
-            case TOKEN_PERCENT:
-                arm_program_append(var, "    sdiv x3, x1, x0\n", 20);
-                arm_program_append(var, "    mul x2, x3, x0\n", 19);
-                arm_program_append(var, "    sub x0, x1, x2\n", 19);
-                break;
-            case TOKEN_AND:
-                arm_program_append(var, "    and x0, x1, x0\n", 19);
-                break;
-            case TOKEN_AND_AND:
-                l_pos[0].str = int_to_str(var->l_pos);
-                l_pos[0].count = digit_count(var->l_pos);
-
-                // cmp x1, #0
-                // beq L1
-                arm_program_append(var, "    cmp x1, #0\n", 15);
-                arm_program_append(var, "    beq L", 9);
-                arm_program_append(var, l_pos[0].str, l_pos[0].count);
-                arm_program_append(var, "\n", 1);
-
-                // cmp x0, #0
-                // beq L2
-                arm_program_append(var, "    cmp x0, #0\n", 15);
-                arm_program_append(var, "    beq L", 9);
-                arm_program_append(var, l_pos[0].str, l_pos[0].count);
-                arm_program_append(var, "\n", 1);
-
-                arm_program_append(var, "    mov x0, #1\n", 15);
-
-                l_pos[1].str = int_to_str(var->l_pos + 1);
-                l_pos[1].count = digit_count(var->l_pos + 1);
-                arm_program_append(var, "    b L", 7);
-                arm_program_append(var, l_pos[1].str, l_pos[1].count);
-                arm_program_append(var, "\n", 1);
-
-                arm_program_append(var, "L", 1);
-                arm_program_append(var, l_pos[0].str, l_pos[0].count);
-                arm_program_append(var, ":\n", 2);
-                arm_program_append(var, "    mov x0, #0\n", 15);
-
-                arm_program_append(var, "L", 1);
-                arm_program_append(var, l_pos[1].str, l_pos[1].count);
-                arm_program_append(var, ":\n", 2);
-
-                var->l_pos += 2;
-                free(l_pos[0].str);
-                free(l_pos[1].str);
-                l_pos[0].str = NULL;
-                l_pos[0].count = 0;
-                l_pos[1].str = NULL;
-                l_pos[1].count = 0;
-                break;
-            case TOKEN_PIPE_PIPE:
-                l_pos[0].str = int_to_str(var->l_pos);
-                l_pos[0].count = digit_count(var->l_pos);
-
-                // cmp x1, #0
-                // beq L1
-                arm_program_append(var, "    cmp x1, #0\n", 15);
-                arm_program_append(var, "    bne L", 9);
-                arm_program_append(var, l_pos[0].str, l_pos[0].count);
-                arm_program_append(var, "\n", 1);
-
-                // cmp x0, #0
-                // beq L2
-                arm_program_append(var, "    cmp x0, #0\n", 15);
-                arm_program_append(var, "    bne L", 9);
-                arm_program_append(var, l_pos[0].str, l_pos[0].count);
-                arm_program_append(var, "\n", 1);
-
-                arm_program_append(var, "    mov x0, #0\n", 15);
-
-                l_pos[1].str = int_to_str(var->l_pos + 1);
-                l_pos[1].count = digit_count(var->l_pos + 1);
-                arm_program_append(var, "    b L", 7);
-                arm_program_append(var, l_pos[1].str, l_pos[1].count);
-                arm_program_append(var, "\n", 1);
-
-                arm_program_append(var, "L", 1);
-                arm_program_append(var, l_pos[0].str, l_pos[0].count);
-                arm_program_append(var, ":\n", 2);
-                arm_program_append(var, "    mov x0, #1\n", 15);
-
-                arm_program_append(var, "L", 1);
-                arm_program_append(var, l_pos[1].str, l_pos[1].count);
-                arm_program_append(var, ":\n", 2);
-
-                var->l_pos += 2;
-                free(l_pos[0].str);
-                free(l_pos[1].str);
-                l_pos[0].str = NULL;
-                l_pos[0].count = 0;
-                l_pos[1].str = NULL;
-                l_pos[1].count = 0;
-                break;
-            case TOKEN_CARET:
-                arm_program_append(var, "    eor x0, x1, x0\n", 19);
-                break;
-            case TOKEN_PIPE:
-                arm_program_append(var, "    orr x0, x1, x0\n", 19);
-                break;
-            case TOKEN_BANG_EQUAL:
-                arm_program_append(var, "    cmp x1, x0\n", 15);
-                arm_program_append(var, "    cset x0, ne\n", 16);
-                break;
-            case TOKEN_EQUAL_EQUAL:
-                arm_program_append(var, "    cmp x1, x0\n", 15);
-                arm_program_append(var, "    cset x0, eq\n", 16);
-                break;
-            case TOKEN_GREATER_THAN:
-                arm_program_append(var, "    cmp x1, x0\n", 15);
-                arm_program_append(var, "    cset x0, gt\n", 16);
-                break;
-            case TOKEN_GREATER_THAN_EQUAL:
-                arm_program_append(var, "    cmp x1, x0\n", 15);
-                arm_program_append(var, "    cset x0, ge\n", 16);
-                break;
-            case TOKEN_LESS_THAN:
-                arm_program_append(var, "    cmp x1, x0\n", 15);
-                arm_program_append(var, "    cset x0, lt\n", 16);
-                break;
-            case TOKEN_LESS_THAN_EQUAL:
-                arm_program_append(var, "    cmp x1, x0\n", 15);
-                arm_program_append(var, "    cset x0, le\n", 16);
-                break;
+/** whether operand a of the instruction can be an immediate instead of a register */
+static bool takes_immediate(const struct ir_insn *insn, int a) {
+    if (a != 1) return false;
+    switch (insn->op) {
+        case IR_ADD: case IR_SUB:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+            return true;
+        default:
+            return false;
+    }
+}
 
-            default:
-                fprintf(stderr, "Unexpected operator token '%s' on like %d\n",
-                        expr->obj.binary.operation.value,
-                        expr->obj.binary.operation.line);
-                return false;
+/**
+ * Live intervals. Instruction n (counting through the blocks in order)
+ * reads its operands at 2n and writes its result at 2n + 1, so a result
+ * can take the register of an operand used for the last time. A phi
+ * argument is read by the jump at the end of its block. Returns the
+ * number of instructions.
+ */
+static int arm_intervals(struct arm_program_global_var *var) {
+    const struct ir_function *fn = var->fn;
+    struct vreg_info *info = var->vregs;
+    int *ends = (int*) malloc(fn->blocks->_size * sizeof(int));     // position of each terminator
+    int n = 0;
+
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        const struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++, n++) {
+            const struct ir_insn insn = ir_insn_at(insns, i);
+            for (int a = 0; a < ir_arg_count(insn.op); a++) {
+                const vreg r = insn.args[a];
+                if (r == IR_NONE) continue;
+                info[r].uses++;
+                info[r].end = 2 * n;
+                if (!takes_immediate(&insn, a)) info[r].immediate = false;
+                if (insn.op == IR_RET) info[r].returned = true;
+            }
+
+            if (insn.dst == IR_NONE) continue;
+            info[insn.dst].start = 2 * n + 1;
+            info[insn.dst].immediate = insn.op == IR_CONST && insn.u.imm <= ARM_MAX_IMMEDIATE;
+            info[insn.dst].value = insn.u.imm;
+            if (insn.op == IR_PHI) info[insn.dst].phi = insn.dst;
         }
+        ends[b] = 2 * (n - 1);
+    }
 
-        return true;
-    } else if (expr->type == EXPR_ASSIGNMENT) {
-        int stack_pos = get_stack_pos(var, expr->obj.assignment.name.value);
-        if (stack_pos < 0) {
-            fprintf(stderr, "Variable %s not defined on line %d\n",
-                expr->obj.assignment.name.value,
-                expr->obj.assignment.name.line);
-            return false;
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *phi = ir_insn_ref(insns, i);
+            if (phi->op != IR_PHI) break;
+            for (uint32_t a = 0; a < phi->u.phi.count; a++) {
+                const struct ir_phi_arg arg = ir_phi_arg_at(fn->phi_args, phi->u.phi.first + a);
+                struct vreg_info *value = &info[arg.value];
+                value->uses++;
+                value->immediate = false;
+                if (value->end < ends[arg.block]) value->end = ends[arg.block];
+                if (value->phi == IR_NONE) value->phi = phi->dst;
+            }
         }
+    }
 
-        if (!arm_compile_expression(var, expr->obj.assignment.right)) {
-            return false;
-        }
+    free(ends);
+    return n;
+}
 
-        char *pos_str = int_to_str(stack_pos);
-        arm_program_append(var, "    str w0, [x12, #", 19);
-        arm_program_append(var, pos_str, digit_count(stack_pos));
-        arm_program_append(var, "]\n", 2);
-        
-        return false;
-    } else {
-        fprintf(stderr, "Unsupported expression type\n");
-        return false;
-    }
+/** whether r can be computed into the flags for its only user */
+static bool arm_flags_candidate(const struct vreg_info *info) {
+    return info->condition != 0 && info->uses == 1 && info->phi == IR_NONE;
 }
 
-static bool arm_compile_variabledecl(struct arm_program_global_var *var, struct variable_decl *vd) {
-    const int size = datatype_size(vd->type);
-
-    // compile expression here
-    if (!arm_compile_expression(var, vd->value))
-        return false;
-    
-    // make sure the variable hasn't already been declared before
-    if (get_var(var, vd->name) != NULL) {
-        fprintf(stderr, "Redeclaration of variable %s on line %d\n", vd->name, vd->line);
-        return false;
+/**
+ * Decide which values stay in the condition flags instead of taking a
+ * register: a compare (or and/or of them) only the branch ending its
+ * block reads, and two compares an and/or combines, the second one done
+ * with ccmp, so `a < b && c != d` is cmp, ccmp and a b.cond or cset. The
+ * flags have to last until the use, so no other compare may come between.
+ */
+static void arm_flags(struct arm_program_global_var *var) {
+    const struct ir_function *fn = var->fn;
+    struct vreg_info *info = var->vregs;
+
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        vreg last = IR_NONE, before = IR_NONE;      // the values the latest two compares set the flags for
+
+        for (int i = 0; i < insns->_size; i++) {
+            const struct ir_insn *insn = ir_insn_ref(insns, i);
+            if (ir_is_compare(insn->op)) {
+                info[insn->dst].condition = insn->op;
+                before = last;
+                last = insn->dst;
+            } else if (insn->op == IR_AND || insn->op == IR_OR) {
+                const vreg x = insn->args[0] == before ? insn->args[0] : insn->args[1];
+                const vreg y = insn->args[0] == before ? insn->args[1] : insn->args[0];
+                if (x != before || y != last || before == IR_NONE || info[y].combines
+                        || !arm_flags_candidate(&info[x]) || !arm_flags_candidate(&info[y]))
+                    continue;
+
+                info[x].reg = info[y].reg = HOME_FLAGS;
+                info[y].after = x;
+                info[y].chain = insn->op;
+                info[insn->dst].combines = true;
+                info[insn->dst].condition = info[y].condition;
+                before = IR_NONE;
+                last = insn->dst;
+            } else if (insn->op == IR_BR && insn->args[0] == last && last != IR_NONE
+                    && arm_flags_candidate(&info[last])) {
+                info[last].reg = HOME_FLAGS;
+            }
+        }
     }
+}
 
-    // allocate stack memory here
-    if (size <= 4) {
-        arm_program_append(var, "    sub x12, x12, #8\n", 21);
-        var_insert(var->_variables, (struct var) {
-            .size = 8,
-            .name = vd->name,
-        });
-    } else {
-        char *s = int_to_str(size * 2);
-        arm_program_append(var, "    sub x12, x12, #", 19); 
-        arm_program_append(var, s, strlen(s));
-        arm_program_append(var, "\n", 1);
-        free(s);
-        var_insert(var->_variables, (struct var) {
-            .size = size * 2,
-            .name = vd->name,
-        });
+/**
+ * The register for r: the one the other values of its phi have, so the
+ * copy disappears, then x0 for a returned value, then the lowest free.
+ */
+static int arm_choose_register(struct arm_program_global_var *var, vreg r, uint32_t free) {
+    const struct vreg_info *info = &var->vregs[r];
+    if (info->phi != IR_NONE) {
+        const int hint = var->vregs[info->phi].hint;
+        if (hint >= 0 && (free & (1u << hint))) return hint;
     }
-
-    return store_variable(var, vd->name);
+    if (info->returned && (free & 1)) return 0;
+    return __builtin_ctz(free);
 }
 
-static bool arm_compile_return(struct arm_program_global_var *vars, struct Return r)
-{
-    arm_compile_expression(vars, r.value);
+/**
+ * Linear scan: walk the definitions in order, give back the registers
+ * of intervals that ended and take a free one. With none free, whichever
+ * of the live intervals and the new one ends last is spilled, for its
+ * whole life. Then spilled values get frame slots the same way, a slot
+ * is free again after the last use. Returns the number of slots.
+ */
+static int arm_allocate(struct arm_program_global_var *var) {
+    const struct ir_function *fn = var->fn;
+    if (fn->vreg_count > (uint32_t) var->_vreg_capacity) {
+        var->_vreg_capacity = fn->vreg_count * 2;
+        var->vregs = (struct vreg_info*) realloc(var->vregs, var->_vreg_capacity * sizeof(struct vreg_info));
+    }
+    struct vreg_info *info = var->vregs;
+    for (uint32_t r = 0; r < fn->vreg_count; r++)
+        info[r] = (struct vreg_info) { .reg = HOME_NONE, .slot = -1, .phi = IR_NONE, .hint = -1 };
+
+    const int count = arm_intervals(var);
+    arm_flags(var);
+    vreg active[ARM_REGISTERS];
+    int live = 0;
+    uint32_t free = (1u << ARM_REGISTERS) - 1;
+
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++) {
+            const vreg r = ir_insn_ref(insns, i)->dst;
+            if (r == IR_NONE || info[r].uses == 0 || info[r].reg == HOME_FLAGS) continue;
+            if (info[r].immediate) {
+                info[r].reg = HOME_IMMEDIATE;
+                continue;
+            }
+
+            for (int a = 0; a < live; a++) {
+                if (info[active[a]].end >= info[r].start) continue;
+                free |= 1u << info[active[a]].reg;
+                active[a--] = active[--live];
+            }
+
+            if (free == 0) {
+                int longest = 0;
+                for (int a = 1; a < live; a++)
+                    if (info[active[a]].end > info[active[longest]].end) longest = a;
+                if (info[active[longest]].end <= info[r].end) {
+                    info[r].reg = HOME_SPILLED;
+                    continue;
+                }
+                free |= 1u << info[active[longest]].reg;
+                info[active[longest]].reg = HOME_SPILLED;
+                active[longest] = active[--live];
+            }
+
+            info[r].reg = arm_choose_register(var, r, free);
+            free &= ~(1u << info[r].reg);
+            active[live++] = r;
+            if (info[r].phi != IR_NONE && var->vregs[info[r].phi].hint < 0)
+                var->vregs[info[r].phi].hint = info[r].reg;
+        }
+    }
 
-    /**
-     * restore all stack allocated variables
-     * with 11 as the allocated stack space:
-     *     add sp, sp, #11
-     *     ret
-     */
-    const char* stack_size_str = int_to_str(vars->stack_size);
-    arm_program_append(vars, "    add sp, sp, #", 17);
-    arm_program_append(vars, stack_size_str, strlen(stack_size_str));
-    arm_program_append(vars, "\n    ret\n", 9);
-    free((void*) stack_size_str);
-    return true;
-}
+    // slots: list the spilled values by the instruction that uses them last
+    if (count > var->_dying_capacity) {
+        var->_dying_capacity = count * 2;
+        var->_dying = (vreg*) realloc(var->_dying, var->_dying_capacity * sizeof(vreg));
+    }
+    memset(var->_dying, 0, count * sizeof(vreg));
+    for (uint32_t r = 1; r < fn->vreg_count; r++) {
+        if (info[r].reg != HOME_SPILLED || info[r].phi == r) continue;
+        info[r].next_dying = var->_dying[info[r].end / 2];
+        var->_dying[info[r].end / 2] = r;
+    }
 
-static bool arm_compile_statements(struct arm_program_global_var *vars, struct statement s)
-{
-    switch (s.type) {
-        case STATEMENT_RETURN:
-            return arm_compile_return(vars, s.obj.ret);
-        case STATEMENT_VARIABLE_DECL:
-            return arm_compile_variabledecl(vars, &s.obj.var);
-        case STATEMENT_EXPRESSION:
-            return arm_compile_expression(vars, s.obj.expr);
+    int slots = 0, n = 0;
+    struct m_vector *free_slots = var->_free_slots;
+    free_slots->_size = 0;
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        for (int i = 0; i < insns->_size; i++, n++) {
+            for (vreg d = var->_dying[n]; d != IR_NONE; d = info[d].next_dying)
+                int_insert(free_slots, info[d].slot);
+
+            // a spilled phi keeps its slot, the copies into it rely on that
+            const vreg r = ir_insn_ref(insns, i)->dst;
+            if (r == IR_NONE || info[r].reg != HOME_SPILLED) continue;
+            if (info[r].phi != r && free_slots->_size > 0) info[r].slot = int_at(free_slots, --free_slots->_size);
+            else info[r].slot = 8 * slots++;
+        }
     }
+
+    return slots;
 }
 
-static bool arm_compile_functiondecl(struct arm_program_global_var *vars, struct function *f)
-{
+static void arm_compile_function(struct arm_program_global_var *var, const struct ir_function *fn) {
+    var->fn = fn;
+    const int slots = arm_allocate(var);
+    var->locals_offset = 8 * slots;
+    var->frame_size = var->locals_offset + 4 * fn->locals->_size;
+    var->frame_size = (var->frame_size + 15) & ~15;     // sp stays 16 byte aligned
+
     /**
      * .globl _func_name
      * .p2align 2
      * _func_name:
      *     .cfi_startproc
+     *     sub sp, sp, #16
      */
-    arm_program_append(vars, ".globl _", 8);
-    arm_program_append(vars, f->name, strlen(f->name));
-    arm_program_append(vars, "\n.p2align 2\n_", 13);
-    arm_program_append(vars, f->name, strlen(f->name));
-    arm_program_append(vars, ":\n    .cfi_startproc\n", 21);
-
-    // calculate the amount of stack memory used and
-    // pre-allocate that. Make sure the stack is 16-byte aligned in the end
-    for (int i = 0; i < f->statements->_size; i++) {
-        struct statement st = statement_at(f->statements, i);
-        if (st.type == STATEMENT_VARIABLE_DECL) {
-            struct variable_decl vd = st.obj.var;
-            size_t size = datatype_size(vd.type) * 2;
-            vars->stack_size += max(size, 8);
-        }
+    if (!fn->is_static) {
+        arm_emit(var, ".globl ");
+        arm_emit_symbol(var, fn->name);
+        arm_emit(var, "\n");
     }
-
-    /**
-     * Allocate the stack using using x12 as internal stack register
-     * with 8 as example the asm would look like this:
-     * 
-     *     mov x12, sp
-     *     sub sp, sp, #8
-     */
-    if (vars->stack_size % 16 != 0)
-        vars->stack_size = vars->stack_size - (vars->stack_size % 16) + 16;
-    const char* stack_size_str = int_to_str(vars->stack_size);
-    arm_program_append(vars, "    mov x12, sp\n", 16);
-    arm_program_append(vars, "    sub sp, sp, #", 17);
-    arm_program_append(vars, stack_size_str, strlen(stack_size_str));
-    arm_program_append(vars, "\n", 1);
-    free((void*) stack_size_str);
-
-    for (int i = 0; i < f->statements->_size; i++) {
-        if (!arm_compile_statements(vars, statement_at(f->statements, i)))
-            return false;
+    arm_emit(var, ".p2align 2\n");
+    arm_emit_symbol(var, fn->name);
+    arm_emit(var, ":\n    .cfi_startproc\n");
+    arm_adjust_sp(var, "sub", var->frame_size);
+
+    for (int b = 0; b < fn->blocks->_size; b++) {
+        struct m_vector *insns = ir_insns(fn, b);
+        if (b > 0) arm_emit_label(var, var->l_pos + b);
+        for (int i = 0; i < insns->_size; i++)
+            arm_compile_insn(var, b, ir_insn_ref(insns, i));
     }
-    
-    arm_program_append(vars, "    .cfi_endproc\n", 17);
-    return true;
+
+    arm_emit(var, "    .cfi_endproc\n");
+    var->l_pos += fn->blocks->_size;
 }
 
-static bool arm_compile_declaration(struct arm_program_global_var *vars, struct declaration d) {
-    if (d.type == DECLARATION_FUNCTION) {
-        return arm_compile_functiondecl(vars, &d.obj.func);
-    } else if (d.type == DECLARATION_VARIABLE) {
-        return arm_compile_variabledecl(vars, &d.obj.var);
+/**
+ * .data
+ * .globl _g
+ * .p2align 2
+ * _g:
+ *     .long 5
+ */
+static void arm_compile_globals(struct arm_program_global_var *var) {
+    struct m_vector *globals = var->module->globals;
+    if (globals->_size == 0) return;
+
+    arm_emit(var, ".data\n");
+    for (int i = 0; i < globals->_size; i++) {
+        const struct ir_global *g = ir_global_ref(globals, i);
+        arm_emit(var, ".globl ");
+        arm_emit_symbol(var, g->var.name);
+        arm_emit(var, "\n.p2align 2\n");
+        arm_emit_symbol(var, g->var.name);
+        arm_emit_int(var, ":\n    .long ", (int32_t) g->value, "\n");
     }
-    return false;
 }
 
-const char* arm_compile(struct program *p) {
+bool arm_compile(const struct ir_module *m, struct arena *scratch, struct output *out) {
     struct arm_program_global_var var = {
-        .memory = (char*) malloc(100),
-        ._size = 0,
-        ._capacity = 100,
-        .stack_size = 0,
-        ._variables = vector_init(sizeof(struct var)),
+        .out = out,
+        .module = m,
+        ._free_slots = vector_init_arena(scratch, sizeof(int)),
         .l_pos = 0,
     };
-    memset(var.memory, 0, 100);
 
-    for (int i = 0; i < p->declarations->_size; i++) {
-        if (!arm_compile_declaration(
-            &var, declaration_at(p->declarations, i))) {
-            goto error_cleanup;
-        }
+    for (int i = 0; i < m->functions->_size; i++) {
+        arm_compile_function(&var, ir_function_ref(m->functions, i));
+        arm_emit(&var, "\n");
 
-        arm_program_append(&var, "\n", 1);
-        var.stack_size = 0;
-        var._size = 0;
+        // hand finished functions to the file in big blocks, so whoever
+        // reads it can start before we are done
+        if (out->size >= OUTPUT_BLOCK_SIZE / 2)
+            output_flush(out);
     }
+    arm_compile_globals(&var);
 
-    vector_free(var._variables);
-    return var.memory;
-    
-error_cleanup:
-    free(var.memory);
-    vector_free(var._variables);
-    return NULL;
+    free(var.vregs);
+    free(var._dying);
+    return true;
 }
@@ -0,0 +1,156 @@
+#include "../src/compilation.h"
+#include "../src/parser/nodes.h"
+#include "../src/lexer/intern.h"
+
+// from parser/parser.c
+struct program *parse(struct lexer *lex, struct arena *arena, const char **roots);
+
+/**
+ * Prints the AST of a file, one statement per line with expressions as
+ * s-expressions. Every operator and operand carries its source offset
+ * (`(+@12 a@10 b@14)`), so a tree that is shaped the same but built from
+ * other tokens still shows up in a diff. Diagnostics go to stderr as usual.
+ *
+ *   ast_dump file        dump the tree
+ *   ast_dump -q file     only parse, for timing the parser
+ *
+ * The expected dumps in tests/parser were produced by the precedenceN
+ * parser this one replaced, see parser.sh.
+ */
+
+static const char *datatype_names[] = {
+    [DATATYPE_INT] = "int",
+    [DATATYPE_CHAR] = "char",
+    [DATATYPE_VOID] = "void",
+    [DATATYPE_ERR] = "error",
+};
+
+static void print_token(const char *content, enum token_type kind, uint32_t offset)
+{
+    const struct constant none = { 0 };
+    struct token t = token_view(content, kind, offset, 0, &none);
+    printf("%.*s@%u", t.length, t.value, offset);
+}
+
+static void print_expr(const char *content, const struct ast *ast, expr_id id)
+{
+    const struct Expr *e = ast_node(ast, id);
+    const struct Expr *arms;
+    struct interned name;
+
+    switch ((enum expr_type) e->type) {
+        case EXPR_PRIMARY:
+            if (e->operation == TOKEN_IDENTIFIER) {
+                name = intern_at(e->obj.symbol);
+                printf("%.*s@%u", name.length, name.value, e->offset);
+            } else {
+                print_token(content, e->operation, e->offset);
+            }
+            break;
+
+        case EXPR_ASSIGNMENT:
+            name = intern_at(e->obj.assignment.name);
+            printf("(");
+            print_token(content, e->operation, e->offset);
+            printf(" %.*s ", name.length, name.value);
+            print_expr(content, ast, e->obj.assignment.right);
+            printf(")");
+            break;
+
+        case EXPR_UNARY_OPERATION:
+            printf("(");
+            print_token(content, e->operation, e->offset);
+            printf(" ");
+            print_expr(content, ast, e->obj.unary.value);
+            printf(")");
+            break;
+
+        case EXPR_BINARY_OPERATION:
+            printf("(");
+            print_token(content, e->operation, e->offset);
+            printf(" ");
+            print_expr(content, ast, e->obj.binary.left);
+            printf(" ");
+            print_expr(content, ast, e->obj.binary.right);
+            printf(")");
+            break;
+
+        case EXPR_TERNARY_OPERATION:
+            arms = ast_node(ast, e->obj.ternary.arms);
+            printf("(?: ");
+            print_expr(content, ast, e->obj.ternary.condition);
+            printf(" ");
+            print_expr(content, ast, arms->obj.binary.left);
+            printf(" ");
+            print_expr(content, ast, arms->obj.binary.right);
+            printf(")");
+            break;
+
+        case EXPR_TERNARY_ARMS:
+            printf("(arms?)");
+            break;
+    }
+}
+
+static void print_variable(const char *content, const struct ast *ast, const struct variable_decl *var)
+{
+    printf("%s %.*s", datatype_names[var->type], var->name.length, var->name.value);
+    if (var->value != EXPR_NONE) {
+        printf(" = ");
+        print_expr(content, ast, var->value);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    const bool quiet = argc == 3 && strcmp(argv[1], "-q") == 0;
+    if (argc != 2 && !quiet) {
+        fprintf(stderr, "usage: ast_dump [-q] file\n");
+        return 2;
+    }
+
+    struct compilation c;
+    if (!compilation_open(&c, argv[argc - 1])) return 2;
+
+    struct program *p = parse(&c.lex, c.arena, NULL);
+    if (p == NULL) {
+        printf("error\n");
+    } else if (!quiet) {
+        const char *content = c.src->data;
+
+        for (int i = 0; i < p->declarations->_size; i++) {
+            struct declaration *decl = declaration_ref(p->declarations, i);
+            if (decl->type == DECLARATION_VARIABLE) {
+                print_variable(content, &decl->ast, &decl->obj.var);
+                continue;
+            }
+
+            struct function *func = &decl->obj.func;
+            printf("%s%s %.*s()\n", func->is_static ? "static " : "",
+                datatype_names[func->type], func->name.length, func->name.value);
+
+            for (int s = 0; s < func->statements->_size; s++) {
+                struct statement *stmt = statement_ref(func->statements, s);
+                printf("    ");
+                switch (stmt->type) {
+                    case STATEMENT_RETURN:
+                        printf("return ");
+                        print_expr(content, &decl->ast, stmt->obj.ret.value);
+                        printf("\n");
+                        break;
+                    case STATEMENT_VARIABLE_DECL:
+                        print_variable(content, &decl->ast, &stmt->obj.var);
+                        break;
+                    case STATEMENT_EXPRESSION:
+                        print_expr(content, &decl->ast, stmt->obj.expr);
+                        printf("\n");
+                        break;
+                }
+            }
+        }
+    }
+
+    compilation_close(&c);
+    return 0;
+}
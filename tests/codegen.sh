@@ -0,0 +1,39 @@
+#!/bin/sh
+# Compiles tests/codegen/*.c and compares the control flow of the
+# assembly (labels, branches and returns) with the expected one. Whatever
+# the expected files say, a label whose block is a lone `b` fails the test.
+#
+#   tests/codegen.sh comp work_dir
+set -u
+comp=$1
+work=$2
+
+mkdir -p "$work"
+fail=0
+for file in tests/codegen/*.c; do
+    expected=${file%.c}.expected
+    if ! "$comp" -o "$work/out.s" "$file"; then
+        echo "codegen: $file doesn't compile"
+        fail=1
+        continue
+    fi
+
+    grep -E '^[_A-Za-z0-9]+:|^ +(b|b\.[a-z]+|cbz|cbnz|ret)( |$)' "$work/out.s" > "$work/branches.txt"
+    if ! cmp -s "$expected" "$work/branches.txt"; then
+        echo "codegen: $file differs from $expected"
+        diff "$expected" "$work/branches.txt" | head -5
+        fail=1
+    fi
+
+    trampolines=$(awk '/^L[0-9]+:/ { label = $0; next }
+                       label != "" && $1 == "b" { print label " " $0 }
+                       { label = "" }' "$work/out.s")
+    if [ -n "$trampolines" ]; then
+        echo "codegen: $file has blocks that only jump on:"
+        echo "$trampolines"
+        fail=1
+    fi
+done
+
+[ $fail = 0 ] && echo "codegen: $(ls tests/codegen/*.c | wc -l) files ok"
+exit $fail
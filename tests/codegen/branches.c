@@ -0,0 +1,14 @@
+// Conditions of ternaries branch straight to the arm they pick: no block
+// that only jumps on (`L2: b L4`) is left between them.
+int g = 1;
+int h = 0;
+int k = 3;
+
+int and_or(void) { return (g && (h || g > 2)) ? 10 : 20; }
+int or(void) { return (g || h) ? k : k + 1; }
+int and_and(void) { return (g && h && k) ? 1 : 2; }
+int nested(void) { return g ? (h ? 1 : 2) : (k ? 3 : 4); }
+int mixed(void) { return (g > 1 || (h < 2 && k != 3)) ? g : h; }
+int assign(void) { int x = g && (h = 4); return x + h; }
+
+int main(void) { return 0; }
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Runs the constant and the variable form of the expressions from
+# gen_fold.py under bench/emu.py, optimized and at -O0, and compares what
+# they return. Folding must not change the value of an expression.
+#
+#   tests/fold.sh comp work_dir
+set -u
+comp=$1
+work=$2
+
+mkdir -p "$work"
+python3 tests/gen_fold.py 300 > "$work/fold.c" || exit 1
+count=$(grep -c '^int c' "$work/fold.c")
+
+fail=0
+for flag in "" -O0; do
+    if ! "$comp" $flag -o "$work/fold.s" "$work/fold.c"; then
+        echo "fold: $work/fold.c doesn't compile"
+        exit 1
+    fi
+
+    entries=$(seq 0 $((count - 1)) | sed 's/.*/_c& _v&/')
+    python3 bench/emu.py "$work/fold.s" $entries | paste - - > "$work/fold.txt" || exit 1
+    awk -v flag="${flag:-optimized}" '$1 != $3 { print "fold: c" NR - 1 " returns " $1 ", v" NR - 1 " " $3 " (" flag ")"; bad = 1 }
+                       END { exit bad }' "$work/fold.txt" || fail=1
+done
+
+[ $fail = 0 ] && echo "fold: $count expressions ok"
+exit $fail
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Random lexer input: identifiers, keywords, constants of every form,
+character literals, comments spanning lines and punctuator soup.
+
+    gen_corpus.py dir count [seed]
+
+writes dir/lex000.c ... One file in three gets a lexical error injected
+somewhere, so the error path is compared too. The files are not valid C,
+only valid (or invalid) token streams.
+"""
+import os
+import random
+import sys
+
+KEYWORDS = """int void char short long float double signed unsigned _Bool
+_Complex _Imaginary return auto break case const continue default do else
+enum extern for goto if inline register restrict sizeof static struct
+switch typedef union volatile while""".split()
+
+PUNCTUATORS = """( ) { } ; ! > < - + / * ~ & | % ^ ? : != == >= <= || && << >>
+++ -- = += -= *= /= %= <<= >>= &= ^= |=""".split()
+
+CONSTANTS = """0 1 7 42 123456 2147483647 2147483648 4294967295 4294967296
+9223372036854775807 9223372036854775808 18446744073709551615 0x0 0x1f 0XFF
+0x7fffffff 0x80000000 0xffffffffffffffff 00 0777 01234567 10u 10U 10l 10L
+10ul 10LU 10ll 10LL 10ull 10uLL 0x10llu 077UL""".split()
+
+CHARS = ["'a'", "'Z'", "'0'", "' '", "'\\n'", "'\\t'", "'\\0'", "'\\\\'", "'\\''",
+         "'\"'", "'\\x41'", "'\\x7f'", "'\\101'", "'\\377'", "'\\e'", "'\\?'",
+         "'\n'", "'/'", "'*'", "'\\x123456789abcdef'"]
+
+# each breaks lexing where it appears
+ERRORS = ["@", "$", "`", "#", "\\", "'ab'", "'", "09", "0x", "0xg", "1uu",
+          "10lul", "99999999999999999999999", "0x1ffffffffffffffff", "/*"]
+
+SPACE = [" ", " ", " ", "  ", "\t", "\n", "\n", "\r\n", "\n\n", "\n    "]
+
+
+def identifier(rng):
+    first = rng.choice("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_")
+    rest = "".join(rng.choice("abcdefghijklmnopqrstuvwxyz_0123456789")
+                   for _ in range(rng.randrange(0, 12)))
+    # a small vocabulary so identifiers repeat across chunks
+    return first + rest if rng.random() < 0.3 else "v%d" % rng.randrange(200)
+
+
+def comment(rng):
+    body = []
+    for _ in range(rng.randrange(0, 30)):
+        # no piece ends in '*', so the comment never closes early
+        body.append(rng.choice(["x", "* x", "/x", "'", "//", "/* ", "**x", "\n", " ", "int", "@"]))
+    if rng.random() < 0.5:
+        return "/*" + "".join(body) + "*/"
+    return "//" + "".join(body).replace("\n", " ") + "\n"
+
+
+def token(rng):
+    r = rng.random()
+    if r < 0.30:
+        return identifier(rng)
+    if r < 0.40:
+        return rng.choice(KEYWORDS)
+    if r < 0.55:
+        return rng.choice(CONSTANTS)
+    if r < 0.62:
+        return rng.choice(CHARS)
+    if r < 0.70:
+        return comment(rng)
+    return rng.choice(PUNCTUATORS)
+
+
+def separator(rng, previous):
+    # punctuators are often glued to the next token to exercise maximal
+    # munch, words and constants would merge into a bad constant instead
+    if previous in PUNCTUATORS and rng.random() < 0.4:
+        return ""
+    return rng.choice(SPACE)
+
+
+def program(rng):
+    out = []
+    for _ in range(rng.randrange(50, 4000)):
+        out.append(token(rng))
+        out.append(separator(rng, out[-1]))
+    if rng.random() < 0.33:
+        out.insert(rng.randrange(len(out) + 1), " " + rng.choice(ERRORS) + " ")
+    return "".join(out)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit("usage: gen_corpus.py dir count [seed]")
+    directory, count = sys.argv[1], int(sys.argv[2])
+    rng = random.Random(int(sys.argv[3]) if len(sys.argv) > 3 else 1)
+
+    os.makedirs(directory, exist_ok=True)
+    for i in range(count):
+        with open(os.path.join(directory, "lex%03d.c" % i), "w") as f:
+            f.write(program(rng))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Random expression programs for the parser tests and benchmarks.
+
+    gen_expr.py random count [seed]     count functions of 20 random expression statements
+    gen_expr.py mutate count [seed]     the same with one token deleted or replaced
+    gen_expr.py nested megabytes        deeply nested random expressions, for timing
+    gen_expr.py flat megabytes          flat 8-operand sums, for timing
+
+The programs stay inside what the parser before precedence climbing
+accepted (no nested prefix operators, no `&=`), so its dumps can serve as
+the expected output. Everything is written to stdout.
+"""
+import random
+import sys
+
+NAMES = ["a", "b", "c", "d", "e", "x", "y", "z"]
+
+BINARY = ["||", "&&", "|", "^", "&", "!=", "==", ">", ">=", "<", "<=",
+          "<<", ">>", "+", "-", "*", "/", "%"]
+PREFIX = ["++", "--", "+", "-", "!", "~"]
+ASSIGN = ["=", "+=", "-=", "*=", "/=", "%=", "<<=", ">>=", "^=", "|="]
+CONSTANTS = ["0", "1", "2", "7", "42", "0x1f", "017", "10u", "3L", "'a'", "'\\n'"]
+
+
+def expression(rng, depth):
+    r = rng.random()
+    if depth <= 0 or r < 0.2:
+        if rng.random() < 0.6:
+            name = rng.choice(NAMES)
+            return name + rng.choice(["++", "--"]) if rng.random() < 0.1 else name
+        return rng.choice(CONSTANTS)
+    if r < 0.3:
+        # prefix operators only nest through parentheses in the old grammar
+        operand = expression(rng, depth - 1)
+        if operand[0] in "+-!~":
+            operand = "(" + operand + ")"
+        return rng.choice(PREFIX) + operand
+    if r < 0.75:
+        return "%s %s %s" % (expression(rng, depth - 1), rng.choice(BINARY), expression(rng, depth - 1))
+    if r < 0.85:
+        return "(%s)" % expression(rng, depth - 1)
+    if r < 0.93:
+        return "(%s ? %s : %s)" % (expression(rng, depth - 1), expression(rng, depth - 1),
+                                   expression(rng, depth - 1))
+    return "(%s %s %s)" % (rng.choice(NAMES), rng.choice(ASSIGN), expression(rng, depth - 1))
+
+
+def statement(rng):
+    r = rng.random()
+    if r < 0.15:
+        return "int %s = %s;" % (rng.choice(NAMES), expression(rng, 4))
+    if r < 0.45:
+        return "%s %s %s;" % (rng.choice(NAMES), rng.choice(ASSIGN), expression(rng, 4))
+    return "%s;" % expression(rng, 4)
+
+
+def function(rng, index):
+    body = ["    int %s = %d;" % (name, i) for i, name in enumerate(NAMES)]
+    body += ["    " + statement(rng) for _ in range(20)]
+    body.append("    return %s;" % expression(rng, 3))
+    return "int f%d(void) {\n%s\n}\n" % (index, "\n".join(body))
+
+
+def mutate(rng, text):
+    # token boundaries are close enough to spaces for this
+    words = text.split(" ")
+    i = rng.randrange(len(words))
+    if rng.random() < 0.5:
+        del words[i]
+    else:
+        words[i] = rng.choice(BINARY + ASSIGN + ["(", ")", ";", "?", ":", "x", "1"])
+    return " ".join(words)
+
+
+def sized(megabytes, line):
+    out, size = [], 0
+    while size < megabytes * (1 << 20):
+        text = line()
+        out.append(text)
+        size += len(text) + 1
+    return "int main(void) {\n    int a = 1;\n    int b = 2;\n%s\n    return a;\n}\n" % "\n".join(out)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    mode, count = sys.argv[1], float(sys.argv[2])
+    rng = random.Random(int(sys.argv[3]) if len(sys.argv) > 3 else 1)
+
+    if mode == "random":
+        print("\n".join(function(rng, i) for i in range(int(count))))
+    elif mode == "mutate":
+        print(mutate(rng, "\n".join(function(rng, i) for i in range(int(count)))))
+    elif mode == "nested":
+        NAMES[:] = ["a", "b"]
+        print(sized(count, lambda: "    a = %s;" % expression(rng, 12)))
+    elif mode == "flat":
+        print(sized(count, lambda: "    a = %s;" % " + ".join(rng.choice(["a", "b", "1"]) for _ in range(8))))
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Constant expressions next to the same expressions on variables.
+
+    gen_fold.py count [seed]
+
+writes a program with functions c0 ... and v0 ... to stdout. ci returns
+an expression of constants, vi the same expression with the constants
+moved into int variables first. fold_program() folds the first, the
+generated code (or SCCP) computes the second, so the two must return the
+same value. The constants all survive being stored in an int and loaded
+back, the ones too wide for that stay constants in both forms.
+"""
+import random
+import sys
+
+# the first ones are from the review of the folding commit
+FIXED = ["2147483647 + 1 < 0", "4294967295u + 1 > 0", "-2147483648 - 1 > 0",
+         "2147483648 * 2 == 0", "-1u > 0", "~0u == -1", "4294967295u / -1"]
+
+CONSTANTS = ["0", "1", "2", "7", "255", "65535", "65536", "2147483647",
+             "2147483648", "4294967295", "4294967295u", "0x80000000",
+             "0xffffffff", "3000000000u", "10u", "5UL"]
+WIDE = ["0x7fffffffffffffff", "0xffffffffffffffff", "9223372036854775808",
+        "4294967296"]
+
+BINARY = ["+", "-", "*", "/", "%", "&", "|", "^", "==", "!=", "<", "<=",
+          ">", ">=", "&&", "||"]
+PREFIX = ["-", "~", "!"]
+
+
+def expression(rng, depth):
+    r = rng.random()
+    if depth <= 0 or r < 0.15:
+        return rng.choice(WIDE if rng.random() < 0.1 else CONSTANTS)
+    if r < 0.3:
+        return "%s(%s)" % (rng.choice(PREFIX), expression(rng, depth - 1))
+    if r < 0.4:
+        return "(%s ? %s : %s)" % (expression(rng, depth - 1), expression(rng, depth - 1),
+                                   expression(rng, depth - 1))
+    return "(%s %s %s)" % (expression(rng, depth - 1), rng.choice(BINARY), expression(rng, depth - 1))
+
+
+def on_variables(text):
+    """the expression with every narrow constant read from a variable"""
+    words, decls = [], []
+    for word in text.replace("(", " ( ").replace(")", " ) ").split():
+        if word in CONSTANTS:
+            decls.append("    int x%d = %s;" % (len(decls), word))
+            word = "x%d" % (len(decls) - 1)
+        words.append(word)
+    return decls, " ".join(words)
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    rng = random.Random(int(sys.argv[2]) if len(sys.argv) > 2 else 1)
+
+    expressions = FIXED + [expression(rng, 3) for _ in range(int(sys.argv[1]))]
+    for i, text in enumerate(expressions):
+        decls, variables = on_variables(text)
+        print("int c%d(void) {\n    return %s;\n}" % (i, text))
+        print("int v%d(void) {\n%s\n    return %s;\n}" % (i, "\n".join(decls), variables))
+    print("int main(void) {\n    return 0;\n}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Compares the token dumps of the sequential and the parallel lexer on the
+# sample programs and a generated corpus, for several chunk sizes. Chunks
+# of a byte or a few split at every line, so comments and character
+# literals spanning lines land on chunk boundaries all the time.
+#
+#   tests/lexer.sh lexer_dump work_dir
+set -u
+dump=$1
+work=$2
+
+mkdir -p "$work"
+python3 tests/gen_corpus.py "$work/corpus" 60 || exit 1
+
+fail=0
+for file in sample/*.c "$work"/corpus/*.c; do
+    "$dump" "$file" > "$work/seq.txt" 2>&1
+    for chunk in 1 7 64 500 5000; do
+        "$dump" -c $chunk "$file" > "$work/par.txt" 2>&1
+        if ! cmp -s "$work/seq.txt" "$work/par.txt"; then
+            echo "lexer: $file differs with chunks of $chunk bytes"
+            diff "$work/seq.txt" "$work/par.txt" | head -5
+            fail=1
+        fi
+    done
+done
+
+[ $fail = 0 ] && echo "lexer: $(ls sample/*.c "$work"/corpus/*.c | wc -l) files ok"
+exit $fail
@@ -0,0 +1,60 @@
+#include "../src/lexer/lexer.h"
+#include "../src/lexer/intern.h"
+
+/**
+ * Prints the token stream of a file, one token per line: kind, offset,
+ * text, and the symbol id of an identifier or the value and type of a
+ * constant. "error" is printed when the lexer gives up, after whatever
+ * it reported on stderr.
+ *
+ *   lexer_dump file              the sequential lexer
+ *   lexer_dump -c size file      lexer_parallel() on 4 threads, in chunks of `size` bytes
+ *
+ * The dumps of both must be identical, see lexer.sh.
+ */
+int main(int argc, char **argv)
+{
+    long chunk_size = 0;
+    if (argc == 4 && strcmp(argv[1], "-c") == 0) {
+        chunk_size = strtol(argv[2], NULL, 10);
+        argv += 2;
+        argc -= 2;
+        if (chunk_size <= 0) argc = 0;
+    }
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: lexer_dump [-c chunk_size] file\n");
+        return 2;
+    }
+
+    struct source *src = source_open(argv[1]);
+    if (src == NULL) return 2;
+
+    struct token_store *tokens;
+    if (chunk_size > 0) {
+        struct pool *pool = pool_init(4);
+        tokens = lexer_parallel(src, pool, (size_t) chunk_size);
+        pool_free(pool);
+    } else {
+        tokens = lexer(src);
+    }
+
+    if (tokens == NULL) {
+        printf("error\n");
+    } else {
+        for (int i = 0; i < tokens->count; i++) {
+            struct token t = token_store_at(tokens, src->data, i);
+            printf("%d %u %.*s", t.type, t.offset, t.length, t.value);
+            if (t.type == TOKEN_IDENTIFIER)
+                printf(" #%d", t.symbol);
+            if (t.type == TOKEN_CONSTANT)
+                printf(" =%llu/%d", (unsigned long long) t.constant.value, t.constant.type);
+            printf("\n");
+        }
+        token_store_free(tokens);
+    }
+
+    intern_cleanup();
+    source_close(src);
+    return 0;
+}
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Compares the AST dumps (and diagnostics) of tests/parser/*.c with the
+# expected ones. random.c and mutated*.c were generated by gen_expr.py and
+# their expected dumps come from the precedenceN parser that precedence
+# climbing replaced, so any change in tree shape shows up here. prefix.c
+# and and_assign.c pin the two inputs that parser rejected.
+#
+#   tests/parser.sh ast_dump work_dir
+set -u
+dump=$1
+work=$2
+
+mkdir -p "$work"
+fail=0
+for file in tests/parser/*.c; do
+    expected=${file%.c}.expected
+    "$dump" "$file" > "$work/ast.txt" 2>&1
+    if ! cmp -s "$expected" "$work/ast.txt"; then
+        echo "parser: $file differs from $expected"
+        diff "$expected" "$work/ast.txt" | head -5
+        fail=1
+    fi
+done
+
+[ $fail = 0 ] && echo "parser: $(ls tests/parser/*.c | wc -l) files ok"
+exit $fail
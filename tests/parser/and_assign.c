@@ -0,0 +1,9 @@
+// `&=` is an assignment like the other compound operators; the
+// precedenceN parser rejected it.
+int main(void) {
+    int x = 6;
+    x &= 3;
+    x &= x & 1;
+    (x &= 1) + 2;
+    return x;
+}
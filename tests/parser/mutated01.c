@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    int b = -a >> 0 - ++b || y;
+    ((d %= -e)) % (42 ? y : (z ? d >> x++ : (z)));
+    (d == 7 >> z % 017) / (x == x || 10u || 3L);
+    (((('\n'))) ? 10u : 7);
+    c %= ~c;
+    y >= 3L == (y = !c) + -(z *= x) && a | 017 >= a;
+    z -= (((b + y) ? 0 != c == ~x : (a++) != ('a' ? x : 'a')));
+    (y) & (017) | ++e - (e++ ? a : c) != 017 >> (z == a);
+    z == 3L * e << z-- > e ^ b || (b) || ++(2) / (2 & 0x1f);
+    e -= (0 ? ((d + d)) : 017);
+    (a + x & 42 ? a <= 10u > +d : (d++ ? 0x1f : 7) < ~c) - ((c ? 0 : x) ? (3L) : (e += 2)) | (y ? z : 017) ^ a / d;
+    e -= ++(!2 << 'a' >> 0) || (c += x <= z) % (y) % d;
+    ((e -= 7) << y | '\n' < 017 >= 'a' || '\n' % e);
+    y++;
+    c;
+    e |= ~3L << a % !c >= d > ('a');
+    y *= (2);
+    (c |= (z ^= 10u)) << e++ >> 2 && d * ((z %= c--)) > e >> 0x1f * 0 || 0x1f;
+    (++c);
+    int c = (++42 && e + c == '\n' > c % 3L + 3L ? 1 >= a + (z ? c : y) - b : (c ? : x) >> (z += 3L) % (e) == x | '\n');
+    return 3L / x <= (e) << ((b |= z) ? (d |= x) : c-- > 2);
+}
+
@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    (a += '\n');
+    -(~017);
+    ((e = x) + (d ? x : z) / ((z) ? (d) : (0x1f ? z : z)) ? ++42 * 3L % e * 'a' : (1 && b & d));
+    int a = d;
+    int b = 0;
+    c -= d && '\n' ^ -0 >= 2 * (b %= c);
+    (--3L && !z ? (z++ > 0x1f ? -a : 7 ^ d) : 10u) < y || y != (a ? 42 : 42) || (a && d ? e | b : 017 ^ x);
+    0 * +(c %= ~y);
+    c >>= 'a' ^ c | ('\n') && d <= y++ / +d & c && y * '\n' | 7;
+    017;
+    z ^ 'a';
+    ((7 ? +(c-- ? c : 1) : b) ? a << 017 >= 2 && z & a : c % e < y | c | ++e++ >> (x ? e : '\n'));
+    e %= 10u;
+    x -= (~(x)) / '\n' < 1 << x | y || b;
+    (--e << c <= e++ > '\n' && b >= b);
+    (y >>= b % y) - z++ - (c += (c += 42 ^ a));
+    '\n';
+   x (a / a / x & z ? y : (c ^= '\n') == x + e);
+    ++((d <<= '\n')) || (~c) >= 7 & d & b - 2;
+    --(a ^ 0 ? ~y : (2 ? z : 'a')) * ((x ? c : e++)) == (a %= 10u | 0);
+    return !(~1 - (d ? 7 : 0x1f));
+}
+
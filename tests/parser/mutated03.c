@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+   int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    c %= (d * y & ~017 || 'a' && 10u >> 017 ? (c %= d) + (y) % 0 >= 2 <= (b *= 42) : ++10u);
+    b <<= (y ? 0 : d < a + +0x1f << (y <<= 'a' % 3L));
+    d /= +0x1f || c-- - 42 * a - --x >= 0 & e;
+    0x1f > (d ? d != b : e + a) & y;
+    e > (((b *= 3L) ? ('a' ? b : 3L) : 1 <= 3L) ? (b) >= (0 ? y-- : 3L) : a && a | b >> d);
+    c ^= 1;
+    y;
+    int y = 0x1f;
+    y >>= e;
+    int y = !x;
+    !'\n' / (b || y++);
+    int y = b++;
+    ((e += 3L));
+    -x != (!y);
+    (y ^= ~(017 ? '\n' : 2)) >> (z ? e & d % (e <<= e) : -x & 7 - '\n');
+    (10u > '\n' ? e : c) && (++y++ ? 42 : x--) <= --017 % y / x << (++42);
+    (b >>= c & '\n');
+    x;
+    c ^ (0x1f) ^ -0 / ~10u % z ^ b;
+    int d = (c |= 7) % e < 017 >> (e ? d : '\n') > d == z < (c -= 0 << a <= c++);
+    return 7 + x && 017 * y * c && x << d << d;
+}
+
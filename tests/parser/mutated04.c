@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    b <<= e && ~(++d >= (x--));
+    d -= +(~(e = (3L ? e : a--)));
+    1 + (y <= x ? d : (e >>= b)) < (a %= !017) | !c;
+    c << (b >>= (y *= c));
+    42 + d + y * e == (x >> 0) * (2 ? '\n' : d) >= e == 2 >= z >> (c-- ? 017 : d);
+  ^  (((b ? 2 : a)) << (y));
+    ((0x1f / z++ ? b != c : (0 ? e : 'a'))) * c || 0x1f % (42 ? z : x) <= c;
+    !(d |= (c << a));
+    ((((c -= b))));
+    '\n';
+    -((7 ? 42 : 3L) / (y ^= 42));
+    a /= x;
+    a -= (x |= (10u)) > d++ && '\n' % d ^ 1 ^ !(2 & 1 ? 3L & e : e);
+    (0 < c || -c >> d << 'a' && e ? ((x)) && b && d++ <= (1) : ((d) ? 0 || x : 017 >> b) / +017 <= y);
+    y <<= ~e & c == (e *= (x++ ? b : c)) | (a -= x << d++) != (a /= 10u) ^ (z);
+    y = (d);
+    d |= x % -x && (y -= z) || y <= --a > a;
+    c;
+    x ^= x <= (a ^= d);
+    7;
+    return (c ^= 1 && 3L != -e);
+}
+
@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    c <<= x / ++d--;
+    a;
+    d = b % (d);
+    d;
+    ((d-- / z ? (b ^= 2) : (y = x)) << 42 * e - -0);
+    b >>= 2;
+    (e + (x ? b : z) ? c : 3L && '\n' % y++ == a) & (a += (e ? b : z)) & e;
+    +(x -= 42 | x) > (7 > 7) == e == 10u << (x += d);
+   * (a >>= (y == x-- - 2 & z ? 10u : a ^ 017 == (e)));
+    (10u) / (a ? 2 : b) <= b && b % 1;
+    d /= (e ^= z) ^ 017 | b & (x -= -b) != (d -= (y %= b) || 017 <= b);
+    +(c ? e : e++ + a >= 1);
+    (d ? c : d) / 42 && 3L == -'\n' * 42 == c << (c = 42);
+    a += (d /= e) >= 0x1f > 7 << b / -(2) && ~c >> (e);
+    3L;
+    (a) > x;
+    z ^= d;
+    int b = 42 | d - e == e < z ^ e - 3L == e / (z /= 1 | x);
+    (-a - y <= 017 ? 0 : (-b ? (a) : +e)) == ((017 % 0));
+    10u && (e >= z ? d * x : b % e) == (y && x / 1 >= z ? (y) * (z = 3L) : ((d += b) ? 10u | c : (c ? b-- : y)));
+    return (z);
+}
+
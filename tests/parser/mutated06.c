@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    0 <= (a ? 017 : b) | (e > b);
+    0 + z > (b ? 0x1f : a) * d | 0 && 2;
+    <<= > x / (x) >> 0;
+    x = +1 / y > 1 >> 3L & 42 || 2;
+    c += d < (x /= c) % -c;
+    (--a & 1 > (!y-- ? (b = y) : 1 % d));
+    int z = 0x1f > ('a' ? 0 : a) + c++ << b <= 'a' & (z -= d);
+    int d = b;
+    7 || d-- || (y = x) > c >> 42 ^ y * ((e ? z : b) ? '\n' & z : 017 == 1) || 3L / 42 % ++0x1f;
+    int x = y;
+    c ^= -c || 42 / (42 < d ? 'a' : x++) % (d & (y++ ? 10u : y));
+    d ^= b;
+    d >>= (c ^= 0x1f);
+    (c = 'a');
+    d && 'a' == 017 / y + '\n' ^ x << 0 / (b *= (42 ? c : x)) != 7 | z;
+    017 != y;
+    ((0x1f ? y : 1) && (7 ? x-- : 1) ^ (y-- == 10u) ? e : b >= 1 / y == ~3L <= (z = 10u));
+    0x1f;
+    int z = 'a';
+    int z = (a /= 'a' >= a) <= 0x1f <= x <= 42 ^ a * z;
+    return (c += e--) && 42 ^ 2 >= ~'\n' == e >> c;
+}
+
@@ -0,0 +1,31 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x =    int y = 6;
+    int z = 7;
+    ++(2) / 0x1f && y >= '\n' << 7;
+    c < (!z--) != ((d = b));
+    x;
+    int b = (d %= c >= c * (a)) <= -(!10u > 42);
+    z;
+    int x = y || c - (y) - +(c) && 10u || 017 > b < x;
+    b;
+    b /= (d << 0 == d-- | x == ~e <= 10u * x ? ((y |= 42)) || x != a | (d |= a) : ('a' ? (a) : y != x) || z << 10u * 2 << 0x1f);
+    0 != x && 7 && x < (a <<= c - a != y >> b);
+    (3L) * y ^ 1 >> d % a-- <= (x);
+    e;
+    d <<= a != a != a - y * (x += b) & -(e <= y ? a : e + b);
+    0;
+    c >>= (z) * 7 * y <= a <= (a <<= (0 ? 0x1f : 'a') | 10u);
+    c -= (7 & (z) >> (c));
+    10u;
+    int d = (z -= e * x / (y ? 1 : b) != (b ? z | y : (z)));
+    !z % a << d != 3L && e;
+    c >>= z << 0x1f >= c;
+    ++(z /= 0x1f < x) + x || (y = z);
+    return (++10u) % (!'\n');
+}
+
@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    (z != b && c / d ? (d * e) : (b /= e++) >> b) || -(y ? 0x1f | y : b--);
+    d >>= (c <<= d-- || !'\n') ^ z;
+    +d-- - c;
+    c /= ((--3L) ? b-- > y * --1 > d == y && c++ : ((c |= x) ? (a |= 0x1f & x) : (0x1f << b ? 'a' || a : 42)));
+    1 / b > (b >>= 10u) >= (3L != z ? --y : (x a : c)) * ++(!x - 42);
+    -d-- > '\n' ^ 0x1f | z || (x / 2);
+    ~(d ? x : b) >> (e ^= 42) || y * (+a ? z * 7 : 3L != 3L);
+    y |= --((e |= a || y) ? (b >>= z) : (y /= ++z));
+    a /= 0;
+    int c = +b >= 017 || c % c << (7 == d ? y : y || x);
+    int x = b-- & c < (z++ ? x++ == x == 0x1f | '\n' : (d ^= 42 ^ 017));
+    int x = (((1)) <= '\n' && --0x1f ? '\n' == 'a' || d >> (e) <= 'a' ^ 1 : (y -= 10u) % 017 < x * 42 || a + (017));
+    int x = 017;
+    --(z);
+    10u;
+    int a = c - 2 < b < (e) == (d) && a ^ b;
+    d %= 1 - 7 - 0x1f & 0x1f < x - b * (0) | (x & 0x1f ? 'a' >= 42 : 3L > 0) << 0x1f >> 'a' != 42;
+    ~e;
+    b | 1 + +3L - 10u * 'a' && 0 >> 3L || (c) != (y -= e) && c - a == d;
+    ('\n' % e ? 1 * d : (e)) && --x + x / 'a' >= c++ & b;
+    return 3L / (1) - +c;
+}
+
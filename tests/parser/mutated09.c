@@ -0,0 +1,32 @@
+int f0(void) {
+    int a 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    c *= (d || 0 >= e ? (e %= y) + e % 10u : x - c % -x) - (a *= 10u) >= e << !(2 ? 7 : a);
+    int x = b;
+    y |= x / 1 + !x && z / (!017);
+    y;
+    --(+x >> a < y < (c = 7) < c-- - y--);
+    c;
+    (1 << -(d) ? a : (x ? ++(e /= a) : 1));
+    ((a) < c - e > (d %= 10u + z));
+    z *= 10u;
+    c;
+    (++017) % 2 < (y);
+    z = ~x && a & 2 << c && a << y-- / b <= y || (z <<= a++);
+    int x = (d <<= (e = -(b += 3L)));
+    (c -= c) + ((a ? 2 : 42)) + +(+017);
+    +(b);
+    int d = b-- & ~z++ >= c / y;
+    int x = c + (y += 'a' >> y) + c % b;
+    (d && 0 ? (017) : (017)) >> d + !y;
+    int z = 'a';
+    a--;
+    return ++d + (~c);
+}
+
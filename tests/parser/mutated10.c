@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    int d = ++(~017 >> d <= '\n' / e);
+    int x = y;
+    (x ^ d ? e | c : b) != b >> 10u | z-- + 0x1f * ++10u >= d;
+    ++(x /= 7);
+    e -= +(--c ? 3L % a : (z %= 2)) == 7;
+    0;
+    !c != 7 << (a |= b && '\n');
+    (1 ? (((b = c)) ? (10u ? (e--) : !0) : (d = (017 ? x++ : e))) : (z >> y) || 1 > b | d < d);
+    int b = d << (42 && 2) >= a * c || --'a';
+    x / a-- != d < b | d >> x * (1) % +(c >>= b) ^ (b && a ? -c : 1);
+    x >>= ((y -= (017)) < ('\n') ^ +c);
+    int d = '\n';
+    d;
+    ~((017));
+    (z *= e == b >> 0x1f + a | 10u >= y++ | d);
+    (y >>= 42 >> c < '\n') * +(c ? a : 0x1f) | ++b > x + 0;
+    (017 ? c : <= e) * (z * y ? 3L : 42 + a) % (a ^= b) != (y);
+    d += 017;
+    d /= 0x1f;
+    ((e >>= 'a') ? 017 >> 1 : +d) * (e ? e : z) >= 017 >= (c * 3L >> b ? c - e << y >= 2 : !('\n'));
+    return --(a >>= 3L) && (a -= 1 & z);
+}
+
@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    z %= --(z -= b != 7 != -d);
+    --(e) < c != 017 & 'a' >= z++ * b;
+    (c | 2 >> x <= 2 + (a |= '\n' + z));
+    int e = 2 > 0x1f < x != d | d < x;
+    (c <<= (42 + e) | ~z--);
+    z ^= ~x | --((3L ? '\n' : 3L) ? d-- << e : c - c);
+    a < 'a' || 3L == 42 > c++;
+    (e & 0x1f) % (1 & e ? +x : a) == ((c %= a));
+    ((a *= 0x1f <= 0x1f >= -0x1f));
+    b /= (d >= x) * ~d >> x-- + (('\n'));
+    (('\n' ? d / y : ~x) != --d ? (b >>= ('\n' ? e : b)) <= (0) | (c) : (a = (b |= d) >> ++y));
+    ((y-- ? 42 : x) ^ 0 ^ +2 >> (y) ? (e ^= 'a' - b ^ ++0x1f) : -10u / -(c ^= c));
+    017 % a % d < b + x-- && --c != e * 2 & (+c ? b * z : z * a);
+    +2 && 1 != z * c;
+    (a ? -'a' < e : (!a ? c ^ 1 : e)) - 10u;
+    / y = ~y > ~x + ('\n') == x;
+    b <<= 0;
+    int e = b;
+    d >> c--;
+    c <<= (x) + d && z && a;
+    return (a /= c);
+}
+
@@ -0,0 +1,32 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    y /= ++((d)) << (y += 7);
+    (y |= (z += 0) & 0 - 017) * 10u;
+    !(--(b += y));
+  =  x >>= !z++ / --b << (7 ^ 2) + 017 != x >> b + e-- < y--;
+    z++;
+    x << 42 & a & (a /= 'a') + !(c -= c--) & e;
+    (7 % (a) ? b : ('a' ? y : 3L) % a <= d--) == (b += 10u) / 10u * y++ && y - (d);
+    z;
+    ++'\n' >= 017 < 0 != y | y - (c <<= d);
+    e -= (--y + '\n' >> 7 && 0x1f || y ? --b - y && 7 > 'a' : ((b ? (2) : 'a') ? 2 >= a | d << z : (x + y++)));
+    a %= z - (7) % d << e >> 3L / (+z ? (x ? c : 0) : (d += x));
+    y;
+    c >> ~7 && (e);
+    c <<= e;
+    z;
+    int c = 42 ^ z == 42 > e < 10u == '\n' / a + 'a' / 'a';
+    2 << z > 10u > 1 << 0x1f <= !d != (++b);
+    --b + a <= 017 && z | (e);
+    x >>= (b) & (b) - (017 ? 7 % (e ? 0 : a) : 0);
+    --e != x & ++1 > 2 >> e > (017);
+    return 017 >> c && b ^ (1);
+}
+
@@ -0,0 +1,12 @@
+// Prefix operators nest (`- -x`); the precedenceN parser rejected this.
+int main(void) {
+    int x = 5;
+    - -x;
+    !-x;
+    !~x;
+    - - -x;
+    ~++x;
+    -x++;
+    -!x * - -x;
+    return - -x;
+}
@@ -0,0 +1,256 @@
+int f0(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    int b = -a >> 0 - ++b || y;
+    ((d %= -e)) % (42 ? y : (z ? d >> x++ : (z)));
+    (d == 7 >> z % 017) / (x == x || 10u || 3L);
+    (((('\n'))) ? 10u : 7);
+    c %= ~c;
+    y >= 3L == (y = !c) + -(z *= x) && a | 017 >= a;
+    z -= (((b + y) ? 0 != c == ~x : (a++) != ('a' ? x : 'a')));
+    (y) & (017) | ++e - (e++ ? a : c) != 017 >> (z == a);
+    z == 3L * e << z-- > e ^ b || (b) || ++(2) / (2 & 0x1f);
+    e -= (0 ? ((d + d)) : 017);
+    (a + x & 42 ? a <= 10u > +d : (d++ ? 0x1f : 7) < ~c) - ((c ? 0 : x) ? (3L) : (e += 2)) | (y ? z : 017) ^ a / d;
+    e -= ++(!2 << 'a' >> 0) || (c += x <= z) % (y) % d;
+    ((e -= 7) << y | '\n' < 017 >= 'a' || '\n' % e);
+    y++;
+    c;
+    e |= ~3L << a % !c >= d > ('a');
+    y *= (2);
+    (c |= (z ^= 10u)) << e++ >> 2 && d * ((z %= c--)) > e >> 0x1f * 0 || 0x1f;
+    (++c);
+    int c = (++42 && e + c == '\n' > c % 3L + 3L ? 1 >= a + (z ? c : y) - b : (c ? e++ : x) >> (z += 3L) % (e) == x | '\n');
+    return 3L / x <= (e) << ((b |= z) ? (d |= x) : c-- > 2);
+}
+
+int f1(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    (a += (e += --b));
+    0;
+    ((~d) << (z += 42) + -3L ? 3L : (10u || a));
+    (x ^= (e ^= 3L) + c & 2) >= (a %= '\n' || 0) >> -(+10u);
+    y;
+    (017 >= (e <<= 10u == y));
+    int c = +1;
+    b <<= y && 1 % 1 >= 0 == y - !z >> 2;
+    e >>= (((1) ? '\n' : 0 % b)) >= ++(!y);
+    e < ~(--c - x);
+    (d %= 42 > a ^ ++e);
+    ((+0x1f >= a));
+    int e = (x++ ? ++(+y > a) : (42 >> z) % (e *= b == a));
+    e >>= 0x1f;
+    int x = (c & 10u <= y >> 42) < ('\n' & b) + z-- && 0 ^ 3L >= x;
+    ~(~a <= 42);
+    (y);
+    (~b != 0x1f) ^ (a >>= (d-- <= 10u ? '\n' == b : (y ? 2 : e)));
+    b /= d;
+    a ^= ((c -= --2 >> a == '\n'));
+    return (b *= b * a-- - ~x);
+}
+
+int f2(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    y ^= y;
+    --(+(~1) ? x - 42 : ~d);
+    1 & (017) + b >> y != !b < e;
+    (--0x1f) & (b += (y == c ? 7 >> d : 3L > '\n'));
+    e >>= 2;
+    a >>= (d++ + c == (d) | c < y-- / 017);
+    x >>= (a ^= (z = e-- + a ^ b));
+    x ^= b;
+    ((x) & (x ? x : b) > (+b++));
+    c /= ~0 / (1 ? e : x) && c && d & e && 'a' << 0 || (a -= --b);
+    int d = ~(--7 != 'a' + b + x--);
+    ('a' - e / e || z) << !'\n' & b || +y--;
+    (0x1f);
+    int b = 017;
+    ~(c ^= z | d > d < 0);
+    x / e >= 1 * e > c;
+    (b *= a++);
+    int x = d >= !(!a - b++);
+    (++1);
+    (2 ? +(a |= d) ^ b++ : (7 ? y : d) * (1 ? 017 : x) << 3L || e % c | x);
+    return 42;
+}
+
+int f3(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    int c = (((c) ? d : 0x1f / 0x1f) ? e == 42 : e || 7 << b / 'a') % ((x | c ? ++a : 1 - x));
+    ((-a ? x < 'a' : b) <= x);
+    e /= (y = -d * 0x1f & d);
+    z *= 1;
+    z;
+    (z << 0x1f - !10u << a);
+    c |= a != (z += c / y) / 42 == -x;
+    10u % (1) % a - x != (0);
+    (7);
+    x >>= x != 'a' * c > 10u & a << (y = e >> 2) ^ x * x <= y == d--;
+    ((x %= 017 == 42) > (y -= 0x1f) > +d);
+    int a = (c);
+    (y);
+    (d *= 2) & c <= c * b * c << a == ++e++ ^ (y);
+    z /= x;
+    y %= (d *= a);
+    z |= a--;
+    d %= ((x << '\n') ? c || y++ & 017 % (d ^= b-- ^ d) : d-- && a * x * z != 017);
+    42 || b >= (42) & 10u && (a ? 1 : e) / x - x && b;
+    int e = (-(--y < 42 && e));
+    return (0) + (y %= (c -= a));
+}
+
+int f4(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    --(--b || e) >> (d ^ 017) == b << 'a' + 0;
+    (c <<= y);
+    e >>= !(2) % ((a ^= 10u >= b));
+    c;
+    ((b && a)) && 'a';
+    e += ((3L ? 7 : 42) ? (e ^= a) : ++d) >= 'a' | a >> 42 > -(z %= d) % b > e >= (a ? d-- : b);
+    c |= ((z = a | b) ? -y / b : 3L || x + b) && y;
+    -(--42 % b != 42 || a);
+    'a';
+    017 > z;
+    (--(e <<= 'a') ? 'a' << z-- ^ 10u << '\n' : 3L) <= e;
+    (e += ~c) | z * (b) && e;
+    7 > (d) != !a / 7;
+    -(d = y <= z) + c;
+    ~(x ? 3L : b) >> 'a' >= d >> z;
+    z;
+    42 | 3L << (y <<= a) << (b |= (2)) & ((d / 7 ? +y : x == e));
+    ((2 ? (a++ >= e ? (b ? x : 017) : 0 - x) : 'a' - 1 + a-- << 2) ? ((2 * e) ? 3L : (y -= c | 017)) : ++42 != (b));
+    (((d++ ^ a) ? c : 017));
+    (c) >> ((b && 42));
+    return a;
+}
+
+int f5(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    (--'\n') < (0) << ('\n' ? e : 2) % ++(+c + (e ? 7 : x));
+    (1);
+    (y);
+    ((x) >= z % c);
+    d += (d += (y %= 017)) <= (e <<= (b)) + -a > e || d;
+    '\n' != (+a & !c ? +'a' * +x : 10u != b <= 0);
+    b |= (d && 0 ? 42 : (y)) != b + (a *= b >> d * (y ? e : z));
+    e = (3L || 0x1f ^ d--) / '\n' || 2 && '\n' + z;
+    e *= --2 >= 3L > (1) >= c;
+    int d = ++10u + 017 << e & y-- * -(a ? y << 7 : b++ <= y);
+    int d = z;
+    --z;
+    z |= (a ^= c);
+    d-- & 'a';
+    c += ((y ? b > 2 % +'a' : (x ^= !d)) ? (y != 0x1f) - 'a' : z == b);
+    int d = (a < z > y || 0x1f % ('\n' ? a && 7 : 2 - c));
+    y << ++(~d <= d == 'a');
+    c | c << b << x || 017;
+    c /= (d %= (!2 ? e > 2 : (y %= 10u))) && y || z & (x += 7) % x & 1 & (0x1f);
+    int c = 017 >> x << !d && 1;
+    return (a *= y);
+}
+
+int f6(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    b <= (b += (d *= b << b));
+    z |= d--;
+    x |= 0x1f / x-- + 7 >= a ^ c % 017 && 0x1f / --d | c++ == y;
+    3L;
+    (e ? 017 << a - 42 : (y ^ 0 ? a | 7 : (d ? 1 : 'a'))) - +(+('\n' ? 10u : 0));
+    (((7 - c) ? b != 3L % (42 ? z : y) : (('a') ? ('a' ? z-- : 42) : 3L <= d)) ? d : y);
+    +1 + +c++ / a;
+    int e = (d);
+    x;
+    int a = x;
+    e++;
+    z = (('a') || (0x1f));
+    (z + e && x == x);
+    int d = b < (z |= z & c) & (z ? 017 : '\n') + 7 >> 'a';
+    a > --(0x1f) | 1 || 1 & 017 <= 0x1f;
+    c <<= z;
+    a;
+    -2 / 'a';
+    e -= a || (-(-'a'));
+    b -= ~2;
+    return z;
+}
+
+int f7(void) {
+    int a = 0;
+    int b = 1;
+    int c = 2;
+    int d = 3;
+    int e = 4;
+    int x = 5;
+    int y = 6;
+    int z = 7;
+    int d = 1 < !(e) ^ -10u;
+    017;
+    (d % d * --x++ ? '\n' - e / (017) : ('\n' > 017)) == (0 > b) << y - (d);
+    int d = y;
+    b = (z |= 0 ^ 0 / y % a == e & e != c && 10u);
+    b + e < ~a ^ 3L & b;
+    ((1 / 7 << 2 + e));
+    017 & 42 >= 42 / c * (c *= x + d) * (017 >= c) >> 0x1f;
+    int z = ((c = e) && -e << (42 ? e : e--) ? 42 : 0x1f || 10u > z < 'a' && '\n' - d && 3L);
+    (z ? b & c : (3L)) == (a ^= 1 <= x) >> '\n';
+    z ^ 2 >= (a += a--) <= a >> 0;
+    int d = (z <<= (c /= c == 7 * y + 42));
+    (x += (((e) ? 0x1f >= 1 : z % z)));
+    c;
+    int c = 10u << z - (d) < 017;
+    ((017 | 0x1f) << !(10u) ? y : ++e && (b & 0 ? 0 - e : (a *= 7)));
+    (e -= --0x1f / a--);
+    int e = (x | d ? b ^ 3L : 0x1f > '\n') < (y) & ((e / z));
+    int x = ~e == (42 ? c : 'a') && z == ((+x ? y : (y++)));
+    y |= '\n';
+    return (x) || 42 || 017 & y;
+}
+
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Compiles tests/values/*.c optimized and at -O0, runs them under
+# bench/emu.py and compares what main returns with the .expected file,
+# which holds what gcc's build of the same program returns.
+#
+#   tests/values.sh comp work_dir
+set -u
+comp=$1
+work=$2
+
+mkdir -p "$work"
+fail=0
+for file in tests/values/*.c; do
+    expected=$(cat "${file%.c}.expected")
+    for flag in "" -O0; do
+        if ! "$comp" $flag -o "$work/values.s" "$file"; then
+            echo "values: $file doesn't compile ${flag:-optimized}"
+            fail=1
+            continue
+        fi
+        set -- $(python3 bench/emu.py "$work/values.s")
+        if [ "${1:-}" != "$expected" ]; then
+            echo "values: $file returns ${1:-nothing} ${flag:-optimized}, expected $expected"
+            fail=1
+        fi
+    done
+done
+
+[ $fail = 0 ] && echo "values: $(ls tests/values/*.c | wc -l) files ok"
+exit $fail
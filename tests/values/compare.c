@@ -0,0 +1,19 @@
+// Chains of comparisons joined by && and ||, stored as 0/1 (cmp + ccmp +
+// cset) and branched on (cmp + ccmp + b.cond).
+int a = 3;
+int b = 7;
+int c = 2;
+int d = 7;
+int main(void) {
+    int s1 = a < b && c < 5;
+    int s2 = a > b || b == d;
+    int s3 = a < b && b != d;
+    int s4 = c > 5 || a >= b;
+    int s5 = a <= 3 && b >= d && c != a;
+    int s6 = (a == b || c < a) && d > c;
+    int t1 = (a < b && c < 5) ? 10 : 20;
+    int t2 = (a > b || b != d) ? 30 : 40;
+    int t3 = (c < a && (b == d || a == d)) ? 50 : 60;
+    int t4 = !(a < b && c > 5) ? 70 : 80;
+    return s1 + s2 * 2 + s3 * 4 + s4 * 8 + s5 * 16 + s6 * 32 + t1 + t2 + t3 + t4;
+}
@@ -0,0 +1,16 @@
+// The right side of && and || only runs when the left side doesn't decide
+// the result: g and c record which sides ran. Inputs are globals so
+// nothing folds.
+int g = 0;
+int zero = 0;
+int one = 1;
+int main(void) {
+    int c = 0;
+    int r = zero && g++;
+    r = r + (one || g++);
+    r = r + (one && ++g);
+    r = r + (zero || ++c);
+    r = r + (zero && (c = 10));
+    r = r + (one || (c = 20));
+    return g * 100 + c * 10 + r;
+}
@@ -0,0 +1,35 @@
+// 20 values live at once, more than the 16 allocatable registers, so some
+// are spilled. The swaps in one arm of the conditionals make phis that
+// take each other's values, a cycle of parallel moves at the join.
+int g0 = 1;
+int g1 = 2;
+int g2 = 3;
+int flip = 1;
+int main(void) {
+    int v0 = g0 + 1;
+    int v1 = g1 * 3;
+    int v2 = g2 - 5;
+    int v3 = v0 * v1;
+    int v4 = v1 + v2;
+    int v5 = v2 * v2;
+    int v6 = v3 - v0;
+    int v7 = v4 + g0;
+    int v8 = v5 + g1;
+    int v9 = v6 * 2;
+    int v10 = v7 - g2;
+    int v11 = v8 * v0;
+    int v12 = v9 + v1;
+    int v13 = v10 * v10;
+    int v14 = v11 - v3;
+    int v15 = v12 + v4;
+    int v16 = v13 - v5;
+    int v17 = v14 + v6;
+    int v18 = v15 * g2;
+    int v19 = v16 + v7;
+    int t = 0;
+    flip ? (t = v0) + (v0 = v1) + (v1 = t) : 0;
+    flip ? (t = v2) + (v2 = v3) + (v3 = v4) + (v4 = t) : 0;
+    return (v0 + 2 * v1 + 3 * v2 + 4 * v3 + 5 * v4 + 6 * v5 + 7 * v6 + 8 * v7 + 9 * v8 + 10 * v9
+        + 11 * v10 + 12 * v11 + 13 * v12 + 14 * v13 + 15 * v14 + 16 * v15 + 17 * v16
+        + 18 * v17 + 19 * v18 + 20 * v19) % 256;
+}
@@ -0,0 +1,17 @@
+// Nested conditionals in the condition and in both arms, the joins the
+// branch passes fold and skip.
+int p = 40;
+int q = 9;
+int lo = 10;
+int hi = 30;
+int main(void) {
+    // the grammar groups `a ? b : c ? d : e` from the left, so nested
+    // conditionals are parenthesized
+    int u = p < lo ? lo : (p > hi ? hi : p);
+    int v = q < lo ? lo : (q > hi ? hi : q);
+    int w = p > q ? (q > lo ? 1 : (lo > hi ? 2 : 3)) : (p > hi ? 4 : 5);
+    int x = (u > v ? u : v) > 20 ? (v < 15 ? u - v : u + v) : 0;
+    int y = p ? (q ? (lo ? 6 : 7) : 8) : 9;
+    int z = (p > hi ? q : lo) > (q < lo ? hi : p) ? (u ? 11 : 12) : (v ? 13 : 14);
+    return u + v * 2 + w * 10 + x + y * 3 + z;
+}